@@ -33,4 +33,5 @@ $(TEST)_DEFS := $(TMK_COMMON_DEFS) $(OPT_DEFS)
 
 $(TEST)_CONFIG := $(TEST_PATH)/config.h
 
-VPATH += $(TOP_DIR)/tests/test_common
\ No newline at end of file
+VPATH += $(TOP_DIR)/tests/test_common
+VPATH += $(TEST_PATH)
\ No newline at end of file
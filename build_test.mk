@@ -57,9 +57,17 @@ include common_features.mk
 include $(BUILDDEFS_PATH)/generic_features.mk
 include $(PLATFORM_PATH)/common.mk
 include $(TMK_PATH)/protocol.mk
+include $(DRIVER_PATH)/eeprom/tests/rules.mk
+include $(DRIVER_PATH)/led/tests/rules.mk
 include $(QUANTUM_PATH)/debounce/tests/rules.mk
+include $(QUANTUM_PATH)/dynamic_keymap/tests/rules.mk
 include $(QUANTUM_PATH)/encoder/tests/rules.mk
+include $(QUANTUM_PATH)/latency_trace/tests/rules.mk
+include $(QUANTUM_PATH)/matrix/tests/rules.mk
+include $(QUANTUM_PATH)/rgb_matrix/tests/rules.mk
 include $(QUANTUM_PATH)/sequencer/tests/rules.mk
+include $(QUANTUM_PATH)/split_common/tests/rules.mk
+include $(TMK_PATH)/protocol/tests/rules.mk
 include $(PLATFORM_PATH)/test/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
@@ -29,6 +29,7 @@ GENERIC_FEATURES = \
     HAPTIC \
     KEY_LOCK \
     KEY_OVERRIDE \
+    LATENCY_TRACE \
     LEADER \
     PROGRAMMABLE_BUTTON \
     SPACE_CADET \
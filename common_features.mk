@@ -46,6 +46,16 @@ else ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), api)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
 endif
 
+ifeq ($(strip $(SEND_STRING_ASYNC_ENABLE)), yes)
+    OPT_DEFS += -DSEND_STRING_ASYNC_ENABLE
+    DEFERRED_EXEC_ENABLE := yes
+endif
+
+ifeq ($(strip $(DYNAMIC_MACRO_ENABLE)), yes)
+    # Recorded macros are played back from the main loop
+    DEFERRED_EXEC_ENABLE := yes
+endif
+
 AUDIO_ENABLE ?= no
 ifeq ($(strip $(AUDIO_ENABLE)), yes)
     ifeq ($(PLATFORM),CHIBIOS)
@@ -181,7 +191,12 @@ else
         OPT_DEFS += -DEEPROM_DRIVER
         COMMON_VPATH += $(DRIVER_PATH)/eeprom
         SRC += eeprom_driver.c
-        SRC += $(PLATFORM_COMMON_DIR)/eeprom_stm32.c
+        ifeq ($(strip $(EEPROM_STM32_BANKED)), yes)
+          OPT_DEFS += -DEEPROM_STM32_BANKED
+          SRC += $(PLATFORM_COMMON_DIR)/eeprom_stm32_banked.c
+        else
+          SRC += $(PLATFORM_COMMON_DIR)/eeprom_stm32.c
+        endif
         SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
       else ifneq ($(filter $(MCU_SERIES),STM32L0xx STM32L1xx),)
         OPT_DEFS += -DEEPROM_DRIVER
@@ -199,6 +214,13 @@ else
       SRC += $(PLATFORM_COMMON_DIR)/eeprom.c
     endif
   endif
+  ifeq ($(strip $(EEPROM_CACHE_ENABLE)), yes)
+    ifeq ($(filter $(EEPROM_DRIVER),custom i2c spi transient),)
+      $(error EEPROM_CACHE_ENABLE requires EEPROM_DRIVER to be one of custom, i2c, spi or transient)
+    endif
+    OPT_DEFS += -DEEPROM_CACHE_ENABLE
+    SRC += eeprom_cache.c
+  endif
 endif
 
 RGBLIGHT_ENABLE ?= no
@@ -284,6 +306,7 @@ endif
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_drivers.c
+    SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_geometry.c
     SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
     RGB_KEYCODES_ENABLE := yes
@@ -459,6 +482,12 @@ ifeq ($(strip $(VIA_ENABLE)), yes)
     BOOTMAGIC_ENABLE := yes
     SRC += $(QUANTUM_DIR)/via.c
     OPT_DEFS += -DVIA_ENABLE
+
+    ifeq ($(strip $(VIA_BULK_TRANSFER_ENABLE)), yes)
+        OPT_DEFS += -DVIA_BULK_TRANSFER_ENABLE
+        SRC += $(QUANTUM_DIR)/via_bulk.c
+        CRC_ENABLE := yes
+    endif
 endif
 
 VALID_MAGIC_TYPES := yes
@@ -515,6 +544,11 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
 
         OPT_DEFS += -DSPLIT_COMMON_TRANSACTIONS
 
+        ifeq ($(strip $(SPLIT_TRANSPORT_STATS_ENABLE)), yes)
+            OPT_DEFS += -DSPLIT_TRANSPORT_STATS_ENABLE
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport_stats.c
+        endif
+
         # Functions added via QUANTUM_LIB_SRC are only included in the final binary if they're called.
         # Unused functions are pruned away, which is why we can add multiple drivers here without bloat.
         ifeq ($(PLATFORM),AVR)
@@ -0,0 +1,169 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <stdbool.h>
+#include <string.h>
+#include "timer.h"
+#include "eeprom_driver.h"
+#include "eeprom_cache.h"
+
+#define NO_PAGE UINT16_MAX
+
+typedef struct {
+    uint8_t  data[EEPROM_CACHE_PAGE_SIZE];
+    uint16_t page;
+    uint16_t dirty_start; /* changed bytes, dirty_start == dirty_end when the page is clean */
+    uint16_t dirty_end;
+    uint32_t dirty_since; /* when the first pending write arrived */
+    uint32_t last_used;
+} cache_slot_t;
+
+static cache_slot_t         slots[EEPROM_CACHE_PAGES] = {[0 ... EEPROM_CACHE_PAGES - 1] = {.page = NO_PAGE}};
+static uint32_t             last_write;
+static eeprom_cache_stats_t stats;
+
+static inline bool slot_dirty(const cache_slot_t *slot) { return slot->dirty_start != slot->dirty_end; }
+
+static cache_slot_t *find_slot(uint16_t page) {
+    for (uint8_t i = 0; i < EEPROM_CACHE_PAGES; i++) {
+        if (slots[i].page == page) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* The dirty page that has waited the longest */
+static cache_slot_t *oldest_dirty_slot(void) {
+    cache_slot_t *oldest = NULL;
+    for (uint8_t i = 0; i < EEPROM_CACHE_PAGES; i++) {
+        if (slot_dirty(&slots[i]) && (!oldest || TIMER_DIFF_32(slots[i].dirty_since, oldest->dirty_since) > UINT32_MAX / 2)) {
+            oldest = &slots[i];
+        }
+    }
+    return oldest;
+}
+
+static void flush_slot(cache_slot_t *slot) {
+    if (!slot_dirty(slot)) {
+        return;
+    }
+    uintptr_t address = (uintptr_t)slot->page * EEPROM_CACHE_PAGE_SIZE + slot->dirty_start;
+    eeprom_backing_write_block(&slot->data[slot->dirty_start], (void *)address, slot->dirty_end - slot->dirty_start);
+    slot->dirty_start = slot->dirty_end = 0;
+    stats.flushes++;
+}
+
+/* Caches a page for writing, making room by dropping a clean page or flushing the least recently used one */
+static cache_slot_t *load_slot(uint16_t page) {
+    cache_slot_t *slot = find_slot(page);
+    if (slot) {
+        return slot;
+    }
+
+    cache_slot_t *victim = NULL;
+    for (uint8_t i = 0; i < EEPROM_CACHE_PAGES; i++) {
+        cache_slot_t *candidate = &slots[i];
+        if (!victim || (slot_dirty(victim) && !slot_dirty(candidate)) || (slot_dirty(victim) == slot_dirty(candidate) && TIMER_DIFF_32(candidate->last_used, victim->last_used) > UINT32_MAX / 2)) {
+            victim = candidate;
+        }
+    }
+    if (slot_dirty(victim)) {
+        flush_slot(victim);
+        stats.evictions++;
+    }
+
+    victim->page = page;
+    eeprom_backing_read_block(victim->data, (const void *)((uintptr_t)page * EEPROM_CACHE_PAGE_SIZE), EEPROM_CACHE_PAGE_SIZE);
+    return victim;
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t address = (uintptr_t)addr;
+    uint8_t * dest    = buf;
+    /* Uncached bytes are read from the driver in as few transfers as possible */
+    uintptr_t uncached     = address;
+    uint8_t * uncached_buf = dest;
+
+    while (len > 0) {
+        uint16_t      offset = address % EEPROM_CACHE_PAGE_SIZE;
+        size_t        chunk  = EEPROM_CACHE_PAGE_SIZE - offset < len ? EEPROM_CACHE_PAGE_SIZE - offset : len;
+        cache_slot_t *slot   = find_slot(address / EEPROM_CACHE_PAGE_SIZE);
+        if (slot) {
+            if (uncached < address) {
+                eeprom_backing_read_block(uncached_buf, (const void *)uncached, address - uncached);
+            }
+            memcpy(dest, &slot->data[offset], chunk);
+            uncached     = address + chunk;
+            uncached_buf = dest + chunk;
+        }
+        address += chunk;
+        dest += chunk;
+        len -= chunk;
+    }
+
+    if (uncached < address) {
+        eeprom_backing_read_block(uncached_buf, (const void *)uncached, address - uncached);
+    }
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    uintptr_t      address = (uintptr_t)addr;
+    const uint8_t *src     = buf;
+    uint32_t       now     = timer_read32();
+    bool           changed = false;
+
+    while (len > 0) {
+        uint16_t offset = address % EEPROM_CACHE_PAGE_SIZE;
+        size_t   chunk  = EEPROM_CACHE_PAGE_SIZE - offset < len ? EEPROM_CACHE_PAGE_SIZE - offset : len;
+
+        cache_slot_t *slot = load_slot(address / EEPROM_CACHE_PAGE_SIZE);
+        slot->last_used    = now;
+        if (memcmp(&slot->data[offset], src, chunk) != 0) {
+            memcpy(&slot->data[offset], src, chunk);
+            if (!slot_dirty(slot)) {
+                slot->dirty_start = offset;
+                slot->dirty_end   = offset + chunk;
+                slot->dirty_since = now;
+            } else {
+                if (offset < slot->dirty_start) slot->dirty_start = offset;
+                if (offset + chunk > slot->dirty_end) slot->dirty_end = offset + chunk;
+            }
+            changed = true;
+        }
+
+        address += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+
+    if (changed) {
+        last_write = now;
+        stats.writes++;
+    }
+}
+
+void eeprom_driver_erase(void) {
+    /* Pending writes are superseded by the erase */
+    for (uint8_t i = 0; i < EEPROM_CACHE_PAGES; i++) {
+        slots[i].page        = NO_PAGE;
+        slots[i].dirty_start = slots[i].dirty_end = 0;
+    }
+    eeprom_backing_erase();
+}
+
+/* The cache is the EEPROM driver seen by the rest of the firmware, its task flushes due writes */
+void eeprom_driver_task(void) {
+    cache_slot_t *slot = oldest_dirty_slot();
+    if (slot && (timer_elapsed32(last_write) >= EEPROM_CACHE_IDLE_TIME || timer_elapsed32(slot->dirty_since) >= EEPROM_CACHE_MAX_DELAY)) {
+        flush_slot(slot);
+    }
+}
+
+void eeprom_cache_flush(void) {
+    for (uint8_t i = 0; i < EEPROM_CACHE_PAGES; i++) {
+        flush_slot(&slots[i]);
+    }
+}
+
+void eeprom_cache_get_stats(eeprom_cache_stats_t *out) { *out = stats; }
@@ -0,0 +1,68 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    The cache holds whole pages of the EEPROM in RAM while they have pending
+    writes, and writes each page back as a single transfer of its changed bytes.
+*/
+#ifndef EEPROM_CACHE_PAGE_SIZE
+#    ifdef EXTERNAL_EEPROM_PAGE_SIZE
+#        define EEPROM_CACHE_PAGE_SIZE EXTERNAL_EEPROM_PAGE_SIZE
+#    else
+#        define EEPROM_CACHE_PAGE_SIZE 32
+#    endif
+#endif
+
+/*
+    Number of pages the cache can hold at once.
+*/
+#ifndef EEPROM_CACHE_PAGES
+#    define EEPROM_CACHE_PAGES 4
+#endif
+
+/*
+    Pending writes are flushed once no write arrived for this many milliseconds...
+*/
+#ifndef EEPROM_CACHE_IDLE_TIME
+#    define EEPROM_CACHE_IDLE_TIME 100
+#endif
+
+/*
+    ...or at the latest this many milliseconds after the first of them.
+*/
+#ifndef EEPROM_CACHE_MAX_DELAY
+#    define EEPROM_CACHE_MAX_DELAY 1000
+#endif
+
+typedef struct {
+    uint32_t writes;    /* eeprom_write_block() calls that changed the cached contents */
+    uint32_t flushes;   /* transfers to the driver, one per dirty page */
+    uint32_t evictions; /* pages flushed early to make room for another */
+} eeprom_cache_stats_t;
+
+/* Writes back all pending writes before returning */
+void eeprom_cache_flush(void);
+
+void eeprom_cache_get_stats(eeprom_cache_stats_t *stats);
+
+/* The driver behind the cache */
+void eeprom_backing_read_block(void *buf, const void *addr, size_t len);
+void eeprom_backing_write_block(const void *buf, void *addr, size_t len);
+void eeprom_backing_erase(void);
+
+/*
+    Drivers that can be used behind the cache include this header and get their
+    eeprom_read_block(), eeprom_write_block() and eeprom_driver_erase() renamed to
+    the functions above, the cache provides the public ones. Its eeprom_driver_task()
+    flushes at most one page per main loop iteration when writes are due.
+*/
+#ifdef EEPROM_CACHE_BACKING_DRIVER
+#    define eeprom_read_block eeprom_backing_read_block
+#    define eeprom_write_block eeprom_backing_write_block
+#    define eeprom_driver_erase eeprom_backing_erase
+#endif
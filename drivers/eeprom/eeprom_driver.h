@@ -20,3 +20,5 @@
 
 void eeprom_driver_init(void);
 void eeprom_driver_erase(void);
+/* Background housekeeping, a no-op unless the driver overrides it */
+void eeprom_driver_task(void);
@@ -37,6 +37,10 @@
 #include "i2c_master.h"
 #include "eeprom.h"
 #include "eeprom_i2c.h"
+#ifdef EEPROM_CACHE_ENABLE
+#    define EEPROM_CACHE_BACKING_DRIVER
+#    include "eeprom_cache.h"
+#endif
 
 // #define DEBUG_EEPROM_OUTPUT
 
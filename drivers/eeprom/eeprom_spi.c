@@ -36,6 +36,10 @@
 #include "spi_master.h"
 #include "eeprom.h"
 #include "eeprom_spi.h"
+#ifdef EEPROM_CACHE_ENABLE
+#    define EEPROM_CACHE_BACKING_DRIVER
+#    include "eeprom_cache.h"
+#endif
 
 #define CMD_WREN 6
 #define CMD_WRDI 4
@@ -19,6 +19,10 @@
 
 #include "eeprom_driver.h"
 #include "eeprom_transient.h"
+#ifdef EEPROM_CACHE_ENABLE
+#    define EEPROM_CACHE_BACKING_DRIVER
+#    include "eeprom_cache.h"
+#endif
 
 __attribute__((aligned(4))) static uint8_t transientBuffer[TRANSIENT_EEPROM_SIZE] = {0};
 
@@ -0,0 +1,145 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_cache.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+#define PAGE EEPROM_CACHE_PAGE_SIZE
+
+class EepromCacheTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(1000);
+        eeprom_driver_erase();
+        eeprom_cache_get_stats(&start);
+    }
+
+    /* What the driver behind the cache holds */
+    uint8_t stored(uintptr_t address) {
+        uint8_t value;
+        eeprom_backing_read_block(&value, (const void*)address, 1);
+        return value;
+    }
+
+    eeprom_cache_stats_t stats() {
+        eeprom_cache_stats_t now;
+        eeprom_cache_get_stats(&now);
+        now.writes -= start.writes;
+        now.flushes -= start.flushes;
+        now.evictions -= start.evictions;
+        return now;
+    }
+
+    void idle_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            eeprom_driver_task();
+        }
+    }
+
+    eeprom_cache_stats_t start;
+};
+
+TEST_F(EepromCacheTest, ReadsSeePendingWrites) {
+    eeprom_update_dword((uint32_t*)8, 0x12345678);
+    EXPECT_EQ(eeprom_read_dword((const uint32_t*)8), 0x12345678);
+    EXPECT_EQ(stored(8), 0);
+
+    eeprom_cache_flush();
+    EXPECT_EQ(stored(8), 0x78);
+    EXPECT_EQ(stored(11), 0x12);
+}
+
+TEST_F(EepromCacheTest, ByteWritesToOnePageBecomeOneTransfer) {
+    /* As dynamic_keymap_set_buffer() does */
+    for (uint8_t i = 0; i < PAGE; i++) {
+        eeprom_update_byte((uint8_t*)(uintptr_t)(PAGE + i), i + 1);
+    }
+    EXPECT_EQ(stats().writes, PAGE);
+
+    idle_for(EEPROM_CACHE_IDLE_TIME);
+    EXPECT_EQ(stats().flushes, 1);
+    for (uint8_t i = 0; i < PAGE; i++) {
+        EXPECT_EQ(stored(PAGE + i), i + 1);
+    }
+}
+
+TEST_F(EepromCacheTest, UnchangedWritesAreNotPending) {
+    eeprom_update_byte((uint8_t*)3, 0);
+    eeprom_write_byte((uint8_t*)4, 0);
+    EXPECT_EQ(stats().writes, 0);
+
+    idle_for(EEPROM_CACHE_MAX_DELAY);
+    EXPECT_EQ(stats().flushes, 0);
+}
+
+TEST_F(EepromCacheTest, FlushesWhenWritesGoIdle) {
+    eeprom_write_byte((uint8_t*)5, 0x42);
+    idle_for(EEPROM_CACHE_IDLE_TIME - 1);
+    EXPECT_EQ(stored(5), 0);
+    idle_for(1);
+    EXPECT_EQ(stored(5), 0x42);
+}
+
+TEST_F(EepromCacheTest, FlushesByDeadlineDuringSteadyWrites) {
+    uint32_t elapsed = 0;
+    for (uint8_t i = 1; stored(6) == 0; i++) {
+        ASSERT_LE(elapsed, EEPROM_CACHE_MAX_DELAY);
+        eeprom_write_byte((uint8_t*)6, i);
+        idle_for(EEPROM_CACHE_IDLE_TIME / 2);
+        elapsed += EEPROM_CACHE_IDLE_TIME / 2;
+    }
+    EXPECT_GE(elapsed, EEPROM_CACHE_MAX_DELAY);
+    EXPECT_EQ(stats().flushes, 1);
+}
+
+TEST_F(EepromCacheTest, LeastRecentlyUsedPageIsEvicted) {
+    for (uint8_t page = 0; page <= EEPROM_CACHE_PAGES; page++) {
+        eeprom_write_byte((uint8_t*)(uintptr_t)(page * PAGE), page + 1);
+        advance_time(1);
+    }
+    EXPECT_EQ(stats().evictions, 1);
+    EXPECT_EQ(stored(0), 1);
+    EXPECT_EQ(stored(PAGE), 0);
+
+    eeprom_cache_flush();
+    for (uint8_t page = 0; page <= EEPROM_CACHE_PAGES; page++) {
+        EXPECT_EQ(eeprom_read_byte((const uint8_t*)(uintptr_t)(page * PAGE)), page + 1);
+        EXPECT_EQ(stored(page * PAGE), page + 1);
+    }
+    EXPECT_EQ(stats().flushes, EEPROM_CACHE_PAGES + 1);
+}
+
+TEST_F(EepromCacheTest, ReadsSpanCachedAndUncachedPages) {
+    uint8_t pattern[3 * PAGE];
+    for (uint8_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = i ^ 0x5a;
+    }
+    eeprom_backing_write_block(pattern, (void*)0, sizeof(pattern));
+    /* Only the middle page gets cached */
+    pattern[PAGE + 1] = 0;
+    eeprom_write_byte((uint8_t*)(PAGE + 1), 0);
+
+    uint8_t read[3 * PAGE - 2];
+    eeprom_read_block(read, (const void*)1, sizeof(read));
+    EXPECT_EQ(memcmp(read, &pattern[1], sizeof(read)), 0);
+}
+
+TEST_F(EepromCacheTest, EraseDropsPendingWrites) {
+    eeprom_write_dword((uint32_t*)16, 0xdeadbeef);
+    eeprom_cache_flush();
+    eeprom_write_dword((uint32_t*)16, 0x01020304);
+
+    eeprom_driver_erase();
+    EXPECT_EQ(eeprom_read_dword((const uint32_t*)16), 0);
+    eeprom_cache_flush();
+    EXPECT_EQ(stored(16), 0);
+}
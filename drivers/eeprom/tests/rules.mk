@@ -0,0 +1,11 @@
+eeprom_cache_DEFS := -DEEPROM_CACHE_ENABLE -DTRANSIENT_EEPROM_SIZE=1024 -DEEPROM_CACHE_PAGE_SIZE=32 -DEEPROM_CACHE_PAGES=4
+
+eeprom_cache_INC := \
+	$(DRIVER_PATH)/eeprom
+
+eeprom_cache_SRC := \
+	$(DRIVER_PATH)/eeprom/tests/eeprom_cache_tests.cpp \
+	$(DRIVER_PATH)/eeprom/eeprom_cache.c \
+	$(DRIVER_PATH)/eeprom/eeprom_driver.c \
+	$(DRIVER_PATH)/eeprom/eeprom_transient.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
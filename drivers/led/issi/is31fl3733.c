@@ -18,6 +18,7 @@
  */
 
 #include "is31fl3733.h"
+#include <string.h>
 #include "i2c_master.h"
 #include "wait.h"
 
@@ -57,6 +58,11 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// Number of unchanged PWM registers worth resending to keep two changed ones in the same transfer.
+#ifndef ISSI_PWM_BURST_GAP
+#    define ISSI_PWM_BURST_GAP 2
+#endif
+
 #ifndef ISSI_PWM_FREQUENCY
 #    define ISSI_PWM_FREQUENCY 0b000  // PFS - IS31FL3733B only
 #endif
@@ -75,11 +81,12 @@ uint8_t g_twi_transfer_buffer[20];
 // These buffers match the IS31FL3733 PWM registers.
 // The control buffers match the PG0 LED On/Off registers.
 // Storing them like this is optimal for I2C transfers to the registers.
-// We could optimize this and take out the unused registers from these
-// buffers and the transfers in IS31FL3733_write_pwm_buffer() but it's
-// probably not worth the extra complexity.
+// Updates only transfer the registers marked in g_pwm_buffer_dirty, so
+// unused registers and LEDs that did not change cost no bus time.
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// One bit per PWM register that changed since it was last written to the driver.
+uint8_t g_pwm_buffer_dirty[DRIVER_COUNT][192 / 8] = {{0}};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {0};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -134,6 +141,57 @@ bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+static bool IS31FL3733_write_pwm_burst(uint8_t addr, uint8_t *pwm_buffer, uint8_t start, uint8_t length) {
+    g_twi_transfer_buffer[0] = start;
+    memcpy(&g_twi_transfer_buffer[1], &pwm_buffer[start], length);
+
+#if ISSI_PERSISTENCE > 0
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+            return false;
+        }
+    }
+#else
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+static inline bool IS31FL3733_pwm_dirty(uint8_t index, uint8_t reg) { return g_pwm_buffer_dirty[index][reg / 8] & (1 << (reg % 8)); }
+
+// Writes the changed PWM registers of a driver, changed registers close to each other are
+// sent in one auto-increment transfer of up to 16 bytes.
+// Assumes PG1 is already selected. Registers that fail to transfer stay dirty.
+static bool IS31FL3733_write_dirty_pwm_registers(uint8_t addr, uint8_t index) {
+    uint8_t reg = 0;
+    while (reg < 192) {
+        if (!g_pwm_buffer_dirty[index][reg / 8]) {
+            reg = (reg | 7) + 1;
+            continue;
+        }
+        if (!IS31FL3733_pwm_dirty(index, reg)) {
+            reg++;
+            continue;
+        }
+
+        uint8_t last = reg;
+        for (uint8_t next = reg + 1; next < 192 && next - reg < 16 && next - last <= ISSI_PWM_BURST_GAP + 1; next++) {
+            if (IS31FL3733_pwm_dirty(index, next)) {
+                last = next;
+            }
+        }
+        if (!IS31FL3733_write_pwm_burst(addr, g_pwm_buffer[index], reg, last - reg + 1)) {
+            return false;
+        }
+        for (; reg <= last; reg++) {
+            g_pwm_buffer_dirty[index][reg / 8] &= ~(1 << (reg % 8));
+        }
+    }
+    return true;
+}
+
 void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -178,6 +236,20 @@ void IS31FL3733_init(uint8_t addr, uint8_t sync) {
 
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
+
+    // The chip and the buffers may disagree after init, so the next update sends every register.
+    memset(g_pwm_buffer_dirty, 0xFF, sizeof(g_pwm_buffer_dirty));
+    for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+        g_pwm_buffer_update_required[i] = true;
+    }
+}
+
+static inline void IS31FL3733_set_pwm(uint8_t index, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[index][reg] != value) {
+        g_pwm_buffer[index][reg] = value;
+        g_pwm_buffer_dirty[index][reg / 8] |= 1 << (reg % 8);
+        g_pwm_buffer_update_required[index] = true;
+    }
 }
 
 void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
@@ -185,10 +257,9 @@ void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3733_set_pwm(led.driver, led.r, red);
+        IS31FL3733_set_pwm(led.driver, led.g, green);
+        IS31FL3733_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -236,8 +307,10 @@ void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
 
         // If any of the transactions fail we risk writing dirty PG0,
         // refresh page 0 just in case.
-        if (!IS31FL3733_write_pwm_buffer(addr, g_pwm_buffer[index])) {
+        // Only registers that changed since the last update are sent.
+        if (!IS31FL3733_write_dirty_pwm_registers(addr, index)) {
             g_led_control_registers_update_required[index] = true;
+            return;
         }
     }
     g_pwm_buffer_update_required[index] = false;
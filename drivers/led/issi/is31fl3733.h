@@ -44,7 +44,7 @@ void IS31FL3733_set_led_control_register(uint8_t index, bool red, bool green, bo
 // This should not be called from an interrupt
 // (eg. from a timer interrupt).
 // Call this while idle (in between matrix scans).
-// If the buffer is dirty, it will update the driver with the buffer.
+// If the buffer is dirty, it will update the driver with the registers that changed.
 void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index);
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index);
 
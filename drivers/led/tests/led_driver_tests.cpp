@@ -0,0 +1,172 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_master.h"
+
+#if defined(IS31FL3733)
+#    include "is31fl3733.h"
+#    define LED_T is31_led
+#    define g_leds g_is31_leds
+#    define driver_init(addr) IS31FL3733_init(addr, 0)
+#    define driver_set_color IS31FL3733_set_color
+#    define driver_set_color_all IS31FL3733_set_color_all
+#    define driver_update_pwm_buffers IS31FL3733_update_pwm_buffers
+/* Unlocking the command register, then selecting PG1 */
+#    define PAGE_SELECT_BYTES 4
+#elif defined(CKLED2001)
+#    include "ckled2001.h"
+#    define LED_T ckled2001_led
+#    define g_leds g_ckled2001_leds
+#    define driver_init CKLED2001_init
+#    define driver_set_color CKLED2001_set_color
+#    define driver_set_color_all CKLED2001_set_color_all
+#    define driver_update_pwm_buffers CKLED2001_update_pwm_buffers
+#    define PAGE_SELECT_BYTES 2
+#endif
+
+/* Both drivers select the page through 0xFD, the PWM registers are on page 1 */
+#define PAGE_REGISTER 0xFD
+#define PWM_PAGE 0x01
+#define DRIVER_ADDR 0x50
+/* What every update used to cost: the whole PWM page in twelve transfers */
+#define FULL_PAGE_BYTES (12 * 17 + PAGE_SELECT_BYTES)
+
+extern uint8_t g_pwm_buffer[DRIVER_COUNT][192];
+
+/* 64 RGB LEDs on CS1-16, each colour on its own SW row: the G, R and B registers of an LED are 16 apart */
+#define LED(i) \
+    { 0, ((i) / 16 * 3 + 1) * 16 + (i) % 16, (i) / 16 * 3 * 16 + (i) % 16, ((i) / 16 * 3 + 2) * 16 + (i) % 16 }
+#define LED4(i) LED(i), LED(i + 1), LED(i + 2), LED(i + 3)
+#define LED16(i) LED4(i), LED4(i + 4), LED4(i + 8), LED4(i + 12)
+
+extern const LED_T g_leds[DRIVER_LED_TOTAL] = {LED16(0), LED16(16), LED16(32), LED16(48)};
+
+void wait_ms(uint32_t ms) {}
+
+static uint8_t  chip_page;
+static uint8_t  chip_pwm[192];
+static uint32_t bytes_sent;
+static uint16_t failures_left;
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    bool pwm = chip_page == PWM_PAGE && data[0] < sizeof(chip_pwm);
+    /* Only PWM transfers fail, the driver does not check the page selection */
+    if (failures_left > 0 && pwm) {
+        failures_left--;
+        return I2C_STATUS_ERROR;
+    }
+    bytes_sent += length;
+    if (data[0] == PAGE_REGISTER) {
+        chip_page = data[1];
+    } else if (pwm) {
+        memcpy(&chip_pwm[data[0]], &data[1], length - 1);
+    }
+    return I2C_STATUS_SUCCESS;
+}
+}
+
+class LedDriverTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(chip_pwm, 0x5A, sizeof(chip_pwm));
+        failures_left = 0;
+        driver_set_color_all(0, 0, 0);
+        driver_init(DRIVER_ADDR);
+        flush();
+    }
+
+    /* Bytes the last update put on the bus */
+    uint32_t flush() {
+        bytes_sent = 0;
+        driver_update_pwm_buffers(DRIVER_ADDR, 0);
+        return bytes_sent;
+    }
+
+    void expect_chip_matches_buffer() {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            LED_T led = g_leds[i];
+            ASSERT_EQ(chip_pwm[led.r], g_pwm_buffer[0][led.r]) << "LED " << (int)i;
+            ASSERT_EQ(chip_pwm[led.g], g_pwm_buffer[0][led.g]) << "LED " << (int)i;
+            ASSERT_EQ(chip_pwm[led.b], g_pwm_buffer[0][led.b]) << "LED " << (int)i;
+        }
+    }
+};
+
+TEST_F(LedDriverTest, InitSendsWholePage) {
+    /* The chip held garbage before init, even registers that are zero in the buffer were written */
+    for (uint8_t i = 0; i < 192; i++) {
+        EXPECT_EQ(chip_pwm[i], 0) << "register " << (int)i;
+    }
+    driver_init(DRIVER_ADDR);
+    EXPECT_EQ(flush(), FULL_PAGE_BYTES);
+}
+
+TEST_F(LedDriverTest, StaticFrameSendsNothing) {
+    driver_set_color_all(10, 20, 30);
+    EXPECT_EQ(flush(), FULL_PAGE_BYTES);
+    for (int frame = 0; frame < 10; frame++) {
+        driver_set_color_all(10, 20, 30);
+        EXPECT_EQ(flush(), 0);
+    }
+    expect_chip_matches_buffer();
+}
+
+TEST_F(LedDriverTest, BlinkingIndicatorSendsOnlyItsRegisters) {
+    driver_set_color_all(0, 0, 255);
+    flush();
+
+    for (int frame = 0; frame < 10; frame++) {
+        driver_set_color_all(0, 0, 255);
+        driver_set_color(5, frame % 2 ? 0 : 255, 0, 255);
+        /* Only the red register changes, the register byte and its value */
+        EXPECT_EQ(flush(), PAGE_SELECT_BYTES + 2);
+        expect_chip_matches_buffer();
+    }
+}
+
+TEST_F(LedDriverTest, ReactiveFadeSendsFewBytes) {
+    /* Two neighbouring keys fading out, the rest of the board stays dark */
+    for (int level = 255; level >= 0; level -= 15) {
+        driver_set_color_all(0, 0, 0);
+        driver_set_color(20, level, level, level);
+        driver_set_color(21, level, level, level);
+        /* One transfer of two adjacent registers per colour */
+        EXPECT_EQ(flush(), PAGE_SELECT_BYTES + 3 * 3);
+        expect_chip_matches_buffer();
+    }
+}
+
+TEST_F(LedDriverTest, FullFrameCostsNoMoreThanBefore) {
+    for (int frame = 1; frame <= 10; frame++) {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            driver_set_color(i, i * 4 + frame, 255 - i * 4 - frame, frame * 20);
+        }
+        EXPECT_LE(flush(), FULL_PAGE_BYTES);
+        expect_chip_matches_buffer();
+    }
+}
+
+TEST_F(LedDriverTest, SmallGapsAreBridged) {
+    /* Registers 1 and 3 of a row go in one transfer instead of two */
+    driver_set_color(1, 0, 7, 0);
+    driver_set_color(3, 0, 7, 0);
+    EXPECT_EQ(flush(), PAGE_SELECT_BYTES + 4);
+    expect_chip_matches_buffer();
+}
+
+TEST_F(LedDriverTest, FailedTransferIsResent) {
+    driver_set_color_all(100, 0, 0);
+    failures_left = 1;
+    flush();
+    failures_left = 0;
+
+    /* Nothing changed in the buffer since, the failed registers go out again */
+    driver_set_color_all(100, 0, 0);
+    EXPECT_GT(flush(), 0);
+    expect_chip_matches_buffer();
+    EXPECT_EQ(flush(), 0);
+}
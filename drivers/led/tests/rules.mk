@@ -0,0 +1,19 @@
+led_driver_is31fl3733_DEFS := -DIS31FL3733 -DDRIVER_COUNT=1 -DDRIVER_LED_TOTAL=64
+
+led_driver_is31fl3733_INC := \
+	$(DRIVER_PATH)/led/tests \
+	$(DRIVER_PATH)/led/issi
+
+led_driver_is31fl3733_SRC := \
+	$(DRIVER_PATH)/led/tests/led_driver_tests.cpp \
+	$(DRIVER_PATH)/led/issi/is31fl3733.c
+
+led_driver_ckled2001_DEFS := -DCKLED2001 -DDRIVER_COUNT=1 -DDRIVER_LED_TOTAL=64
+
+led_driver_ckled2001_INC := \
+	$(DRIVER_PATH)/led/tests \
+	$(DRIVER_PATH)/led
+
+led_driver_ckled2001_SRC := \
+	$(DRIVER_PATH)/led/tests/led_driver_tests.cpp \
+	$(DRIVER_PATH)/led/ckled2001.c
@@ -0,0 +1 @@
+TEST_LIST += led_driver_is31fl3733 led_driver_ckled2001
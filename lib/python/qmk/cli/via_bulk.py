@@ -0,0 +1,50 @@
+"""Upload a dynamic keymap with the VIA bulk transfer extension.
+"""
+from argcomplete.completers import FilesCompleter
+from milc import cli
+
+from qmk.path import normpath
+from qmk.via_bulk import BulkTransferError, SimulatedDevice, set_buffer_round_trips, upload
+
+
+@cli.argument('filename', nargs='?', arg_only=True, type=normpath, completer=FilesCompleter('.bin'), help='Raw keymap buffer to upload, as returned by id_dynamic_keymap_get_buffer. Defaults to a test pattern.')
+@cli.argument('-l', '--layers', arg_only=True, type=int, default=6, help='Number of layers of the simulated keyboard.')
+@cli.argument('-k', '--keys', arg_only=True, type=int, default=100, help='Number of matrix positions per layer of the simulated keyboard.')
+@cli.argument('-o', '--offset', arg_only=True, type=int, default=0, help='Keymap buffer offset to upload to.')
+@cli.argument('-b', '--buffer-size', arg_only=True, type=int, help='VIA_BULK_BUFFER_SIZE of the simulated keyboard, defaults to 256 bytes as in the firmware.')
+@cli.argument('-w', '--window', arg_only=True, type=int, default=8, help='VIA_BULK_WINDOW of the simulated keyboard.')
+@cli.argument('--loss', arg_only=True, type=float, default=0.0, help='Probability that a report is lost on the way to the keyboard.')
+@cli.subcommand('Upload a keymap to a simulated keyboard with the VIA bulk transfer extension.', hidden=False if cli.config.user.developer else True)
+def via_bulk(cli):
+    """Upload a keymap buffer to a simulated keyboard and compare the HID traffic with id_dynamic_keymap_set_buffer.
+    """
+    keymap_size = cli.args.layers * cli.args.keys * 2
+    if cli.args.filename:
+        if not cli.args.filename.exists():
+            cli.log.error('File {fg_cyan}%s{style_reset_all} was not found.', cli.args.filename)
+            return False
+        data = cli.args.filename.read_bytes()
+    else:
+        data = bytes((i * 7 + 3) & 0xFF for i in range(keymap_size - cli.args.offset))
+
+    if not data or cli.args.offset + len(data) > keymap_size:
+        cli.log.error('%d bytes at offset %d do not fit a %d byte keymap.', len(data), cli.args.offset, keymap_size)
+        return False
+
+    device = SimulatedDevice(keymap_size, cli.args.buffer_size, cli.args.window, cli.args.loss)
+    buffer_size = device.buffer_size
+    resent = 0
+    try:
+        # Keyboards with a smaller staging buffer take the keymap in several transfers
+        for start in range(0, len(data), buffer_size):
+            resent += upload(device, cli.args.offset + start, data[start:start + buffer_size])
+    except BulkTransferError as e:
+        cli.log.error('Upload failed: %s', e)
+        return False
+
+    if device.keymap[cli.args.offset:cli.args.offset + len(data)] != data:
+        cli.log.error('Keymap readback does not match the upload.')
+        return False
+
+    cli.log.info('Uploaded %d bytes in %d transfers: %d reports (%d data reports resent).', len(data), device.commits, device.reports, resent)
+    cli.log.info('id_dynamic_keymap_set_buffer needs %d request/reply round trips for the same upload.', set_buffer_round_trips(len(data)))
@@ -300,3 +300,15 @@ def test_format_json_keymap_auto():
     result = check_subcommand('format-json', '--format', 'auto', 'lib/python/qmk/tests/minimal_keymap.json')
     check_returncode(result)
     assert result.stdout == '{\n    "keyboard": "handwired/pytest/basic",\n    "keymap": "test",\n    "layers": [\n        ["KC_A"]\n    ],\n    "layout": "LAYOUT_ortho_1x1",\n    "version": 1\n}\n'
+
+
+def test_via_bulk():
+    result = check_subcommand('via-bulk')
+    check_returncode(result)
+    assert 'Uploaded 1200 bytes in 5 transfers' in result.stdout
+
+
+def test_via_bulk_split_lossy():
+    result = check_subcommand('via-bulk', '--buffer-size', '512', '--loss', '0.2')
+    check_returncode(result)
+    assert 'Uploaded 1200 bytes in 3 transfers' in result.stdout
@@ -0,0 +1,28 @@
+from qmk.via_bulk import SimulatedDevice, crc8, upload
+
+
+def test_crc8_matches_firmware():
+    assert crc8(b'123456789') == 0xF7
+
+
+def test_upload_whole_keymap():
+    data = bytes(range(256)) * 4
+    device = SimulatedDevice(1024, buffer_size=1024)
+    assert upload(device, 0, data) == 0
+    assert device.keymap == data
+    assert device.commits == 1
+    # begin, 35 data reports, commit
+    assert device.reports == 37
+
+
+def test_default_buffer_matches_firmware():
+    assert SimulatedDevice(1024).buffer_size == 256
+    assert SimulatedDevice(100).buffer_size == 100
+
+
+def test_upload_recovers_lost_reports():
+    data = bytes(range(200))
+    device = SimulatedDevice(1024, window=4, loss=0.3, seed=1)
+    assert upload(device, 100, data) > 0
+    assert device.keymap[100:300] == data
+    assert device.commits == 1
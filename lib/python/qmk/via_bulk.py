@@ -0,0 +1,184 @@
+"""Host side of the VIA bulk keymap transfer, see `quantum/via_bulk.h`.
+
+The upload is streamed in data reports behind 8-bit sequence numbers, with up to `window` of them in flight, and checked by a CRC8 over the whole upload before the keyboard writes it.
+"""
+import random
+from collections import deque
+
+REPORT_SIZE = 32
+PAYLOAD_SIZE = 30
+SET_BUFFER_PAYLOAD_SIZE = 28
+DEFAULT_BUFFER_SIZE = 256
+
+ID_BULK_BEGIN = 0x80
+ID_BULK_DATA = 0x81
+ID_BULK_COMMIT = 0x82
+ID_UNHANDLED = 0xFF
+
+STATUS_OK = 0x00
+STATUS_ERROR_RANGE = 0x01
+STATUS_ERROR_SEQUENCE = 0x02
+STATUS_ERROR_INCOMPLETE = 0x03
+STATUS_ERROR_CRC = 0x04
+STATUS_ERROR_STATE = 0x05
+
+
+class BulkTransferError(Exception):
+    """Raised when the keyboard refuses a transfer.
+    """
+
+
+def crc8(data):
+    """CRC8 as computed by `quantum/crc.c`: polynomial 0x31, initial value 0xFF.
+    """
+    crc = 0xFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x31) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def report(command_id, *data):
+    """Build a raw HID report.
+    """
+    return bytes([command_id, *data]).ljust(REPORT_SIZE, b'\0')
+
+
+class SimulatedDevice:
+    """A keyboard running `quantum/via_bulk.c`, with a lossy link.
+
+    Reports go out through `write()` and their replies are queued for `read()`, which returns None once nothing is left, as a read timeout would. Each report is lost before it reaches the keyboard with probability `loss`.
+    """
+    def __init__(self, keymap_size, buffer_size=None, window=8, loss=0.0, seed=0):
+        self.keymap = bytearray(keymap_size)
+        self.buffer_size = buffer_size or min(keymap_size, DEFAULT_BUFFER_SIZE)
+        self.window = window
+        self.loss = loss
+        self.random = random.Random(seed)
+        self.replies = deque()
+        self.reports = 0
+        self.commits = 0
+        self.active = False
+
+    def write(self, data):
+        self.reports += 1
+        if self.random.random() < self.loss:
+            return
+
+        command_id, command_data = data[0], bytearray(data[1:])
+        if command_id == ID_BULK_BEGIN:
+            self._begin(command_data)
+        elif command_id == ID_BULK_DATA:
+            self._data(command_data)
+        elif command_id == ID_BULK_COMMIT:
+            self._commit(command_data)
+        else:
+            command_id = ID_UNHANDLED
+        self.replies.append(bytes([command_id]) + bytes(command_data))
+
+    def read(self):
+        return self.replies.popleft() if self.replies else None
+
+    def _begin(self, data):
+        offset = (data[0] << 8) | data[1]
+        size = (data[2] << 8) | data[3]
+        self.active = 0 < size <= self.buffer_size and offset + size <= len(self.keymap)
+        if self.active:
+            self.offset, self.size, self.staged, self.next_sequence = offset, size, bytearray(), 0
+        data[0:5] = [STATUS_OK if self.active else STATUS_ERROR_RANGE, self.window, PAYLOAD_SIZE, self.buffer_size >> 8, self.buffer_size & 0xFF]
+
+    def _data(self, data):
+        sequence = data[0]
+        if not self.active:
+            status = STATUS_ERROR_STATE
+        elif sequence == self.next_sequence:
+            if len(self.staged) == self.size:
+                status = STATUS_ERROR_RANGE
+            else:
+                self.staged += data[1:1 + min(PAYLOAD_SIZE, self.size - len(self.staged))]
+                self.next_sequence = (self.next_sequence + 1) & 0xFF
+                status = STATUS_OK
+        elif (self.next_sequence - sequence) & 0xFF <= self.window:
+            status = STATUS_OK
+        else:
+            status = STATUS_ERROR_SEQUENCE
+        data[0:2] = [status, self.next_sequence]
+
+    def _commit(self, data):
+        if not self.active:
+            data[0] = STATUS_ERROR_STATE
+            return
+        if len(self.staged) != self.size:
+            data[0] = STATUS_ERROR_INCOMPLETE
+            return
+
+        crc = crc8(self.staged)
+        self.active = False
+        if crc == data[0]:
+            self.keymap[self.offset:self.offset + self.size] = self.staged
+            self.commits += 1
+        data[0:2] = [STATUS_OK if crc == data[0] else STATUS_ERROR_CRC, crc]
+
+
+def _exchange(device, data, retries):
+    """Send a control report and wait for its reply, resending it when the reply times out.
+    """
+    for _ in range(retries):
+        device.write(data)
+        reply = device.read()
+        if reply is not None:
+            return reply
+    raise BulkTransferError('No reply from the keyboard')
+
+
+def upload(device, offset, data, retries=8):
+    """Upload `data` to the dynamic keymap at `offset` as one transfer.
+
+    Resends from the keyboard's expected sequence number whenever a report or its reply goes missing. Returns the number of data reports that had to be resent.
+    """
+    reply = _exchange(device, report(ID_BULK_BEGIN, offset >> 8, offset & 0xFF, len(data) >> 8, len(data) & 0xFF), retries)
+    if reply[0] == ID_UNHANDLED:
+        raise BulkTransferError('Keyboard was built without VIA_BULK_TRANSFER_ENABLE')
+    if reply[1] != STATUS_OK:
+        raise BulkTransferError(f'Keyboard refused a {len(data)} byte transfer, it accepts at most {(reply[4] << 8) | reply[5]} bytes')
+    window, payload_size = reply[2], reply[3]
+
+    packets = (len(data) + payload_size - 1) // payload_size
+    acked = sent = resent = stalls = rewound = 0
+    while acked < packets:
+        while sent < packets and sent - acked < window:
+            payload = data[sent * payload_size:(sent + 1) * payload_size]
+            device.write(report(ID_BULK_DATA, sent & 0xFF, *payload))
+            sent += 1
+
+        reply = device.read()
+        if reply is not None and reply[1] == STATUS_OK:
+            # The keyboard is never more than a window ahead of what it acknowledged before
+            acked = max(acked, min(sent, acked + ((reply[2] - acked) & 0xFF)))
+            continue
+        if reply is not None and reply[1] != STATUS_ERROR_SEQUENCE:
+            raise BulkTransferError(f'Data report refused with status {reply[1]}')
+
+        # Go back to the first report the keyboard is missing, once the replies still in flight are drained
+        while reply is not None:
+            if reply[1] == STATUS_OK:
+                acked = max(acked, min(sent, acked + ((reply[2] - acked) & 0xFF)))
+            reply = device.read()
+        stalls = 0 if acked > rewound else stalls + 1
+        if stalls > retries:
+            raise BulkTransferError('No reply from the keyboard')
+        resent += sent - acked
+        rewound = acked
+        sent = acked
+
+    reply = _exchange(device, report(ID_BULK_COMMIT, crc8(data)), retries)
+    if reply[1] != STATUS_OK:
+        raise BulkTransferError(f'Commit refused with status {reply[1]}')
+    return resent
+
+
+def set_buffer_round_trips(size):
+    """Round trips the same upload takes with `id_dynamic_keymap_set_buffer`.
+    """
+    return (size + SET_BUFFER_PAYLOAD_SIZE - 1) // SET_BUFFER_PAYLOAD_SIZE
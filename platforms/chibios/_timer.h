@@ -17,3 +17,9 @@
 
 // The platform is 32-bit, so prefer 32-bit timers to avoid overflow
 #define FAST_TIMER_T_SIZE 32
+
+#include <stdint.h>
+
+// Microseconds at the resolution of the system tick, accumulated from one call to the next
+// so that the difference between two calls stays exact when systime_t wraps around.
+uint32_t timer_read_us32(void);
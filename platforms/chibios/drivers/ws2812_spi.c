@@ -1,5 +1,7 @@
+#include <string.h>
 #include "quantum.h"
 #include "ws2812.h"
+#include "ws2812_spi_protocol.h"
 
 /* Adapted from https://github.com/gamazeps/ws2812b-chibios-SPIDMA/ */
 
@@ -56,6 +58,11 @@
 #    define WS2812_SPI_DIVISOR_CR1_BR_X (SPI_CR1_BR_1 | SPI_CR1_BR_0)  // default
 #endif
 
+// Encode into one buffer while the other one is transmitted
+#if defined(WS2812_SPI_DOUBLE_BUFFER) && (defined(WS2812_SPI_USE_CIRCULAR_BUFFER) || defined(WS2812_SPI_SYNC))
+#    error "WS2812_SPI_DOUBLE_BUFFER cannot be used with WS2812_SPI_USE_CIRCULAR_BUFFER or WS2812_SPI_SYNC"
+#endif
+
 // Use SPI circular buffer
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
 #    define WS2812_SPI_BUFFER_MODE 1  // circular buffer
@@ -79,48 +86,79 @@
 #define DATA_SIZE (BYTES_FOR_LED * RGBLED_NUM)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
+
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+static uint8_t txbufs[2][TXBUF_SIZE] = {{0}};
+// The buffer that is not on the wire, ws2812_setleds() encodes into it
+static uint8_t* txbuf = txbufs[0];
+// Set while the DMA transfers a frame, so that ws2812_setleds() never waits for the SPI
+static volatile bool tx_busy = false;
+// txbuf holds a complete frame, to be sent as soon as the current transfer ends
+static volatile bool tx_pending = false;
+#else
+static uint8_t txbuf[TXBUF_SIZE] = {0};
+#endif
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+static const uint8_t protocol_eq_table[256][BYTES_FOR_LED_BYTE] = PROTOCOL_EQ_TABLE;
+#endif
 
-/*
- * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
- */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
+static void set_led_byte(uint8_t* tx, uint8_t data) {
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+    memcpy(tx, protocol_eq_table[data], BYTES_FOR_LED_BYTE);
+#else
+    for (int j = 0; j < 4; j++) tx[j] = get_protocol_eq(data, j);
+#endif
 }
 
 static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(tx_start, color.g);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE, color.r);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE * 2, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(tx_start, color.r);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE, color.g);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE * 2, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    set_led_byte(tx_start, color.b);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE, color.g);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE * 2, color.r);
 #endif
 #ifdef RGBW
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 4 + j] = get_protocol_eq(color.w, j);
+    set_led_byte(tx_start + BYTES_FOR_LED_BYTE * 3, color.w);
 #endif
 }
 
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+/*
+ * Hands txbuf to the DMA and moves encoding over to the other buffer.
+ * Must be called from a locked state.
+ */
+static void ws2812_start_send_i(void) {
+    spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf);
+    txbuf      = (txbuf == txbufs[0]) ? txbufs[1] : txbufs[0];
+    tx_busy    = true;
+    tx_pending = false;
+}
+
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    osalSysLockFromISR();
+    if (tx_pending) {
+        ws2812_start_send_i();
+    } else {
+        tx_busy = false;
+    }
+    osalSysUnlockFromISR();
+}
+#    define WS2812_SPI_END_CB ws2812_spi_end_cb
+#else
+#    define WS2812_SPI_END_CB NULL
+#endif
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
 
@@ -129,13 +167,13 @@ void ws2812_init(void) {
 #endif  // WS2812_SPI_SCK_PIN
 
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
+    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, WS2812_SPI_END_CB, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
 
     spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #endif
 }
 
@@ -146,17 +184,33 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+    // A frame that is still waiting is replaced by this one, keep the DMA off it while encoding
+    osalSysLock();
+    tx_pending = false;
+    osalSysUnlock();
+#endif
+
     for (uint8_t i = 0; i < leds; i++) {
         set_led_color_rgb(ledarray[i], i);
     }
 
     // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
     // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
-#ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
+#if defined(WS2812_SPI_DOUBLE_BUFFER)
+    // Sent right away if the SPI is idle, otherwise by the end callback of the current transfer
+    osalSysLock();
+    if (tx_busy) {
+        tx_pending = true;
+    } else {
+        ws2812_start_send_i();
+    }
+    osalSysUnlock();
+#elif !defined(WS2812_SPI_USE_CIRCULAR_BUFFER)
 #    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #    else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #    endif
 #endif
 }
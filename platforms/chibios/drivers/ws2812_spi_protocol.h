@@ -0,0 +1,50 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
+ * the ws2812b protocol, we use this helper function to translate bytes into
+ * 0s and 1s for the LED (with the appropriate timing).
+ */
+static inline uint8_t get_protocol_eq(uint8_t data, int pos) {
+    uint8_t eq = 0;
+    if (data & (1 << (2 * (3 - pos))))
+        eq = 0b1110;
+    else
+        eq = 0b1000;
+    if (data & (2 << (2 * (3 - pos))))
+        eq += 0b11100000;
+    else
+        eq += 0b10000000;
+    return eq;
+}
+
+/*
+ * Same translation as get_protocol_eq(), for all four positions of every byte value at once.
+ * Initializer of a uint8_t [256][4] table.
+ */
+#define PROTOCOL_EQ(data, pos) ((((data) >> (2 * (3 - (pos)))) & 1 ? 0b1110 : 0b1000) + (((data) >> (2 * (3 - (pos)) + 1)) & 1 ? 0b11100000 : 0b10000000))
+#define PROTOCOL_EQ_1(data) \
+    { PROTOCOL_EQ(data, 0), PROTOCOL_EQ(data, 1), PROTOCOL_EQ(data, 2), PROTOCOL_EQ(data, 3) }
+#define PROTOCOL_EQ_4(data) PROTOCOL_EQ_1(data), PROTOCOL_EQ_1(data + 1), PROTOCOL_EQ_1(data + 2), PROTOCOL_EQ_1(data + 3)
+#define PROTOCOL_EQ_16(data) PROTOCOL_EQ_4(data), PROTOCOL_EQ_4(data + 4), PROTOCOL_EQ_4(data + 8), PROTOCOL_EQ_4(data + 12)
+#define PROTOCOL_EQ_64(data) PROTOCOL_EQ_16(data), PROTOCOL_EQ_16(data + 16), PROTOCOL_EQ_16(data + 32), PROTOCOL_EQ_16(data + 48)
+#define PROTOCOL_EQ_TABLE \
+    { PROTOCOL_EQ_64(0), PROTOCOL_EQ_64(64), PROTOCOL_EQ_64(128), PROTOCOL_EQ_64(192) }
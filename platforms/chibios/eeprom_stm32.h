@@ -31,3 +31,24 @@ uint8_t  EEPROM_ReadDataByte(uint16_t Address);
 uint16_t EEPROM_ReadDataWord(uint16_t Address);
 
 void print_eeprom(void);
+
+#ifdef EEPROM_STM32_BANKED
+typedef struct {
+    uint32_t bank_sequence;      /* banks written over the lifetime of the flash, each bank was erased about half as often */
+    uint32_t compactions;        /* compactions since boot */
+    uint32_t forced_compactions; /* compactions a write had to complete itself because the write log was full */
+    uint32_t page_erases;        /* flash pages erased since boot */
+    uint16_t log_used;           /* bytes in use in the write log of the active bank */
+    uint16_t log_size;           /* bytes available to the write log of each bank */
+    uint32_t max_step_us;        /* longest single compaction step */
+    uint32_t last_compaction_us; /* flash time of the last compaction, from erasing the bank to switching over to it */
+    uint32_t max_write_us;       /* longest write, including any compaction it had to complete */
+} eeprom_stm32_stats_t;
+
+/* Runs one bounded step of background compaction, called from the main loop */
+void EEPROM_Task(void);
+void EEPROM_GetStats(eeprom_stm32_stats_t *stats);
+
+/* Time source for the stats, in microseconds */
+uint32_t eeprom_stm32_timestamp(void);
+#endif
@@ -0,0 +1,550 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <stdbool.h>
+#include <string.h>
+#include "util.h"
+#include "debug.h"
+#include "timer.h"
+#include "eeprom_stm32.h"
+#include "flash_stm32.h"
+#ifndef FLASH_STM32_MOCKED
+#    include <ch.h>
+#endif
+
+/*
+ * We emulate eeprom with two banks of flash pages. Only one bank is active at a
+ * time; it holds a snapshot of the eeprom contents followed by a write log:
+ *
+ * === SIMULATED EEPROM CONTENTS ===
+ *
+ * ┌──────────── Bank 0 ────────────┬──────────── Bank 1 ────────────┐
+ * ┌ Header ┬ Snapshot ┬ Write Log ──┬ Header ┬ Snapshot ┬ Write Log ──┐
+ * │MAGC SEQ│..........│[REC][REC]...│FFFFFFFF│FFFFFFFFFF│FFFFFFFFFFFFF│
+ * └────────┴──────────┴─────────────┴────────┴──────────┴─────────────┘
+ *
+ * Like the single bank backend, the snapshot is the 1's complement of the
+ * eeprom contents so that erased flash reads back as zeroes, and the whole
+ * contents are mirrored in RAM, so reads never touch flash.
+ *
+ * The following configuration defines can be set:
+ *
+ * FEE_PAGE_COUNT             # Total number of pages to use, split evenly between the two banks
+ * FEE_DENSITY_BYTES          # Size of simulated eeprom. (Defaults to half of a bank)
+ * FEE_RECORD_MAX_BYTES       # Largest write log record, longer block writes are split (Defaults to 64)
+ * FEE_COMPACTION_THRESHOLD   # Write log bytes in use before background compaction starts (Defaults to 3/4 of the log)
+ * FEE_COMPACTION_STEP_BYTES  # Snapshot bytes copied per EEPROM_Task() call (Defaults to 256)
+ *
+ *
+ * *** General Algorithm ***
+ *
+ * During initialization:
+ * The committed bank with the highest sequence number becomes active. Its
+ * snapshot is loaded into memory and its write log is replayed on top.
+ *
+ * During writes:
+ * The contents of the cache are updated first, then every run of changed bytes
+ * is appended to the write log of the active bank as a single record.
+ *
+ * From the main loop (EEPROM_Task()), one step at a time:
+ * The inactive bank is erased one page per step, as soon as it stops being
+ * active. Once the write log passes FEE_COMPACTION_THRESHOLD, the cached
+ * contents are copied into the inactive bank's snapshot, FEE_COMPACTION_STEP_BYTES
+ * per step. Writes to parts that were already copied are logged into both banks.
+ * Once the copy is complete, the new bank is committed and becomes active.
+ * Until then, the old bank remains the one found on power up.
+ *
+ * Only if the write log fills up before the main loop got to finish compaction
+ * does a write perform the remaining steps itself, which may erase flash.
+ *
+ *
+ * *** Bank Header ***
+ *
+ * ╔═ Magic ═╦═ Sequence ══╦═ State ═╗
+ * ║  0x4B42 ║ Low │ High  ║ 0x0000  ║
+ * ╚═════════╩═════╧═══════╩═════════╝
+ * The sequence increases with every compaction, the state is programmed last,
+ * once the snapshot is complete.
+ *
+ *
+ * *** Write Log Structure ***
+ *
+ * ╔═══════ Byte Record ═══════╗
+ * ║10XXXXXXXXXXXXXX║~VVVVVVVV║VVVVVVVV║
+ * ║  └────┬──────┘ ║ └──────┬────────┘║
+ * ║    Address     ║     Value        ║
+ * ╚════════════════╩══════════════════╝
+ *
+ * ╔════════════════════ Block Record ═════════════════════╗
+ * ║00XXXXXXXXXXXXXX║ Length ║ Data ...(padded)║ Checksum ║
+ * ╚════════════════╩════════╩═════════════════╩══════════╝
+ * 2 <= Length <= FEE_RECORD_MAX_BYTES
+ *
+ * A record whose value check or checksum fails was torn by a power loss and is
+ * skipped. A record that cannot be parsed at all ends the log, which is then
+ * considered full and gets compacted.
+ */
+
+#include "eeprom_stm32_defs.h"
+#if !defined(FEE_PAGE_SIZE) || !defined(FEE_PAGE_COUNT) || !defined(FEE_MCU_FLASH_SIZE) || !defined(FEE_PAGE_BASE_ADDRESS)
+#    error "not implemented."
+#endif
+
+#if (FEE_PAGE_COUNT < 2) || ((FEE_PAGE_COUNT) % 2) == 1
+#    error emulated eeprom: the banked backend needs an even FEE_PAGE_COUNT of at least 2
+#endif
+
+/* Flash word value after erase */
+#define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
+
+/* Addressable range 16KByte */
+#define FEE_ADDRESS_MAX_SIZE 0x4000
+
+#define FEE_BANK_PAGES (FEE_PAGE_COUNT / 2)
+#define FEE_BANK_SIZE (FEE_BANK_PAGES * FEE_PAGE_SIZE)
+#define FEE_BANK_HEADER_SIZE 8
+
+#define FEE_BANK_MAGIC 0x4B42
+#define FEE_BANK_COMMITTED 0x0000
+
+#ifndef FEE_MCU_FLASH_SIZE_IGNORE_CHECK
+#    if (FEE_PAGE_COUNT * FEE_PAGE_SIZE) > (FEE_MCU_FLASH_SIZE * 1024)
+#        pragma message STR(FEE_PAGE_COUNT * FEE_PAGE_SIZE) " > " STR(FEE_MCU_FLASH_SIZE * 1024)
+#        error emulated eeprom: FEE_PAGE_COUNT * FEE_PAGE_SIZE is greater than available flash size
+#    endif
+#endif
+
+/* Size of emulated eeprom */
+#ifdef FEE_DENSITY_BYTES
+#    if FEE_DENSITY_BYTES > FEE_ADDRESS_MAX_SIZE
+#        pragma message STR(FEE_DENSITY_BYTES) " > " STR(FEE_ADDRESS_MAX_SIZE)
+#        error emulated eeprom: FEE_DENSITY_BYTES is greater than FEE_ADDRESS_MAX_SIZE allows
+#    endif
+#    if ((FEE_DENSITY_BYTES) % 2) == 1
+#        error emulated eeprom: FEE_DENSITY_BYTES must be even
+#    endif
+#else
+/* Default to half of a bank used for the snapshot, half for the write log */
+#    define FEE_DENSITY_BYTES (FEE_BANK_SIZE / 2 < FEE_ADDRESS_MAX_SIZE ? FEE_BANK_SIZE / 2 : FEE_ADDRESS_MAX_SIZE)
+#endif
+
+#ifndef FEE_RECORD_MAX_BYTES
+#    define FEE_RECORD_MAX_BYTES 64
+#endif
+
+/* Size of the write log in each bank */
+#define FEE_WRITE_LOG_BYTES (FEE_BANK_SIZE - FEE_BANK_HEADER_SIZE - FEE_DENSITY_BYTES)
+
+#if FEE_WRITE_LOG_BYTES < 2 * (FEE_RECORD_MAX_BYTES + 6)
+#    pragma message STR(FEE_WRITE_LOG_BYTES) " < " STR(2 * (FEE_RECORD_MAX_BYTES + 6))
+#    error emulated eeprom: FEE_DENSITY_BYTES leaves no room for a write log, increase FEE_PAGE_COUNT
+#endif
+
+#ifndef FEE_COMPACTION_THRESHOLD
+#    define FEE_COMPACTION_THRESHOLD (FEE_WRITE_LOG_BYTES * 3 / 4)
+#endif
+
+#ifndef FEE_COMPACTION_STEP_BYTES
+#    define FEE_COMPACTION_STEP_BYTES 256
+#endif
+
+#if defined(DYNAMIC_KEYMAP_EEPROM_MAX_ADDR) && (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR >= FEE_DENSITY_BYTES)
+#    error emulated eeprom: DYNAMIC_KEYMAP_EEPROM_MAX_ADDR is greater than the FEE_DENSITY_BYTES available
+#endif
+
+/* Record encoding */
+#define FEE_RECORD_BYTE 0x8000
+#define FEE_RECORD_INVALID 0x4000
+/* Unchanged bytes worth including in a block record rather than starting a new one */
+#define FEE_RECORD_GAP 6
+
+/* Steps a compaction can take at most: erasing, opening, copying and committing, twice for a retry */
+#define FEE_COMPACTION_MAX_STEPS (2 * (FEE_BANK_PAGES + 1 + (FEE_DENSITY_BYTES + FEE_COMPACTION_STEP_BYTES - 1) / FEE_COMPACTION_STEP_BYTES))
+
+#define FEE_WORD(address) (*(const uint16_t *)(address))
+
+/* In-memory contents of emulated eeprom */
+static uint16_t WordBuf[FEE_DENSITY_BYTES / 2];
+static uint8_t *DataBuf = (uint8_t *)WordBuf;
+
+static uint8_t   active_bank;
+static uint32_t  active_sequence;
+static uintptr_t log_slot; /* first free slot within the write log of the active bank */
+
+static enum {
+    COMPACT_ERASE, /* erasing the inactive bank, page by page */
+    COMPACT_READY, /* inactive bank is blank, waiting for the write log to fill */
+    COMPACT_COPY,  /* copying the cache into the inactive bank */
+} compact_state;
+static uint16_t  compact_cursor; /* page being erased, or snapshot byte being copied */
+static uintptr_t next_log_slot;  /* first free slot within the write log of the bank being compacted */
+static uint32_t  compact_us;     /* flash time spent on the compaction in progress */
+
+static eeprom_stm32_stats_t stats;
+
+#ifdef FLASH_STM32_MOCKED
+__attribute__((weak)) uint32_t eeprom_stm32_timestamp(void) { return timer_read32() * 1000; }
+#else
+__attribute__((weak)) uint32_t eeprom_stm32_timestamp(void) { return timer_read_us32(); }
+#endif
+
+static inline uintptr_t bank_base(uint8_t bank) { return FEE_PAGE_BASE_ADDRESS + bank * FEE_BANK_SIZE; }
+static inline uintptr_t bank_snapshot(uint8_t bank) { return bank_base(bank) + FEE_BANK_HEADER_SIZE; }
+static inline uintptr_t bank_log_base(uint8_t bank) { return bank_snapshot(bank) + FEE_DENSITY_BYTES; }
+static inline uintptr_t bank_log_last(uint8_t bank) { return bank_base(bank) + FEE_BANK_SIZE; }
+
+static inline uint16_t record_size(uint16_t len) { return len == 1 ? 4 : 4 + ((len + 1) & ~1) + 2; }
+
+/* Data word of a block record, an odd length is padded with an erased byte */
+static inline uint16_t record_word(const uint8_t *data, uint16_t len, uint16_t offset) { return data[offset] | ((offset + 1 < len ? data[offset + 1] : 0xFF) << 8); }
+
+static uint16_t record_checksum(uint16_t address, uint16_t len, const uint8_t *data) {
+    uint16_t sum = address;
+    sum          = ((sum << 1) | (sum >> 15)) ^ len;
+    for (uint16_t offset = 0; offset < len; offset += 2) {
+        sum = ((sum << 1) | (sum >> 15)) ^ record_word(data, len, offset);
+    }
+    /* An unprogrammed checksum must never pass */
+    return sum == FEE_EMPTY_WORD ? 0 : sum;
+}
+
+void print_eeprom(void) {
+#ifndef NO_DEBUG
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        if (i % 16 == 0) xprintf("%04x", i);
+        if (i % 8 == 0) print(" ");
+        xprintf(" %02x", DataBuf[i]);
+        if ((i + 1) % 16 == 0) println("");
+    }
+#endif
+}
+
+/* Programming an erased word is a no-op, skip it */
+static FLASH_Status eeprom_program(uintptr_t address, uint16_t value) {
+    if (value == FEE_EMPTY_WORD) return FLASH_COMPLETE;
+    return FLASH_ProgramHalfWord(address, value);
+}
+
+static FLASH_Status eeprom_erase_page(uintptr_t page) {
+    for (uintptr_t address = page; address < page + FEE_PAGE_SIZE; address += 2) {
+        if (FEE_WORD(address) != FEE_EMPTY_WORD) {
+            stats.page_erases++;
+            return FLASH_ErasePage(page);
+        }
+    }
+    return FLASH_COMPLETE;
+}
+
+static FLASH_Status eeprom_write_header(uint8_t bank, uint32_t sequence) {
+    uintptr_t    base   = bank_base(bank);
+    FLASH_Status status = eeprom_program(base, FEE_BANK_MAGIC);
+    if (status == FLASH_COMPLETE) status = eeprom_program(base + 2, sequence);
+    if (status == FLASH_COMPLETE) status = eeprom_program(base + 4, sequence >> 16);
+    return status;
+}
+
+static bool eeprom_bank_valid(uint8_t bank, uint32_t *sequence) {
+    uintptr_t base = bank_base(bank);
+    if (FEE_WORD(base) != FEE_BANK_MAGIC || FEE_WORD(base + 6) != FEE_BANK_COMMITTED) {
+        return false;
+    }
+    *sequence = FEE_WORD(base + 2) | ((uint32_t)FEE_WORD(base + 4) << 16);
+    return true;
+}
+
+/* Appends the cached bytes of an eeprom range to a write log */
+static FLASH_Status eeprom_program_record(uintptr_t *slot, uint16_t address, uint16_t len) {
+    const uint8_t *data   = &DataBuf[address];
+    uintptr_t      record = *slot;
+    FLASH_Status   status;
+
+    /* Move on even if programming fails, a damaged slot is skipped on replay */
+    *slot += record_size(len);
+
+    if (len == 1) {
+        status = eeprom_program(record, FEE_RECORD_BYTE | address);
+        if (status == FLASH_COMPLETE) status = eeprom_program(record + 2, data[0] | ((uint8_t)~data[0] << 8));
+        return status;
+    }
+
+    status = eeprom_program(record, address);
+    if (status == FLASH_COMPLETE) status = eeprom_program(record + 2, len);
+    for (uint16_t offset = 0; offset < len && status == FLASH_COMPLETE; offset += 2) {
+        status = eeprom_program(record + 4 + offset, record_word(data, len, offset));
+    }
+    if (status == FLASH_COMPLETE) status = eeprom_program(*slot - 2, record_checksum(address, len, data));
+    return status;
+}
+
+/* Applies a write log to the cache, returns the first free slot */
+static uintptr_t eeprom_replay(uintptr_t slot, uintptr_t last) {
+    while (slot + 4 <= last) {
+        uint16_t head = FEE_WORD(slot);
+        uint16_t next = FEE_WORD(slot + 2);
+        if (head == FEE_EMPTY_WORD) {
+            break;
+        }
+        if (head & FEE_RECORD_INVALID) {
+            return last;
+        }
+
+        if (head & FEE_RECORD_BYTE) {
+            uint16_t address = head & ~FEE_RECORD_BYTE;
+            uint8_t  value   = next;
+            if ((uint8_t)(next >> 8) == (uint8_t)~value && address < FEE_DENSITY_BYTES) {
+                DataBuf[address] = value;
+            }
+            slot += 4;
+            continue;
+        }
+
+        uint16_t len = next;
+        if (len < 2 || len > FEE_RECORD_MAX_BYTES || slot + record_size(len) > last) {
+            return last;
+        }
+        const uint8_t *data = (const uint8_t *)(slot + 4);
+        if (head + len <= FEE_DENSITY_BYTES && FEE_WORD(slot + record_size(len) - 2) == record_checksum(head, len, data)) {
+            memcpy(&DataBuf[head], data, len);
+        }
+        slot += record_size(len);
+    }
+    return slot;
+}
+
+uint16_t EEPROM_Init(void) {
+    memset(&stats, 0, sizeof(stats));
+
+    uint32_t sequence[2];
+    bool     valid[2] = {eeprom_bank_valid(0, &sequence[0]), eeprom_bank_valid(1, &sequence[1])};
+
+    if (!valid[0] && !valid[1]) {
+        /* Blank or foreign contents, start over with an empty bank */
+        FLASH_Unlock();
+        for (uint16_t page = 0; page < FEE_BANK_PAGES; page++) {
+            eeprom_erase_page(bank_base(0) + page * FEE_PAGE_SIZE);
+        }
+        eeprom_write_header(0, 1);
+        eeprom_program(bank_base(0) + 6, FEE_BANK_COMMITTED);
+        FLASH_Lock();
+        valid[0]    = true;
+        sequence[0] = 1;
+    }
+
+    active_bank     = valid[0] && (!valid[1] || (int32_t)(sequence[0] - sequence[1]) > 0) ? 0 : 1;
+    active_sequence = sequence[active_bank];
+
+    /* Load the snapshot, then replay the write log */
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES / 2; i++) {
+        WordBuf[i] = ~FEE_WORD(bank_snapshot(active_bank) + i * 2);
+    }
+    log_slot = eeprom_replay(bank_log_base(active_bank), bank_log_last(active_bank));
+
+    /* Whatever the other bank holds is stale now */
+    compact_state  = COMPACT_ERASE;
+    compact_cursor = 0;
+    compact_us     = 0;
+
+    return FEE_DENSITY_BYTES;
+}
+
+/* Erase emulated eeprom */
+void EEPROM_Erase(void) {
+    FLASH_Unlock();
+    for (uint16_t page = 0; page < FEE_PAGE_COUNT; page++) {
+        eeprom_erase_page(FEE_PAGE_BASE_ADDRESS + page * FEE_PAGE_SIZE);
+    }
+    FLASH_Lock();
+    /* re-initialize to reset DataBuf */
+    EEPROM_Init();
+}
+
+/* Runs one bounded piece of compaction */
+static void eeprom_compact_step(void) {
+    uint32_t     start  = eeprom_stm32_timestamp();
+    uint8_t      bank   = active_bank ^ 1;
+    FLASH_Status status = FLASH_COMPLETE;
+
+    FLASH_Unlock();
+
+    switch (compact_state) {
+        case COMPACT_ERASE:
+            status = eeprom_erase_page(bank_base(bank) + compact_cursor * FEE_PAGE_SIZE);
+            if (++compact_cursor == FEE_BANK_PAGES) {
+                compact_state = COMPACT_READY;
+            }
+            break;
+
+        case COMPACT_READY:
+            /* Open the bank, it is only found on power up once committed */
+            status         = eeprom_write_header(bank, active_sequence + 1);
+            compact_state  = COMPACT_COPY;
+            compact_cursor = 0;
+            next_log_slot  = bank_log_base(bank);
+            break;
+
+        case COMPACT_COPY: {
+            uint16_t end = compact_cursor + FEE_COMPACTION_STEP_BYTES < FEE_DENSITY_BYTES ? compact_cursor + FEE_COMPACTION_STEP_BYTES : FEE_DENSITY_BYTES;
+            for (; compact_cursor < end && status == FLASH_COMPLETE; compact_cursor += 2) {
+                status = eeprom_program(bank_snapshot(bank) + compact_cursor, ~WordBuf[compact_cursor / 2]);
+            }
+            if (compact_cursor == FEE_DENSITY_BYTES && status == FLASH_COMPLETE) {
+                status = eeprom_program(bank_base(bank) + 6, FEE_BANK_COMMITTED);
+            }
+            if (compact_cursor == FEE_DENSITY_BYTES && status == FLASH_COMPLETE) {
+                active_bank = bank;
+                active_sequence++;
+                log_slot       = next_log_slot;
+                compact_state  = COMPACT_ERASE;
+                compact_cursor = 0;
+                stats.compactions++;
+            }
+            break;
+        }
+    }
+
+    FLASH_Lock();
+
+    if (status != FLASH_COMPLETE) {
+        /* Start over from a freshly erased bank */
+        compact_state  = COMPACT_ERASE;
+        compact_cursor = 0;
+    }
+
+    uint32_t elapsed = eeprom_stm32_timestamp() - start;
+    compact_us += elapsed;
+    if (elapsed > stats.max_step_us) {
+        stats.max_step_us = elapsed;
+    }
+    if (compact_state == COMPACT_ERASE && compact_cursor == 0 && status == FLASH_COMPLETE) {
+        stats.last_compaction_us = compact_us;
+        compact_us               = 0;
+    }
+}
+
+/* Completes the compaction in progress, for when the write log is full */
+static FLASH_Status eeprom_compact_finish(void) {
+    uint32_t compactions = stats.compactions;
+    stats.forced_compactions++;
+    for (uint16_t steps = 0; steps < FEE_COMPACTION_MAX_STEPS && stats.compactions == compactions; steps++) {
+        eeprom_compact_step();
+    }
+    return stats.compactions != compactions ? FLASH_COMPLETE : FLASH_ERROR_PG;
+}
+
+static FLASH_Status eeprom_write_record(uint16_t address, uint16_t len) {
+    if (log_slot + record_size(len) > bank_log_last(active_bank)) {
+        /* The rest of the snapshot of the new bank gets this write, but a part
+         * the copy already passed holds the old value and needs it logged */
+        bool         copied = compact_state == COMPACT_COPY && address < compact_cursor;
+        FLASH_Status status = eeprom_compact_finish();
+        if (status != FLASH_COMPLETE || !copied) {
+            return status;
+        }
+        if (log_slot + record_size(len) > bank_log_last(active_bank)) {
+            return FLASH_ERROR_PG;
+        }
+    }
+
+    FLASH_Unlock();
+    FLASH_Status status = eeprom_program_record(&log_slot, address, len);
+    /* Parts that were already copied need the write logged in the new bank as well */
+    if (compact_state == COMPACT_COPY && address < compact_cursor) {
+        if (eeprom_program_record(&next_log_slot, address, len) != FLASH_COMPLETE) {
+            compact_state  = COMPACT_ERASE;
+            compact_cursor = 0;
+        }
+    }
+    FLASH_Lock();
+
+    return status;
+}
+
+/* Updates the cache and logs every run of changed bytes as one record */
+static uint8_t eeprom_update(uint16_t address, const uint8_t *src, uint16_t len) {
+    uint32_t     start        = eeprom_stm32_timestamp();
+    FLASH_Status final_status = 0;
+
+    for (uint16_t i = 0; i < len;) {
+        if (DataBuf[address + i] == src[i]) {
+            i++;
+            continue;
+        }
+        uint16_t end = i + 1;
+        for (uint16_t j = end; j < len && j - i < FEE_RECORD_MAX_BYTES && j - end < FEE_RECORD_GAP; j++) {
+            if (DataBuf[address + j] != src[j]) {
+                end = j + 1;
+            }
+        }
+        memcpy(&DataBuf[address + i], &src[i], end - i);
+        FLASH_Status status = eeprom_write_record(address + i, end - i);
+        if (final_status == 0 || status != FLASH_COMPLETE) {
+            final_status = status;
+        }
+        i = end;
+    }
+
+    uint32_t elapsed = eeprom_stm32_timestamp() - start;
+    if (elapsed > stats.max_write_us) {
+        stats.max_write_us = elapsed;
+    }
+    return final_status;
+}
+
+void EEPROM_Task(void) {
+    if (compact_state == COMPACT_READY && log_slot - bank_log_base(active_bank) < FEE_COMPACTION_THRESHOLD) {
+        return;
+    }
+    eeprom_compact_step();
+}
+
+void EEPROM_GetStats(eeprom_stm32_stats_t *out) {
+    *out               = stats;
+    out->bank_sequence = active_sequence;
+    out->log_used      = log_slot - bank_log_base(active_bank);
+    out->log_size      = FEE_WRITE_LOG_BYTES;
+}
+
+uint8_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
+    if (Address >= FEE_DENSITY_BYTES) {
+        return FLASH_BAD_ADDRESS;
+    }
+    return eeprom_update(Address, &DataByte, 1);
+}
+
+uint8_t EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord) {
+    if (Address >= FEE_DENSITY_BYTES - 1) {
+        return FLASH_BAD_ADDRESS;
+    }
+    uint8_t bytes[2] = {DataWord, DataWord >> 8};
+    return eeprom_update(Address, bytes, 2);
+}
+
+uint8_t EEPROM_ReadDataByte(uint16_t Address) { return Address < FEE_DENSITY_BYTES ? DataBuf[Address] : 0xFF; }
+
+uint16_t EEPROM_ReadDataWord(uint16_t Address) { return Address < FEE_DENSITY_BYTES - 1 ? DataBuf[Address] | (DataBuf[Address + 1] << 8) : 0xFFFF; }
+
+/*****************************************************************************
+ *  Bind to eeprom_driver.c
+ *******************************************************************************/
+void eeprom_driver_init(void) { EEPROM_Init(); }
+
+void eeprom_driver_erase(void) { EEPROM_Erase(); }
+
+void eeprom_driver_task(void) { EEPROM_Task(); }
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t address = (uintptr_t)addr;
+    size_t    valid   = address < FEE_DENSITY_BYTES ? FEE_DENSITY_BYTES - address : 0;
+    if (valid > len) valid = len;
+
+    if (valid) memcpy(buf, &DataBuf[address], valid);
+    memset((uint8_t *)buf + valid, 0xFF, len - valid);
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    uintptr_t address = (uintptr_t)addr;
+    if (address >= FEE_DENSITY_BYTES) return;
+    if (len > FEE_DENSITY_BYTES - address) len = FEE_DENSITY_BYTES - address;
+
+    eeprom_update(address, (const uint8_t *)buf, len);
+}
@@ -45,3 +45,12 @@ uint32_t timer_read32(void) {
 uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
 
 uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+
+uint32_t timer_read_us32(void) {
+    static systime_t last;
+    static uint32_t  us;
+    systime_t        now = chVTGetSystemTimeX();
+    us += TIME_I2US(chTimeDiffX(last, now));
+    last = now;
+    return us;
+}
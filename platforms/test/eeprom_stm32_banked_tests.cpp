@@ -0,0 +1,331 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "flash_stm32.h"
+#include "eeprom_stm32.h"
+#include "eeprom.h"
+}
+
+/* Mock Flash Parameters:
+ *
+ * === Small Layout ===
+ * flash size: 2048, page size: 256, 4 pages per bank
+ * Simulated EEPROM size: 512, write log: 504
+ *
+ * === Large Layout ===
+ * flash size: 65536, page size: 2048, 8 pages per bank
+ * Simulated EEPROM size: 8192, write log: 8184
+ *
+ * FlashBuf Layout:
+ * [Unused | Header | Snapshot | Write Log | Header | Snapshot | Write Log ]
+ * [0......|BANK_BASE.........|+8+EEPROM..|BANK_BASE + BANK_SIZE..........]
+ */
+
+#define BANK_SIZE (FEE_PAGE_SIZE * FEE_PAGE_COUNT / 2)
+#define EEPROM_SIZE (BANK_SIZE / 2 < 0x4000 ? BANK_SIZE / 2 : 0x4000)
+#define LOG_SIZE (BANK_SIZE - 8 - EEPROM_SIZE)
+#define BANK_BASE (MOCK_FLASH_SIZE - 2 * BANK_SIZE)
+#define LOG_BASE(bank) (BANK_BASE + (bank)*BANK_SIZE + 8 + EEPROM_SIZE)
+#define LOG_THRESHOLD (LOG_SIZE * 3 / 4)
+
+/* Record sizes */
+#define BYTE_RECORD 4
+#define BLOCK_RECORD(len) (4 + (((len) + 1) & ~1) + 2)
+
+/* What the flash operations cost on the fake clock */
+#define ERASE_US 20000
+#define PROGRAM_US 50
+
+extern "C" uint32_t eeprom_stm32_timestamp(void) { return FlashEraseCount * ERASE_US + FlashProgramCount * PROGRAM_US; }
+
+class EepromStm32BankedTest : public testing::Test {
+   protected:
+    uint8_t expected[EEPROM_SIZE];
+
+    void SetUp() override {
+        EEPROM_Erase();
+        memset(expected, 0, sizeof(expected));
+    }
+
+    eeprom_stm32_stats_t stats() {
+        eeprom_stm32_stats_t stats;
+        EEPROM_GetStats(&stats);
+        return stats;
+    }
+
+    /* A block write of changing contents, as a keymap upload would do */
+    void write_block(uint16_t i) {
+        uint16_t address = (i * 37) % (EEPROM_SIZE - 16);
+        uint8_t  block[16];
+        for (uint8_t j = 0; j < sizeof(block); j++) {
+            block[j] = i + j * 3 + 1;
+        }
+        memcpy(&expected[address], block, sizeof(block));
+        eeprom_write_block(block, (void*)(uintptr_t)address, sizeof(block));
+    }
+
+    /* Fills the write log up to where background compaction kicks in */
+    void fill_log_to_threshold() {
+        for (uint16_t i = 0; stats().log_used < LOG_THRESHOLD; i++) {
+            EEPROM_WriteDataByte(EEPROM_SIZE / 2 + i % 64, i + 1);
+            expected[EEPROM_SIZE / 2 + i % 64] = i + 1;
+        }
+    }
+
+    void run_until_compacted() {
+        uint32_t compactions = stats().compactions;
+        for (int i = 0; i < 1000 && stats().compactions == compactions; i++) {
+            EEPROM_Task();
+        }
+        ASSERT_GT(stats().compactions, compactions);
+    }
+
+    void expect_contents() {
+        for (uint16_t i = 0; i < EEPROM_SIZE; i++) {
+            ASSERT_EQ(EEPROM_ReadDataByte(i), expected[i]) << "address " << i;
+        }
+    }
+};
+
+TEST_F(EepromStm32BankedTest, TestErase) {
+    EEPROM_WriteDataByte(0, 0x42);
+    EEPROM_Erase();
+    EXPECT_EQ(EEPROM_ReadDataByte(0), 0);
+    EXPECT_EQ(EEPROM_ReadDataByte(1), 0);
+}
+
+TEST_F(EepromStm32BankedTest, TestReadGarbage) {
+    uint8_t garbage = 0x3c;
+    for (int i = 0; i < MOCK_FLASH_SIZE; ++i) {
+        garbage ^= 0xa3;
+        garbage += i;
+        FlashBuf[i] = garbage;
+    }
+    EEPROM_Init();
+    /* Garbage is not a valid bank, the eeprom starts out empty and works */
+    EEPROM_WriteDataWord(10, 0xbeef);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(10), 0xbeef);
+}
+
+TEST_F(EepromStm32BankedTest, TestBadAddress) {
+    EXPECT_EQ(EEPROM_WriteDataByte(EEPROM_SIZE, 0x42), FLASH_BAD_ADDRESS);
+    EXPECT_EQ(EEPROM_WriteDataWord(EEPROM_SIZE - 1, 0xbeef), FLASH_BAD_ADDRESS);
+    EXPECT_EQ(EEPROM_ReadDataByte(EEPROM_SIZE), 0xFF);
+    EXPECT_EQ(EEPROM_ReadDataWord(EEPROM_SIZE - 1), 0xFFFF);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)(EEPROM_SIZE - 4)), 0);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)(EEPROM_SIZE - 3)), 0xFF000000);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)EEPROM_SIZE), 0xFFFFFFFF);
+}
+
+TEST_F(EepromStm32BankedTest, TestRoundTrip) {
+    EEPROM_WriteDataByte(3, 0xbe);
+    EEPROM_WriteDataWord(200, 0xabcd);
+    EEPROM_WriteDataWord(203, 0x9876);
+    eeprom_write_dword((uint32_t*)(EEPROM_SIZE - 4), 0x12345678);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(3), 0xbe);
+    EXPECT_EQ(EEPROM_ReadDataWord(200), 0xabcd);
+    EXPECT_EQ(EEPROM_ReadDataWord(203), 0x9876);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)(EEPROM_SIZE - 4)), 0x12345678);
+    /* Writing a value of all ones and back to zero */
+    EEPROM_WriteDataWord(200, 0xffff);
+    EEPROM_WriteDataByte(3, 0);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(200), 0xffff);
+    EXPECT_EQ(EEPROM_ReadDataByte(3), 0);
+}
+
+TEST_F(EepromStm32BankedTest, TestBlockIsOneRecord) {
+    uint8_t block[40];
+    for (uint8_t i = 0; i < sizeof(block); i++) {
+        block[i] = i + 1;
+    }
+    eeprom_write_block(block, (void*)100, sizeof(block));
+    EXPECT_EQ(stats().log_used, BLOCK_RECORD(40));
+
+    /* Unchanged bytes are not logged again */
+    eeprom_write_block(block, (void*)100, sizeof(block));
+    EXPECT_EQ(stats().log_used, BLOCK_RECORD(40));
+
+    /* Changes far apart are logged separately, nearby ones together */
+    block[0]  = 0x55;
+    block[39] = 0x55;
+    eeprom_write_block(block, (void*)100, sizeof(block));
+    EXPECT_EQ(stats().log_used, BLOCK_RECORD(40) + 2 * BYTE_RECORD);
+    block[10] = 0x66;
+    block[12] = 0x66;
+    eeprom_write_block(block, (void*)100, sizeof(block));
+    EXPECT_EQ(stats().log_used, BLOCK_RECORD(40) + 2 * BYTE_RECORD + BLOCK_RECORD(3));
+
+    EEPROM_Init();
+    uint8_t read[40];
+    eeprom_read_block(read, (void*)100, sizeof(read));
+    EXPECT_EQ(memcmp(read, block, sizeof(block)), 0);
+}
+
+TEST_F(EepromStm32BankedTest, TestLongBlockIsSplit) {
+    uint8_t block[200];
+    for (uint8_t i = 0; i < sizeof(block); i++) {
+        block[i] = i ^ 0xa5;
+    }
+    eeprom_write_block(block, (void*)1, sizeof(block));
+    EXPECT_EQ(stats().log_used, 3 * BLOCK_RECORD(64) + BLOCK_RECORD(8));
+
+    EEPROM_Init();
+    uint8_t read[200];
+    eeprom_read_block(read, (void*)1, sizeof(read));
+    EXPECT_EQ(memcmp(read, block, sizeof(block)), 0);
+}
+
+TEST_F(EepromStm32BankedTest, TestTornRecordIsSkipped) {
+    uint8_t first[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t torn[8]  = {9, 9, 9, 9, 9, 9, 9, 9};
+    eeprom_write_block(first, (void*)20, sizeof(first));
+    eeprom_write_block(torn, (void*)20, sizeof(torn));
+    /* Power was lost before the checksum of the second record was written */
+    *(uint16_t*)&FlashBuf[LOG_BASE(0) + 2 * BLOCK_RECORD(8) - 2] = 0xFFFF;
+
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)20), 0x04030201);
+
+    /* The log carries on after the torn record */
+    EEPROM_WriteDataByte(20, 0x42);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(20), 0x42);
+    EXPECT_EQ(EEPROM_ReadDataByte(21), 2);
+}
+
+TEST_F(EepromStm32BankedTest, TestUnreadableLogIsCompacted) {
+    EEPROM_WriteDataWord(30, 0x1234);
+    /* Power was lost after the first word of a block record */
+    *(uint16_t*)&FlashBuf[LOG_BASE(0) + BLOCK_RECORD(2)] = 40;
+
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(30), 0x1234);
+    EXPECT_EQ(stats().log_used, LOG_SIZE);
+
+    run_until_compacted();
+    EXPECT_EQ(stats().log_used, 0);
+    EEPROM_WriteDataWord(40, 0x5678);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(30), 0x1234);
+    EXPECT_EQ(EEPROM_ReadDataWord(40), 0x5678);
+}
+
+TEST_F(EepromStm32BankedTest, TestWritesNeverEraseWithTask) {
+    for (uint16_t i = 0; stats().compactions < 3; i++) {
+        ASSERT_LT(i, 10000);
+        uint32_t erases = FlashEraseCount;
+        write_block(i);
+        ASSERT_EQ(FlashEraseCount, erases) << "write " << i;
+        EEPROM_Task();
+    }
+    EXPECT_EQ(stats().forced_compactions, 0);
+    expect_contents();
+
+    EEPROM_Init();
+    expect_contents();
+}
+
+TEST_F(EepromStm32BankedTest, TestFullLogWithoutTaskIsCompacted) {
+    for (uint16_t i = 0; stats().compactions < 2; i++) {
+        ASSERT_LT(i, 10000);
+        write_block(i);
+    }
+    EXPECT_EQ(stats().forced_compactions, 2);
+    /* The second compaction had to erase the first bank inside a write */
+    EXPECT_GE(stats().max_write_us, ERASE_US);
+    expect_contents();
+
+    EEPROM_Init();
+    expect_contents();
+}
+
+TEST_F(EepromStm32BankedTest, TestPowerLossDuringCompaction) {
+    fill_log_to_threshold();
+    /* Check the blank bank, open it and copy the first part */
+    for (int i = 0; i < FEE_PAGE_COUNT / 2 + 2; i++) {
+        EEPROM_Task();
+    }
+    ASSERT_EQ(stats().compactions, 0);
+
+    /* One write lands in the part already copied, one in the rest */
+    EEPROM_WriteDataByte(0, 0x11);
+    EEPROM_WriteDataByte(EEPROM_SIZE - 1, 0x22);
+    expected[0]               = 0x11;
+    expected[EEPROM_SIZE - 1] = 0x22;
+
+    EEPROM_Init();
+    expect_contents();
+}
+
+TEST_F(EepromStm32BankedTest, TestWritesDuringCompactionReachNewBank) {
+    fill_log_to_threshold();
+    for (int i = 0; i < FEE_PAGE_COUNT / 2 + 2; i++) {
+        EEPROM_Task();
+    }
+    ASSERT_EQ(stats().compactions, 0);
+
+    EEPROM_WriteDataByte(0, 0x11);
+    EEPROM_WriteDataByte(EEPROM_SIZE - 1, 0x22);
+    expected[0]               = 0x11;
+    expected[EEPROM_SIZE - 1] = 0x22;
+
+    run_until_compacted();
+    EXPECT_EQ(stats().bank_sequence, 2);
+    /* Only the write to the part already copied had to be logged again */
+    EXPECT_EQ(stats().log_used, BYTE_RECORD);
+
+    EEPROM_Init();
+    EXPECT_EQ(stats().bank_sequence, 2);
+    expect_contents();
+}
+
+TEST_F(EepromStm32BankedTest, TestFullLogDuringCopyKeepsWrite) {
+    fill_log_to_threshold();
+    for (int i = 0; i < FEE_PAGE_COUNT / 2 + 2; i++) {
+        EEPROM_Task();
+    }
+    ASSERT_EQ(stats().compactions, 0);
+
+    /* Fill the log with writes to the part already copied, the last one completes the compaction */
+    for (uint16_t i = 0; stats().forced_compactions == 0; i++) {
+        ASSERT_LT(i, 10000);
+        EEPROM_WriteDataByte(0, i + 1);
+        expected[0] = i + 1;
+    }
+    EXPECT_EQ(stats().bank_sequence, 2);
+    expect_contents();
+
+    EEPROM_Init();
+    expect_contents();
+}
+
+TEST_F(EepromStm32BankedTest, TestStatsReportWearAndTiming) {
+    EXPECT_EQ(stats().bank_sequence, 1);
+    EXPECT_EQ(stats().log_size, LOG_SIZE);
+
+    for (uint16_t i = 0; stats().compactions < 2; i++) {
+        ASSERT_LT(i, 10000);
+        write_block(i);
+        EEPROM_Task();
+    }
+    auto s = stats();
+    EXPECT_EQ(s.bank_sequence, 3);
+    /* The used pages of the first bank were erased again for the second compaction */
+    EXPECT_GT(s.page_erases, 0);
+    EXPECT_LE(s.page_erases, FEE_PAGE_COUNT / 2);
+    EXPECT_GE(s.last_compaction_us, s.page_erases * ERASE_US);
+    /* No step erases more than a page, no write erases at all */
+    EXPECT_LE(s.max_step_us, ERASE_US);
+    EXPECT_LT(s.max_write_us, ERASE_US);
+
+    /* Wear survives a power cycle, the rest is since boot */
+    EEPROM_Init();
+    EXPECT_EQ(stats().bank_sequence, 3);
+    EXPECT_EQ(stats().compactions, 0);
+}
@@ -18,7 +18,9 @@
 #include <stdbool.h>
 #include "flash_stm32.h"
 
-uint8_t FlashBuf[MOCK_FLASH_SIZE] = {0};
+uint8_t  FlashBuf[MOCK_FLASH_SIZE] = {0};
+uint32_t FlashEraseCount;
+uint32_t FlashProgramCount;
 
 static bool flash_locked = true;
 
@@ -28,6 +30,7 @@ FLASH_Status FLASH_ErasePage(uint32_t Page_Address) {
     Page_Address -= (Page_Address % FEE_PAGE_SIZE);
     if (Page_Address >= MOCK_FLASH_SIZE) return FLASH_BAD_ADDRESS;
     memset(&FlashBuf[Page_Address], '\xff', FEE_PAGE_SIZE);
+    FlashEraseCount++;
     return FLASH_COMPLETE;
 }
 
@@ -38,6 +41,7 @@ FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
     uint16_t oldData = *(uint16_t*)&FlashBuf[Address];
     if (oldData == 0xFFFF || Data == 0) {
         *(uint16_t*)&FlashBuf[Address] = Data;
+        FlashProgramCount++;
         return FLASH_COMPLETE;
     } else {
         return FLASH_ERROR_PG;
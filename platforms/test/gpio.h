@@ -0,0 +1,68 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pin_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t pin_t;
+
+/* Implemented by gpio_mock.c, for tests that need real pin behaviour */
+
+#define GPIO_MOCK_PIN_COUNT 64
+
+typedef enum {
+    GPIO_MOCK_INPUT,
+    GPIO_MOCK_INPUT_HIGH,
+    GPIO_MOCK_INPUT_LOW,
+    GPIO_MOCK_OUTPUT,
+} gpio_mock_mode_t;
+
+void gpio_mock_set_mode(pin_t pin, gpio_mock_mode_t mode);
+void gpio_mock_write(pin_t pin, bool level);
+bool gpio_mock_read(pin_t pin);
+void gpio_mock_toggle(pin_t pin);
+
+/* Test helpers */
+void             gpio_mock_reset(void);
+void             gpio_mock_set_switch(pin_t a, pin_t b, bool closed);
+gpio_mock_mode_t gpio_mock_get_mode(pin_t pin);
+uint32_t         gpio_mock_get_read_count(void);
+void             gpio_mock_clear_read_count(void);
+
+/* Operation of GPIO by pin. */
+
+#define setPinInput(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT)
+#define setPinInputHigh(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT_HIGH)
+#define setPinInputLow(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT_LOW)
+#define setPinOutput(pin) gpio_mock_set_mode(pin, GPIO_MOCK_OUTPUT)
+
+#define writePinHigh(pin) gpio_mock_write(pin, true)
+#define writePinLow(pin) gpio_mock_write(pin, false)
+#define writePin(pin, level) gpio_mock_write(pin, level)
+
+#define readPin(pin) gpio_mock_read(pin)
+
+#define togglePin(pin) gpio_mock_toggle(pin)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Pins connected by closed switches. An input pin follows any output it is
+ * connected to (low wins), otherwise its pull. Diodes are not modelled.
+ */
+
+#include <string.h>
+#include "gpio.h"
+
+static gpio_mock_mode_t pin_mode[GPIO_MOCK_PIN_COUNT];
+static bool             pin_level[GPIO_MOCK_PIN_COUNT];
+static uint64_t         pin_switches[GPIO_MOCK_PIN_COUNT];
+static uint32_t         read_count;
+
+void gpio_mock_reset(void) {
+    memset(pin_mode, 0, sizeof(pin_mode));
+    memset(pin_level, 0, sizeof(pin_level));
+    memset(pin_switches, 0, sizeof(pin_switches));
+    read_count = 0;
+}
+
+void gpio_mock_set_switch(pin_t a, pin_t b, bool closed) {
+    if (a >= GPIO_MOCK_PIN_COUNT || b >= GPIO_MOCK_PIN_COUNT) return;
+    if (closed) {
+        pin_switches[a] |= (uint64_t)1 << b;
+        pin_switches[b] |= (uint64_t)1 << a;
+    } else {
+        pin_switches[a] &= ~((uint64_t)1 << b);
+        pin_switches[b] &= ~((uint64_t)1 << a);
+    }
+}
+
+gpio_mock_mode_t gpio_mock_get_mode(pin_t pin) { return pin < GPIO_MOCK_PIN_COUNT ? pin_mode[pin] : GPIO_MOCK_INPUT; }
+
+uint32_t gpio_mock_get_read_count(void) { return read_count; }
+
+void gpio_mock_clear_read_count(void) { read_count = 0; }
+
+void gpio_mock_set_mode(pin_t pin, gpio_mock_mode_t mode) {
+    if (pin >= GPIO_MOCK_PIN_COUNT) return;
+    pin_mode[pin] = mode;
+}
+
+void gpio_mock_write(pin_t pin, bool level) {
+    if (pin >= GPIO_MOCK_PIN_COUNT) return;
+    pin_level[pin] = level;
+}
+
+void gpio_mock_toggle(pin_t pin) {
+    if (pin >= GPIO_MOCK_PIN_COUNT) return;
+    pin_level[pin] = !pin_level[pin];
+}
+
+bool gpio_mock_read(pin_t pin) {
+    if (pin >= GPIO_MOCK_PIN_COUNT) return true;
+    read_count++;
+
+    if (pin_mode[pin] == GPIO_MOCK_OUTPUT) {
+        return pin_level[pin];
+    }
+
+    bool driven = false;
+    bool level  = true;
+    for (pin_t other = 0; other < GPIO_MOCK_PIN_COUNT; other++) {
+        if ((pin_switches[pin] & ((uint64_t)1 << other)) && pin_mode[other] == GPIO_MOCK_OUTPUT) {
+            driven = true;
+            level &= pin_level[other];
+        }
+    }
+    if (driven) {
+        return level;
+    }
+
+    return pin_mode[pin] != GPIO_MOCK_INPUT_LOW;
+}
@@ -22,3 +22,33 @@ eeprom_stm32_SRC := \
 	$(PLATFORM_PATH)/chibios/eeprom_stm32.c
 eeprom_stm32_tiny_SRC := $(eeprom_stm32_SRC)
 eeprom_stm32_large_SRC := $(eeprom_stm32_SRC)
+
+eeprom_stm32_banked_DEFS := $(eeprom_stm32_DEFS) -DEEPROM_STM32_BANKED
+eeprom_stm32_banked_small_DEFS := $(eeprom_stm32_banked_DEFS) \
+	-DFEE_MCU_FLASH_SIZE=2 \
+	-DMOCK_FLASH_SIZE=2048 \
+	-DFEE_PAGE_SIZE=256 \
+	-DFEE_PAGE_COUNT=8
+eeprom_stm32_banked_large_DEFS := $(eeprom_stm32_banked_DEFS) \
+	-DFEE_MCU_FLASH_SIZE=64 \
+	-DMOCK_FLASH_SIZE=65536 \
+	-DFEE_PAGE_SIZE=2048 \
+	-DFEE_PAGE_COUNT=16
+
+eeprom_stm32_banked_small_INC := $(eeprom_stm32_INC)
+eeprom_stm32_banked_large_INC := $(eeprom_stm32_INC)
+
+eeprom_stm32_banked_SRC := \
+	$(TOP_DIR)/drivers/eeprom/eeprom_driver.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/eeprom_stm32_banked_tests.cpp \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/flash_stm32_mock.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c \
+	$(PLATFORM_PATH)/chibios/eeprom_stm32_banked.c
+eeprom_stm32_banked_small_SRC := $(eeprom_stm32_banked_SRC)
+eeprom_stm32_banked_large_SRC := $(eeprom_stm32_banked_SRC)
+
+ws2812_spi_INC := \
+	$(PLATFORM_PATH)/chibios/drivers/
+
+ws2812_spi_SRC := \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/ws2812_spi_tests.cpp
@@ -1 +1 @@
-TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large
+TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large eeprom_stm32_banked_small eeprom_stm32_banked_large ws2812_spi
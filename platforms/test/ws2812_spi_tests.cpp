@@ -0,0 +1,32 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ws2812_spi_protocol.h"
+}
+
+/* The table used by WS2812_SPI_DOUBLE_BUFFER */
+static const uint8_t protocol_eq_table[256][4] = PROTOCOL_EQ_TABLE;
+
+TEST(WS2812SPI, TableMatchesProtocolEq) {
+    for (int data = 0; data < 256; data++) {
+        for (int pos = 0; pos < 4; pos++) {
+            EXPECT_EQ(protocol_eq_table[data][pos], get_protocol_eq(data, pos)) << "byte " << data << ", position " << pos;
+        }
+    }
+}
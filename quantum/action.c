@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action.h"
 #include "wait.h"
 #include "keycode_config.h"
+#include "latency_trace.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -69,6 +70,7 @@ __attribute__((weak)) bool pre_process_record_quantum(keyrecord_t *record) { ret
  */
 void action_exec(keyevent_t event) {
     if (!IS_NOEVENT(event)) {
+        latency_trace_mark(LATENCY_STAGE_ACTION);
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: ");
         debug_event(event);
@@ -3,6 +3,7 @@
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "matrix.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -246,16 +247,15 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
-/** \brief Layer switch get layer
+#ifndef NO_ACTION_LAYER
+/** \brief Resolve layer
  *
- * Gets the layer based on key info
+ * Walks the given layer stack from the top and returns the first layer whose action for the key is not transparent
  */
-uint8_t layer_switch_get_layer(keypos_t key) {
-#ifndef NO_ACTION_LAYER
+static uint8_t layer_switch_resolve_layer(keypos_t key, layer_state_t layers) {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
-    layer_state_t layers = layer_state | default_layer_state;
     /* check top layer first */
     for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
         if (layers & ((layer_state_t)1 << i)) {
@@ -267,6 +267,61 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     }
     /* fall back to layer 0 */
     return 0;
+}
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE_ENABLE)
+/** \brief resolved layer cache
+ *
+ * Topmost non-transparent layer of every key, valid for the combined
+ * layer_state | default_layer_state held in resolved_layers_state.
+ * Keys are resolved lazily on their first lookup after a layer change.
+ */
+static uint8_t       resolved_layers[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t  resolved_layers_valid[MATRIX_ROWS] = {0};
+static layer_state_t resolved_layers_state              = 0;
+
+/** \brief clear resolved layer cache
+ *
+ * Forgets every resolved key, must be called whenever the keymap itself changes
+ */
+void layer_resolve_cache_clear(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        resolved_layers_valid[row] = 0;
+    }
+}
+
+/** \brief sync resolved layer cache
+ *
+ * Invalidates the cache if the layer stack changed since it was built
+ */
+static void layer_resolve_cache_sync(void) {
+    layer_state_t layers = layer_state | default_layer_state;
+    if (layers != resolved_layers_state) {
+        resolved_layers_state = layers;
+        layer_resolve_cache_clear();
+    }
+}
+#endif
+
+/** \brief Layer switch get layer
+ *
+ * Gets the layer based on key info
+ */
+uint8_t layer_switch_get_layer(keypos_t key) {
+#ifndef NO_ACTION_LAYER
+#    ifdef LAYER_RESOLVE_CACHE_ENABLE
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        layer_resolve_cache_sync();
+        matrix_row_t col_mask = (matrix_row_t)1 << key.col;
+        if (!(resolved_layers_valid[key.row] & col_mask)) {
+            resolved_layers[key.row][key.col] = layer_switch_resolve_layer(key, resolved_layers_state);
+            resolved_layers_valid[key.row] |= col_mask;
+        }
+        return resolved_layers[key.row][key.col];
+    }
+#    endif
+    return layer_switch_resolve_layer(key, layer_state | default_layer_state);
 #else
     return get_highest_layer(default_layer_state);
 #endif
@@ -140,6 +140,11 @@ uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
 
+/* resolved layer cache */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE_ENABLE)
+void layer_resolve_cache_clear(void);
+#endif
+
 /* return the topmost non-transparent layer currently associated with key */
 uint8_t layer_switch_get_layer(keypos_t key);
 
@@ -15,6 +15,10 @@
  */
 #include "quantum.h"
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom_cache.h"
+#endif
+
 /** \brief Reset eeprom
  *
  * ...just incase someone wants to only change the eeprom behaviour
@@ -51,6 +55,10 @@ __attribute__((weak)) void bootmagic_lite(void) {
 
     if (matrix_get_row(row) & (1 << col)) {
         bootmagic_lite_reset_eeprom();
+#ifdef EEPROM_CACHE_ENABLE
+        // The reset only reached the cache so far
+        eeprom_cache_flush();
+#endif
 
         // Jump to bootloader.
         bootloader_jump();
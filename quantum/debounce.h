@@ -8,6 +8,10 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 
 bool debounce_active(void);
 
+// true while debounce() has to be called even if raw has not changed,
+// defaults to debounce_active()
+bool debounce_pending(void);
+
 void debounce_init(uint8_t num_rows);
 
 void debounce_free(void);
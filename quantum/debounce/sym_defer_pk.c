@@ -135,6 +135,8 @@ static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], u
 }
 
 bool debounce_active(void) { return true; }
+
+bool debounce_pending(void) { return counters_need_update; }
 #else
 #    include "none.c"
 #endif
@@ -0,0 +1,168 @@
+/*
+Copyright 2017 Alex Ong<the.onga@gmail.com>
+Copyright 2020 Andrei Purdea<andrei@purdea.ro>
+Copyright 2021 Simon Arlott
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Symmetric per-key algorithm using vertical counters. Behaves exactly like
+sym_defer_pk, but instead of one 8-bit counter per key, each row stores its
+counters as bit-planes: plane N holds bit N of the counter of every key in the
+row. Decrementing by the elapsed time is then a bit-sliced subtraction over
+whole matrix_row_t words, so a row of up to 32 keys is updated in a handful of
+word operations, and no heap is required.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Maximum debounce: 255ms
+#if DEBOUNCE > UINT8_MAX
+#    undef DEBOUNCE
+#    define DEBOUNCE UINT8_MAX
+#endif
+
+// Number of bit-planes needed to hold DEBOUNCE
+#if DEBOUNCE < 2
+#    define DEBOUNCE_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_BITS 7
+#else
+#    define DEBOUNCE_BITS 8
+#endif
+
+#if DEBOUNCE > 0
+// we use num_rows at runtime to support split keyboards, MATRIX_ROWS is always large enough
+static matrix_row_t debounce_planes[MATRIX_ROWS][DEBOUNCE_BITS];
+static matrix_row_t debounce_counting[MATRIX_ROWS];
+static fast_timer_t last_time;
+static bool         counters_need_update;
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        debounce_counting[row] = 0;
+    }
+    counters_need_update = false;
+}
+
+void debounce_free(void) {}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+
+    if (counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+
+        last_time    = now;
+        updated_last = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+
+        if (elapsed_time > 0) {
+            update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+
+    if (changed) {
+        if (!updated_last) {
+            last_time = timer_read_fast();
+        }
+
+        start_debounce_counters(raw, cooked, num_rows);
+    }
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t counting = debounce_counting[row];
+        if (!counting) {
+            continue;
+        }
+
+        matrix_row_t expired;
+        if (elapsed_time >= DEBOUNCE) {
+            // no counter can hold more than DEBOUNCE
+            expired = counting;
+        } else {
+            // bit-sliced subtraction of elapsed_time from every counter in the row
+            matrix_row_t borrow  = 0;
+            matrix_row_t nonzero = 0;
+            for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+                matrix_row_t plane    = debounce_planes[row][bit];
+                matrix_row_t subtract = (elapsed_time & (1 << bit)) ? (matrix_row_t)~0 : 0;
+                matrix_row_t diff     = plane ^ subtract ^ borrow;
+
+                borrow                    = (~plane & (subtract | borrow)) | (subtract & borrow);
+                debounce_planes[row][bit] = diff;
+                nonzero |= diff;
+            }
+            // counter <= elapsed_time: either it went negative or reached zero
+            expired = counting & (borrow | ~nonzero);
+        }
+
+        cooked[row]            = (cooked[row] & ~expired) | (raw[row] & expired);
+        debounce_counting[row] = counting & ~expired;
+        if (debounce_counting[row]) {
+            counters_need_update = true;
+        }
+    }
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        matrix_row_t start = delta & ~debounce_counting[row];
+
+        if (start) {
+            for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+                if (DEBOUNCE & (1 << bit)) {
+                    debounce_planes[row][bit] |= start;
+                } else {
+                    debounce_planes[row][bit] &= ~start;
+                }
+            }
+            counters_need_update = true;
+        }
+
+        // keys that returned to their debounced state stop counting
+        debounce_counting[row] = delta;
+    }
+}
+
+bool debounce_active(void) { return true; }
+
+bool debounce_pending(void) { return counters_need_update; }
+#else
+#    include "none.c"
+#endif
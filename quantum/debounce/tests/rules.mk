@@ -28,6 +28,13 @@ debounce_sym_defer_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/sym_defer_pk.c \
 	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_tests.cpp
 
+debounce_sym_defer_pk_vc_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_defer_pk_vc_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_pk_vc.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_reference.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_vc_tests.cpp
+
 debounce_sym_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
 debounce_sym_eager_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/sym_eager_pk.c \
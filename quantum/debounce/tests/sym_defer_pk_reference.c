@@ -0,0 +1,15 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * sym_defer_pk built under different symbol names, so that it can be linked
+ * next to another debounce algorithm and used as a behavioural reference.
+ */
+
+#define debounce_init reference_debounce_init
+#define debounce_free reference_debounce_free
+#define debounce reference_debounce
+#define debounce_active reference_debounce_active
+#define debounce_pending reference_debounce_pending
+
+#include "../sym_defer_pk.c"
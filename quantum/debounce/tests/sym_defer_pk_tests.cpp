@@ -18,6 +18,13 @@
 
 #include "debounce_test_common.h"
 
+extern "C" {
+#include "debounce.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
 TEST_F(DebounceTest, OneKeyShort1) {
     addEvents({
         /* Time, Inputs, Outputs */
@@ -238,3 +245,25 @@ TEST_F(DebounceTest, OneKeyDelayedScan4) {
     time_jumps_ = true;
     runEvents();
 }
+
+TEST(DebouncePending, OnlyWhileCountersRun) {
+    matrix_row_t raw[MATRIX_ROWS]    = {0};
+    matrix_row_t cooked[MATRIX_ROWS] = {0};
+
+    set_time(1000);
+    debounce_init(MATRIX_ROWS);
+    EXPECT_FALSE(debounce_pending());
+
+    raw[0] = 1;
+    debounce(raw, cooked, MATRIX_ROWS, true);
+    EXPECT_TRUE(debounce_pending());
+
+    advance_time(DEBOUNCE);
+    debounce(raw, cooked, MATRIX_ROWS, false);
+    EXPECT_EQ(cooked[0], 1);
+    EXPECT_FALSE(debounce_pending());
+
+    /* What the deprecated matrix_is_modified() reports is unchanged */
+    EXPECT_TRUE(debounce_active());
+    debounce_free();
+}
@@ -0,0 +1,145 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The vertical counter implementation also runs the whole sym_defer_pk test
+ * suite; these tests additionally compare it against the reference
+ * sym_defer_pk implementation on long pseudo-random input streams.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include "quantum.h"
+#include "timer.h"
+#include "debounce.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+void reference_debounce_init(uint8_t num_rows);
+void reference_debounce_free(void);
+void reference_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+}
+
+namespace {
+
+class Lcg {
+   public:
+    explicit Lcg(uint32_t seed) : state_(seed) {}
+
+    uint32_t next() {
+        state_ = state_ * 1664525 + 1013904223;
+        return state_ >> 8;
+    }
+
+   private:
+    uint32_t state_;
+};
+
+/* Flip each key of the matrix with a probability of 1/flip_odds */
+bool chatter(Lcg &rng, matrix_row_t raw[], uint32_t flip_odds) {
+    bool changed = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (rng.next() % flip_odds == 0) {
+                raw[row] ^= (matrix_row_t)1 << col;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+void run_equivalence(uint32_t seed, uint32_t flip_odds, uint32_t max_step) {
+    Lcg          rng(seed);
+    matrix_row_t raw[MATRIX_ROWS]        = {0};
+    matrix_row_t cooked[MATRIX_ROWS]     = {0};
+    matrix_row_t ref_cooked[MATRIX_ROWS] = {0};
+
+    set_time(7777);
+    debounce_init(MATRIX_ROWS);
+    reference_debounce_init(MATRIX_ROWS);
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        advance_time(rng.next() % (max_step + 1));
+        bool changed = chatter(rng, raw, flip_odds);
+
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+        reference_debounce(raw, ref_cooked, MATRIX_ROWS, changed);
+
+        ASSERT_EQ(0, memcmp(cooked, ref_cooked, sizeof(cooked))) << "seed " << seed << " diverged at step " << i;
+    }
+
+    debounce_free();
+    reference_debounce_free();
+}
+
+} // namespace
+
+TEST(DebounceVerticalCounter, MatchesReferenceOnFastScans) {
+    run_equivalence(1, 50, 1);
+}
+
+TEST(DebounceVerticalCounter, MatchesReferenceOnSlowScans) {
+    run_equivalence(2, 20, 4);
+}
+
+TEST(DebounceVerticalCounter, MatchesReferenceOnTimeJumps) {
+    run_equivalence(3, 10, 300);
+}
+
+TEST(DebounceVerticalCounter, MatchesReferenceUnderHeavyChatter) {
+    run_equivalence(4, 3, 2);
+}
+
+TEST(DebounceVerticalCounter, Benchmark) {
+    const uint32_t iterations = 200000;
+    double         ns_per_call[2];
+
+    for (int impl = 0; impl < 2; impl++) {
+        Lcg          rng(5);
+        matrix_row_t raw[MATRIX_ROWS]    = {0};
+        matrix_row_t cooked[MATRIX_ROWS] = {0};
+
+        set_time(7777);
+        impl ? reference_debounce_init(MATRIX_ROWS) : debounce_init(MATRIX_ROWS);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            advance_time(1);
+            bool changed = chatter(rng, raw, 8);
+            if (impl) {
+                reference_debounce(raw, cooked, MATRIX_ROWS, changed);
+            } else {
+                debounce(raw, cooked, MATRIX_ROWS, changed);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        impl ? reference_debounce_free() : debounce_free();
+        ns_per_call[impl] = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    /* Includes the cost of generating the input, which is the same for both */
+    printf("sym_defer_pk_vc: %.1f ns/scan, sym_defer_pk: %.1f ns/scan (%dx%d matrix)\n", ns_per_call[0], ns_per_call[1], MATRIX_ROWS, MATRIX_COLS);
+    RecordProperty("sym_defer_pk_vc_ns_per_scan", (int)ns_per_call[0]);
+    RecordProperty("sym_defer_pk_ns_per_scan", (int)ns_per_call[1]);
+}
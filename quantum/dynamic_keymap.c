@@ -75,10 +75,31 @@
 #    error Dynamic keymaps are configured to use more EEPROM than is available.
 #endif
 
+// Recorded dynamic macros are kept in the last bytes of the macro region.
+#if defined(DYNAMIC_MACRO_ENABLE) && defined(DYNAMIC_MACRO_EEPROM_ENABLE)
+#    define DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE DYNAMIC_MACRO_EEPROM_SIZE
+#else
+#    define DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE 0
+#endif
+
 // Dynamic macros are stored after the keymaps and use what is available
 // up to and including DYNAMIC_KEYMAP_EEPROM_MAX_ADDR.
 #ifndef DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE
-#    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
+#    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1 - DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE)
+#endif
+
+#define DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_ADDR (DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE)
+
+// The recorded macro size may depend on sizeof(keyrecord_t), so it cannot be checked by the preprocessor
+_Static_assert(DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE <= DYNAMIC_KEYMAP_EEPROM_MAX_ADDR + 1 - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR && DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE + DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE <= DYNAMIC_KEYMAP_EEPROM_MAX_ADDR + 1, "Recorded dynamic macros do not fit in the available EEPROM, reduce DYNAMIC_MACRO_ARENA_SIZE");
+
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+// RAM mirror of the keymaps stored in EEPROM, so that keycode lookups
+// (done for every active layer on every key event) never touch the EEPROM
+// backend. Loaded lazily on first use and kept coherent by writing through
+// every keymap update.
+static uint16_t dynamic_keymap_cache[DYNAMIC_KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+static bool     dynamic_keymap_cache_loaded = false;
 #endif
 
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
@@ -88,7 +109,7 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
     return ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + (layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2);
 }
 
-uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+static uint16_t dynamic_keymap_read_keycode(uint8_t layer, uint8_t row, uint8_t column) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
@@ -96,11 +117,47 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
     return keycode;
 }
 
+void dynamic_keymap_cache_load(void) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                dynamic_keymap_cache[layer][row][column] = dynamic_keymap_read_keycode(layer, row, column);
+            }
+        }
+    }
+    dynamic_keymap_cache_loaded = true;
+#endif
+}
+
+uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    // Raw HID requests are not range checked, so guard the RAM array
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    if (!dynamic_keymap_cache_loaded) {
+        dynamic_keymap_cache_load();
+    }
+    return dynamic_keymap_cache[layer][row][column];
+#else
+    return dynamic_keymap_read_keycode(layer, row, column);
+#endif
+}
+
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     eeprom_update_byte(address, (uint8_t)(keycode >> 8));
     eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE_ENABLE)
+    layer_resolve_cache_clear();
+#endif
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    if (layer < DYNAMIC_KEYMAP_LAYER_COUNT && row < MATRIX_ROWS && column < MATRIX_COLS) {
+        dynamic_keymap_cache[layer][row][column] = keycode;
+    }
+#endif
 }
 
 void dynamic_keymap_reset(void) {
@@ -118,7 +175,7 @@ void dynamic_keymap_reset(void) {
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+    void *   source                     = (void *)(uintptr_t)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
     uint8_t *target                     = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
@@ -133,15 +190,28 @@ void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
+    if (offset >= dynamic_keymap_eeprom_size) {
+        return;
+    }
+    if (size > dynamic_keymap_eeprom_size - offset) {
+        size = dynamic_keymap_eeprom_size - offset;
+    }
+    // One block update, so EEPROM drivers that batch writes see the whole range at once
+    eeprom_update_block(data, (void *)(uintptr_t)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), size);
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
     for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
+        // Keycodes are stored big endian, so even offsets hold the high byte
+        uint16_t *keycode = &((uint16_t *)dynamic_keymap_cache)[(offset + i) >> 1];
+        if ((offset + i) & 1) {
+            *keycode = (*keycode & 0xFF00) | data[i];
+        } else {
+            *keycode = (*keycode & 0x00FF) | (data[i] << 8);
         }
-        source++;
-        target++;
     }
+#endif
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE_ENABLE)
+    layer_resolve_cache_clear();
+#endif
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -158,7 +228,7 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
+    void *   source = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *target = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
@@ -172,7 +242,7 @@ void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
+    void *   target = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *source = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
@@ -185,13 +255,43 @@ void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *da
 
 void dynamic_keymap_macro_reset(void) {
     void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    void *end = (void *)(DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE);
     while (p != end) {
         eeprom_update_byte(p, 0);
         ++p;
     }
 }
 
+#if defined(DYNAMIC_MACRO_ENABLE) && defined(DYNAMIC_MACRO_EEPROM_ENABLE)
+uint16_t dynamic_keymap_recorded_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE; }
+
+void dynamic_keymap_recorded_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    void *   source = (void *)(uintptr_t)(DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_ADDR + offset);
+    uint8_t *target = data;
+    for (uint16_t i = 0; i < size; i++) {
+        if (offset + i < DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE) {
+            *target = eeprom_read_byte(source);
+        } else {
+            *target = 0x00;
+        }
+        source++;
+        target++;
+    }
+}
+
+void dynamic_keymap_recorded_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    void *   target = (void *)(uintptr_t)(DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_ADDR + offset);
+    uint8_t *source = data;
+    for (uint16_t i = 0; i < size; i++) {
+        if (offset + i < DYNAMIC_KEYMAP_RECORDED_MACRO_EEPROM_SIZE) {
+            eeprom_update_byte(target, *source);
+        }
+        source++;
+        target++;
+    }
+}
+#endif
+
 void dynamic_keymap_macro_send(uint8_t id) {
     if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
         return;
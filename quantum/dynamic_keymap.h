@@ -23,6 +23,9 @@ void *   dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column);
 void     dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode);
 void     dynamic_keymap_reset(void);
+// Reloads the RAM keymap cache from EEPROM when DYNAMIC_KEYMAP_CACHE_ENABLE
+// is defined, otherwise does nothing.
+void dynamic_keymap_cache_load(void);
 // These get/set the keycodes as stored in the EEPROM buffer
 // Data is big-endian 16-bit values (the keycodes)
 // Order is by layer/row/column
@@ -58,3 +61,11 @@ void     dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t
 void     dynamic_keymap_macro_reset(void);
 
 void dynamic_keymap_macro_send(uint8_t id);
+
+#if defined(DYNAMIC_MACRO_ENABLE) && defined(DYNAMIC_MACRO_EEPROM_ENABLE)
+// The macros recorded with the DYN_REC_START keycodes are saved after the
+// macro buffer above, which is DYNAMIC_MACRO_EEPROM_SIZE bytes smaller by default.
+uint16_t dynamic_keymap_recorded_macro_get_buffer_size(void);
+void     dynamic_keymap_recorded_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data);
+void     dynamic_keymap_recorded_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data);
+#endif
@@ -0,0 +1,158 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+extern "C" {
+#include "config.h"
+#include "quantum.h"
+#include "dynamic_keymap.h"
+
+// clang-format off
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J}},
+    [1] = {{KC_TRNS, KC_1, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS}},
+    [2] = {{KC_TRNS, KC_TRNS, KC_2, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS}},
+    [3] = {{KC_TRNS, KC_TRNS, KC_TRNS, KC_3, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS}},
+};
+// clang-format on
+
+/* Counting EEPROM backend, large enough for the dynamic keymap region */
+static uint8_t  eeprom_buffer[DYNAMIC_KEYMAP_EEPROM_MAX_ADDR + 1];
+static uint32_t eeprom_reads  = 0;
+static uint32_t eeprom_writes = 0;
+static uint32_t eeprom_blocks = 0;
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+    eeprom_reads++;
+    return eeprom_buffer[(uintptr_t)addr];
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) {
+    eeprom_writes++;
+    eeprom_buffer[(uintptr_t)addr] = value;
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n) {
+    eeprom_blocks++;
+    memcpy(&eeprom_buffer[(uintptr_t)dst], src, n);
+}
+
+void send_string(const char *str) {}
+}
+
+class DynamicKeymapTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(eeprom_buffer, 0, sizeof(eeprom_buffer));
+        dynamic_keymap_reset();
+        dynamic_keymap_cache_load();
+        eeprom_reads   = 0;
+        eeprom_writes  = 0;
+        eeprom_blocks  = 0;
+        keymap_lookups = 0;
+    }
+
+    /* Mirrors layer_switch_get_layer(): walk the active layers from the top
+     * and resolve a keycode on each one until a non-transparent key is found. */
+    uint16_t resolve(layer_state_t state, uint8_t row, uint8_t col) {
+        keypos_t key = {.col = col, .row = row};
+        for (int8_t layer = DYNAMIC_KEYMAP_LAYER_COUNT - 1; layer >= 0; layer--) {
+            if (state & ((layer_state_t)1 << layer)) {
+                keymap_lookups++;
+                uint16_t keycode = keymap_key_to_keycode(layer, key);
+                if (keycode != KC_TRNS) {
+                    return keycode;
+                }
+            }
+        }
+        return KC_NO;
+    }
+
+    uint32_t keymap_lookups;
+};
+
+TEST_F(DynamicKeymapTest, LookupsPerKeyEventAndEepromTraffic) {
+    const layer_state_t all_layers = 0x0F;
+
+    EXPECT_EQ(resolve(all_layers, 0, 0), KC_A);
+    EXPECT_EQ(resolve(all_layers, 0, 1), KC_1);
+    EXPECT_EQ(resolve(all_layers, 0, 2), KC_2);
+    EXPECT_EQ(resolve(all_layers, 0, 3), KC_3);
+
+    /* The number of keymap lookups is a property of the layer walk, not of the storage */
+    EXPECT_EQ(keymap_lookups, 4 + 3 + 2 + 1);
+#ifdef DYNAMIC_KEYMAP_CACHE_ENABLE
+    EXPECT_EQ(eeprom_reads, 0);
+#else
+    EXPECT_EQ(eeprom_reads, 2 * keymap_lookups);
+#endif
+}
+
+TEST_F(DynamicKeymapTest, SetKeycodeWritesThrough) {
+    dynamic_keymap_set_keycode(2, 0, 5, KC_Z);
+    EXPECT_EQ(eeprom_writes, 2);
+    EXPECT_EQ(dynamic_keymap_get_keycode(2, 0, 5), KC_Z);
+    EXPECT_EQ(resolve(0x07, 0, 5), KC_Z);
+    EXPECT_EQ(resolve(0x03, 0, 5), KC_F);
+
+    /* The EEPROM copy must be identical to what the cache serves */
+    uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(2, 0, 5);
+    EXPECT_EQ((eeprom_buffer[(uintptr_t)address] << 8) | eeprom_buffer[(uintptr_t)address + 1], KC_Z);
+}
+
+TEST_F(DynamicKeymapTest, SetBufferWritesThrough) {
+    /* Unaligned write spanning the low byte of (0,0,0) and the whole of (0,0,1) */
+    uint8_t data[] = {0x05, 0x00, 0x1D};
+    dynamic_keymap_set_buffer(1, sizeof(data), data);
+    EXPECT_EQ(eeprom_blocks, 1);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), 0x0005);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 1), 0x001D);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 2), KC_C);
+
+    uint8_t readback[4];
+    dynamic_keymap_get_buffer(0, sizeof(readback), readback);
+    EXPECT_EQ(readback[0], 0x00);
+    EXPECT_EQ(readback[1], 0x05);
+    EXPECT_EQ(readback[2], 0x00);
+    EXPECT_EQ(readback[3], 0x1D);
+}
+
+TEST_F(DynamicKeymapTest, SetBufferStopsAtEndOfKeymap) {
+    const uint16_t size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+    uint8_t        data[] = {0x00, KC_X, 0xAA, 0xBB};
+    uint8_t        after  = eeprom_buffer[(uintptr_t)dynamic_keymap_key_to_eeprom_address(0, 0, 0) + size];
+
+    dynamic_keymap_set_buffer(size - 2, sizeof(data), data);
+    EXPECT_EQ(dynamic_keymap_get_keycode(DYNAMIC_KEYMAP_LAYER_COUNT - 1, MATRIX_ROWS - 1, MATRIX_COLS - 1), KC_X);
+    EXPECT_EQ(eeprom_buffer[(uintptr_t)dynamic_keymap_key_to_eeprom_address(0, 0, 0) + size], after);
+
+    dynamic_keymap_set_buffer(size, sizeof(data), data);
+    EXPECT_EQ(eeprom_blocks, 1);
+}
+
+TEST_F(DynamicKeymapTest, CacheReloadMatchesEeprom) {
+    /* Host tools may write the EEPROM directly; a reload must pick it up */
+    uint8_t *address   = (uint8_t *)dynamic_keymap_key_to_eeprom_address(3, 1, 7);
+    eeprom_buffer[(uintptr_t)address]     = 0x00;
+    eeprom_buffer[(uintptr_t)address + 1] = KC_Q;
+    dynamic_keymap_cache_load();
+    EXPECT_EQ(dynamic_keymap_get_keycode(3, 1, 7), KC_Q);
+}
+
+TEST_F(DynamicKeymapTest, OutOfRangeLookupIsSafe) { EXPECT_EQ(keymap_key_to_keycode(DYNAMIC_KEYMAP_LAYER_COUNT, (keypos_t){.col = 0, .row = 0}), KC_NO); }
@@ -0,0 +1,19 @@
+DYNAMIC_KEYMAP_COMMON_INC := $(QUANTUM_PATH)/dynamic_keymap/tests
+
+DYNAMIC_KEYMAP_COMMON_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/dynamic_keymap_tests.cpp \
+	$(QUANTUM_PATH)/dynamic_keymap.c
+
+dynamic_keymap_INC := $(DYNAMIC_KEYMAP_COMMON_INC)
+dynamic_keymap_SRC := $(DYNAMIC_KEYMAP_COMMON_SRC)
+
+dynamic_keymap_cache_DEFS := -DDYNAMIC_KEYMAP_CACHE_ENABLE
+dynamic_keymap_cache_INC := $(DYNAMIC_KEYMAP_COMMON_INC)
+dynamic_keymap_cache_SRC := $(DYNAMIC_KEYMAP_COMMON_SRC)
+
+via_bulk_DEFS := -include $(QUANTUM_PATH)/dynamic_keymap/tests/config.h
+via_bulk_INC := $(DYNAMIC_KEYMAP_COMMON_INC)
+via_bulk_SRC := \
+	$(QUANTUM_PATH)/dynamic_keymap/tests/via_bulk_tests.cpp \
+	$(QUANTUM_PATH)/via_bulk.c \
+	$(QUANTUM_PATH)/crc.c
@@ -0,0 +1,4 @@
+TEST_LIST += \
+	dynamic_keymap \
+	dynamic_keymap_cache \
+	via_bulk
@@ -0,0 +1,160 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+extern "C" {
+#include "config.h"
+#include "crc.h"
+#include "via_bulk.h"
+
+/* Records the commits instead of writing a keymap */
+static uint8_t  keymap[DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2];
+static uint32_t set_buffer_calls   = 0;
+static uint16_t largest_set_buffer = 0;
+
+void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    set_buffer_calls++;
+    if (size > largest_set_buffer) largest_set_buffer = size;
+    memcpy(&keymap[offset], data, size);
+}
+}
+
+#define KEYMAP_SIZE sizeof(keymap)
+
+class ViaBulkTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(keymap, 0, sizeof(keymap));
+        set_buffer_calls   = 0;
+        largest_set_buffer = 0;
+        for (uint16_t i = 0; i < sizeof(upload); i++) {
+            upload[i] = i * 7 + 3;
+        }
+    }
+
+    uint8_t begin(uint16_t offset, uint16_t size) {
+        uint8_t data[31] = {(uint8_t)(offset >> 8), (uint8_t)offset, (uint8_t)(size >> 8), (uint8_t)size};
+        via_bulk_begin(data);
+        window = data[1];
+        EXPECT_EQ(data[2], VIA_BULK_PAYLOAD_SIZE);
+        EXPECT_EQ((data[3] << 8) | data[4], VIA_BULK_BUFFER_SIZE);
+        return data[0];
+    }
+
+    /* Sends report `sequence` of `upload` from `upload_base`, returns the status and the next expected sequence */
+    uint8_t send(uint8_t sequence, uint8_t *next = NULL) {
+        uint8_t data[31] = {sequence};
+        memcpy(&data[1], &upload[upload_base + sequence * VIA_BULK_PAYLOAD_SIZE], VIA_BULK_PAYLOAD_SIZE);
+        via_bulk_data(data);
+        if (next) *next = data[1];
+        return data[0];
+    }
+
+    uint8_t commit(uint8_t crc) {
+        uint8_t data[31] = {crc};
+        via_bulk_commit(data);
+        return data[0];
+    }
+
+    uint8_t reports(uint16_t size) { return (size + VIA_BULK_PAYLOAD_SIZE - 1) / VIA_BULK_PAYLOAD_SIZE; }
+
+    /* Padded so the last report can always be filled */
+    uint8_t  upload[KEYMAP_SIZE + VIA_BULK_PAYLOAD_SIZE];
+    uint16_t upload_base = 0;
+    uint8_t  window;
+};
+
+TEST_F(ViaBulkTest, LargestTransferInBoundedWrites) {
+    ASSERT_EQ(begin(0, VIA_BULK_BUFFER_SIZE), VIA_BULK_OK);
+    EXPECT_EQ(window, VIA_BULK_WINDOW);
+    for (uint8_t sequence = 0; sequence < reports(VIA_BULK_BUFFER_SIZE); sequence++) {
+        uint8_t next;
+        EXPECT_EQ(send(sequence, &next), VIA_BULK_OK);
+        EXPECT_EQ(next, sequence + 1);
+    }
+    EXPECT_EQ(set_buffer_calls, 0);
+
+    EXPECT_EQ(commit(crc8(upload, VIA_BULK_BUFFER_SIZE)), VIA_BULK_OK);
+    EXPECT_EQ(set_buffer_calls, (VIA_BULK_BUFFER_SIZE + VIA_BULK_COMMIT_CHUNK_SIZE - 1) / VIA_BULK_COMMIT_CHUNK_SIZE);
+    EXPECT_LE(largest_set_buffer, VIA_BULK_COMMIT_CHUNK_SIZE);
+    EXPECT_EQ(memcmp(keymap, upload, VIA_BULK_BUFFER_SIZE), 0);
+}
+
+TEST_F(ViaBulkTest, WholeKeymapInSeveralTransfers) {
+    /* 320 bytes of keymap, more than the default staging buffer */
+    EXPECT_EQ(begin(0, KEYMAP_SIZE), VIA_BULK_ERROR_RANGE);
+    for (uint16_t start = 0; start < KEYMAP_SIZE; start += VIA_BULK_BUFFER_SIZE) {
+        uint16_t size = KEYMAP_SIZE - start < VIA_BULK_BUFFER_SIZE ? KEYMAP_SIZE - start : VIA_BULK_BUFFER_SIZE;
+        upload_base = start;
+        ASSERT_EQ(begin(start, size), VIA_BULK_OK);
+        for (uint8_t sequence = 0; sequence < reports(size); sequence++) {
+            EXPECT_EQ(send(sequence), VIA_BULK_OK);
+        }
+        EXPECT_EQ(commit(crc8(&upload[start], size)), VIA_BULK_OK);
+    }
+    EXPECT_EQ(memcmp(keymap, upload, KEYMAP_SIZE), 0);
+}
+
+TEST_F(ViaBulkTest, PartialUploadAtOffset) {
+    ASSERT_EQ(begin(40, 45), VIA_BULK_OK);
+    EXPECT_EQ(send(0), VIA_BULK_OK);
+    EXPECT_EQ(send(1), VIA_BULK_OK);
+    EXPECT_EQ(send(2), VIA_BULK_ERROR_RANGE);
+    EXPECT_EQ(commit(crc8(upload, 45)), VIA_BULK_OK);
+    EXPECT_EQ(memcmp(&keymap[40], upload, 45), 0);
+    EXPECT_EQ(keymap[39], 0);
+    EXPECT_EQ(keymap[85], 0);
+}
+
+TEST_F(ViaBulkTest, RejectsTransfersOutsideTheKeymap) {
+    EXPECT_EQ(begin(0, 0), VIA_BULK_ERROR_RANGE);
+    EXPECT_EQ(begin(0, KEYMAP_SIZE + 1), VIA_BULK_ERROR_RANGE);
+    EXPECT_EQ(begin(KEYMAP_SIZE - 1, 2), VIA_BULK_ERROR_RANGE);
+    EXPECT_EQ(send(0), VIA_BULK_ERROR_STATE);
+    EXPECT_EQ(commit(0), VIA_BULK_ERROR_STATE);
+}
+
+TEST_F(ViaBulkTest, LostReportIsResentFromExpectedSequence) {
+    ASSERT_EQ(begin(0, 4 * VIA_BULK_PAYLOAD_SIZE), VIA_BULK_OK);
+    uint8_t next;
+    EXPECT_EQ(send(0), VIA_BULK_OK);
+    /* Report 1 is lost, the rest of the window is refused */
+    EXPECT_EQ(send(2, &next), VIA_BULK_ERROR_SEQUENCE);
+    EXPECT_EQ(next, 1);
+    EXPECT_EQ(send(3, &next), VIA_BULK_ERROR_SEQUENCE);
+    EXPECT_EQ(next, 1);
+
+    for (uint8_t sequence = next; sequence < 4; sequence++) {
+        EXPECT_EQ(send(sequence), VIA_BULK_OK);
+    }
+    EXPECT_EQ(commit(crc8(upload, 4 * VIA_BULK_PAYLOAD_SIZE)), VIA_BULK_OK);
+    EXPECT_EQ(memcmp(keymap, upload, 4 * VIA_BULK_PAYLOAD_SIZE), 0);
+}
+
+TEST_F(ViaBulkTest, ResentReportsAreIgnored) {
+    ASSERT_EQ(begin(0, 3 * VIA_BULK_PAYLOAD_SIZE), VIA_BULK_OK);
+    uint8_t next;
+    EXPECT_EQ(send(0), VIA_BULK_OK);
+    EXPECT_EQ(send(1), VIA_BULK_OK);
+    upload[0] ^= 0xFF;
+    EXPECT_EQ(send(0, &next), VIA_BULK_OK);
+    EXPECT_EQ(next, 2);
+    upload[0] ^= 0xFF;
+    EXPECT_EQ(send(2), VIA_BULK_OK);
+    EXPECT_EQ(commit(crc8(upload, 3 * VIA_BULK_PAYLOAD_SIZE)), VIA_BULK_OK);
+}
+
+TEST_F(ViaBulkTest, CrcMismatchWritesNothing) {
+    ASSERT_EQ(begin(0, 2 * VIA_BULK_PAYLOAD_SIZE), VIA_BULK_OK);
+    EXPECT_EQ(send(0), VIA_BULK_OK);
+    EXPECT_EQ(commit(crc8(upload, 2 * VIA_BULK_PAYLOAD_SIZE)), VIA_BULK_ERROR_INCOMPLETE);
+    EXPECT_EQ(send(1), VIA_BULK_OK);
+
+    EXPECT_EQ(commit(crc8(upload, 2 * VIA_BULK_PAYLOAD_SIZE) ^ 1), VIA_BULK_ERROR_CRC);
+    EXPECT_EQ(set_buffer_calls, 0);
+    /* The transfer is dropped and has to be started over */
+    EXPECT_EQ(commit(crc8(upload, 2 * VIA_BULK_PAYLOAD_SIZE)), VIA_BULK_ERROR_STATE);
+}
@@ -31,6 +31,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "latency_trace.h"
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -100,6 +104,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef SLEEP_LED_ENABLE
 #    include "sleep_led.h"
 #endif
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+#    include "transport_stats.h"
+#endif
+#ifdef DYNAMIC_MACRO_ENABLE
+#    include "process_dynamic_macro.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) { return last_input_modification_time; }
@@ -115,6 +125,54 @@ uint32_t        last_encoder_activity_time(void) { return last_encoder_modificat
 uint32_t        last_encoder_activity_elapsed(void) { return timer_elapsed32(last_encoder_modification_time); }
 void            last_encoder_activity_trigger(void) { last_encoder_modification_time = last_input_modification_time = timer_read32(); }
 
+// Key events found by matrix diffing wait here until action_exec() consumes them.
+// All events detected during one scan share that scan's timestamp.
+#ifndef KEYEVENT_QUEUE_SIZE
+#    define KEYEVENT_QUEUE_SIZE 16
+#endif
+
+static keyevent_t keyevent_queue[KEYEVENT_QUEUE_SIZE];
+static uint8_t    keyevent_queue_head        = 0;
+static uint8_t    keyevent_queue_count       = 0;
+static uint8_t    keyevent_queue_max_depth   = 0;
+static uint16_t   keyevent_queue_max_latency = 0;
+
+static inline bool keyevent_queue_full(void) { return keyevent_queue_count >= KEYEVENT_QUEUE_SIZE; }
+
+// Key events wait while a dynamic macro plays back, as the macro replaces the
+// layer state they would change and restores it once done.
+static inline bool keyevent_queue_held(void) {
+#ifdef DYNAMIC_MACRO_ENABLE
+    return dynamic_macro_is_playing();
+#else
+    return false;
+#endif
+}
+
+static void keyevent_queue_push(keyevent_t event) {
+    keyevent_queue[(keyevent_queue_head + keyevent_queue_count) % KEYEVENT_QUEUE_SIZE] = event;
+    keyevent_queue_count++;
+    if (keyevent_queue_count > keyevent_queue_max_depth) {
+        keyevent_queue_max_depth = keyevent_queue_count;
+    }
+}
+
+static keyevent_t keyevent_queue_pop(void) {
+    keyevent_t event    = keyevent_queue[keyevent_queue_head];
+    keyevent_queue_head = (keyevent_queue_head + 1) % KEYEVENT_QUEUE_SIZE;
+    keyevent_queue_count--;
+
+    uint16_t latency = TIMER_DIFF_16(timer_read() | 1, event.time);
+    if (latency > keyevent_queue_max_latency) {
+        keyevent_queue_max_latency = latency;
+    }
+    return event;
+}
+
+uint8_t  keyevent_queue_get_max_depth(void) { return keyevent_queue_max_depth; }
+uint16_t keyevent_queue_get_max_latency(void) { return keyevent_queue_max_latency; }
+void     keyevent_queue_clear_stats(void) { keyevent_queue_max_depth = keyevent_queue_max_latency = 0; }
+
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE)
 static uint32_t matrix_timer           = 0;
@@ -128,7 +186,9 @@ void matrix_scan_perf_task(void) {
     if (TIMER_DIFF_32(timer_now, matrix_timer) > 1000) {
 #    if defined(CONSOLE_ENABLE)
         dprintf("matrix scan frequency: %lu\n", matrix_scan_count);
+        dprintf("keyevent queue max depth: %u, max latency: %ums\n", keyevent_queue_max_depth, keyevent_queue_max_latency);
 #    endif
+        keyevent_queue_clear_stats();
         last_matrix_scan_count = matrix_scan_count;
         matrix_timer           = timer_now;
         matrix_scan_count      = 0;
@@ -341,6 +401,9 @@ void keyboard_init(void) {
 #ifdef VIRTSER_ENABLE
     virtser_init();
 #endif
+#ifdef DYNAMIC_MACRO_ENABLE
+    dynamic_macro_init();
+#endif
 
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
     debug_enable = true;
@@ -376,12 +439,10 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
  */
 void keyboard_task(void) {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
-    uint8_t keys_processed = 0;
-#endif
+    static uint8_t      led_status     = 0;
+    matrix_row_t        matrix_row     = 0;
+    matrix_row_t        matrix_change  = 0;
+    uint8_t             keys_processed = 0;
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
@@ -389,7 +450,10 @@ void keyboard_task(void) {
     uint8_t matrix_changed = matrix_scan();
     if (matrix_changed) last_matrix_activity_trigger();
 
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+    // Queue every changed key, in matrix order, with a single timestamp for this scan.
+    // Keys that do not fit are left in matrix_prev and picked up on the next scan.
+    uint16_t scan_time = timer_read() | 1; /* time should not be 0 */
+    for (uint8_t r = 0; r < MATRIX_ROWS && !keyevent_queue_full(); r++) {
         matrix_row    = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
@@ -400,41 +464,49 @@ void keyboard_task(void) {
 #endif
             if (debug_matrix) matrix_print();
             matrix_row_t col_mask = 1;
-            for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
+            for (uint8_t c = 0; c < MATRIX_COLS && !keyevent_queue_full(); c++, col_mask <<= 1) {
                 if (matrix_change & col_mask) {
                     if (should_process_keypress()) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
+                        latency_trace_mark(LATENCY_STAGE_DEBOUNCE);
+                        keyevent_queue_push((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = scan_time});
                     }
                     // record a processed key
                     matrix_prev[r] ^= col_mask;
 
                     switch_events(r, c, (matrix_row & col_mask));
-
-#ifdef QMK_KEYS_PER_SCAN
-                    // only jump out if we have processed "enough" keys.
-                    if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
-                        // process a key per task call
-                        goto MATRIX_LOOP_END;
                 }
             }
         }
     }
-    // call with pseudo tick event when no real key event.
+
+    // Drain the queue in order, all of it unless limited by QMK_KEYS_PER_SCAN.
+    while (keyevent_queue_count && !keyevent_queue_held()) {
 #ifdef QMK_KEYS_PER_SCAN
-    // we can get here with some keys processed now.
-    if (!keys_processed)
+        if (keys_processed >= QMK_KEYS_PER_SCAN) break;
 #endif
-        action_exec(TICK);
+        action_exec(keyevent_queue_pop());
+        keys_processed++;
+    }
 
-MATRIX_LOOP_END:
+    // call with pseudo tick event when no real key event.
+    if (!keys_processed) {
+        action_exec(TICK);
+    }
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_task();
+#endif
+
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+    if (is_keyboard_master()) {
+        split_transport_stats_task();
+    }
+#endif
+
 #if defined(RGBLIGHT_ENABLE)
     rgblight_task();
 #endif
@@ -516,6 +588,10 @@ MATRIX_LOOP_END:
     programmable_button_send();
 #endif
 
+#ifdef EEPROM_DRIVER
+    eeprom_driver_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
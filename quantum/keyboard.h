@@ -85,6 +85,10 @@ uint32_t last_encoder_activity_elapsed(void);  // Number of milliseconds since t
 
 uint32_t get_matrix_scan_rate(void);
 
+uint8_t  keyevent_queue_get_max_depth(void);    // Largest number of key events queued at once since the stats were cleared
+uint16_t keyevent_queue_get_max_latency(void);  // Longest time in milliseconds between detecting and processing a key event
+void     keyevent_queue_clear_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
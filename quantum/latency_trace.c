@@ -0,0 +1,151 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "latency_trace.h"
+#include "timer.h"
+#include "debug.h"
+#include "print.h"
+
+#ifndef LATENCY_TRACE_SAMPLES
+#    define LATENCY_TRACE_SAMPLES 32
+#endif
+
+#ifndef LATENCY_TRACE_PRINT_INTERVAL
+#    define LATENCY_TRACE_PRINT_INTERVAL 10000
+#endif
+
+#if LATENCY_TRACE_SAMPLES > 255
+#    error LATENCY_TRACE_SAMPLES must be less than 256
+#endif
+
+typedef struct {
+    uint16_t samples[LATENCY_TRACE_SAMPLES];
+    uint8_t  head;
+    uint8_t  count;
+} latency_ring_t;
+
+static latency_ring_t rings[LATENCY_STAGE_COUNT];
+
+static bool     trace_active  = false;
+static uint8_t  trace_reached = 0;  // bitmask of stages hit by the current trace
+static uint8_t  trace_last    = 0;  // furthest stage hit by the current trace
+static uint32_t trace_start   = 0;
+static uint16_t trace_offsets[LATENCY_STAGE_COUNT];
+
+__attribute__((weak)) uint32_t latency_trace_timestamp(void) { return timer_read32(); }
+
+static void latency_ring_push(latency_ring_t *ring, uint16_t sample) {
+    ring->samples[ring->head] = sample;
+    ring->head                = (ring->head + 1) % LATENCY_TRACE_SAMPLES;
+    if (ring->count < LATENCY_TRACE_SAMPLES) {
+        ring->count++;
+    }
+}
+
+static void latency_trace_complete(void) {
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        if (trace_reached & (1 << stage)) {
+            latency_ring_push(&rings[stage], trace_offsets[stage]);
+        }
+    }
+    trace_active = false;
+}
+
+void latency_trace_mark(latency_stage_t stage) {
+    if (stage >= LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    uint32_t now = latency_trace_timestamp();
+
+    // A key change starts a new trace, unless it is a further step of the
+    // trace in progress (e.g. debounce after the raw change, or switch bounce).
+    if (stage <= LATENCY_STAGE_DEBOUNCE && (!trace_active || trace_last > stage)) {
+        trace_active  = true;
+        trace_reached = 0;
+        trace_last    = stage;
+        trace_start   = now;
+    }
+
+    if (!trace_active || (trace_reached & (1 << stage))) {
+        return;
+    }
+
+    uint32_t elapsed     = now - trace_start;
+    trace_offsets[stage] = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+    trace_reached |= (1 << stage);
+    if (stage > trace_last) {
+        trace_last = stage;
+    }
+
+    if (stage == LATENCY_STAGE_USB_SUBMIT) {
+        latency_trace_complete();
+    }
+}
+
+bool latency_trace_get_stats(latency_stage_t stage, latency_stats_t *stats) {
+    memset(stats, 0, sizeof(latency_stats_t));
+    if (stage >= LATENCY_STAGE_COUNT || rings[stage].count == 0) {
+        return false;
+    }
+
+    const latency_ring_t *ring = &rings[stage];
+    uint16_t              sorted[LATENCY_TRACE_SAMPLES];
+    uint32_t              sum = 0;
+
+    // Insertion sort, the ring is small
+    for (uint8_t i = 0; i < ring->count; i++) {
+        uint16_t sample = ring->samples[i];
+        uint8_t  j      = i;
+        while (j > 0 && sorted[j - 1] > sample) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = sample;
+        sum += sample;
+    }
+
+    stats->count = ring->count;
+    stats->min   = sorted[0];
+    stats->max   = sorted[ring->count - 1];
+    stats->avg   = sum / ring->count;
+    // Nearest-rank percentile
+    stats->p99 = sorted[(ring->count * 99 + 99) / 100 - 1];
+    return true;
+}
+
+void latency_trace_get_stats_raw(latency_stage_t stage, uint8_t *data) {
+    latency_stats_t stats;
+    latency_trace_get_stats(stage, &stats);
+    const uint16_t values[] = {stats.count, stats.min, stats.avg, stats.max, stats.p99};
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        *data++ = values[i] >> 8;
+        *data++ = values[i] & 0xFF;
+    }
+}
+
+void latency_trace_reset(void) {
+    memset(rings, 0, sizeof(rings));
+    trace_active = false;
+}
+
+void latency_trace_print(void) {
+#if !defined(NO_DEBUG) && !defined(NO_PRINT)
+    static const char *const stage_names[LATENCY_STAGE_COUNT] = {"matrix", "debounce", "action", "host", "usb"};
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        latency_stats_t stats;
+        if (latency_trace_get_stats(stage, &stats)) {
+            dprintf("latency %s: n=%u min=%u avg=%u max=%u p99=%u\n", stage_names[stage], stats.count, stats.min, stats.avg, stats.max, stats.p99);
+        }
+    }
+#endif
+}
+
+void latency_trace_task(void) {
+    static uint32_t last_print = 0;
+    if (debug_enable && timer_elapsed32(last_print) > LATENCY_TRACE_PRINT_INTERVAL) {
+        last_print = timer_read32();
+        latency_trace_print();
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Points along the path from a physical key change to the USB report.
+typedef enum {
+    LATENCY_STAGE_MATRIX = 0,  // raw change seen by matrix_scan()
+    LATENCY_STAGE_DEBOUNCE,    // debounced change picked up by keyboard_task()
+    LATENCY_STAGE_ACTION,      // key event passed to action_exec()
+    LATENCY_STAGE_HOST_SEND,   // report handed to host_keyboard_send()
+    LATENCY_STAGE_USB_SUBMIT,  // report queued on the USB endpoint
+    LATENCY_STAGE_COUNT,
+} latency_stage_t;
+
+// Latency from the start of a trace to a stage, over the last LATENCY_TRACE_SAMPLES traces.
+// Values are in milliseconds, unless latency_trace_timestamp() is overridden.
+typedef struct {
+    uint16_t count;
+    uint16_t min;
+    uint16_t avg;
+    uint16_t max;
+    uint16_t p99;
+} latency_stats_t;
+
+#ifdef LATENCY_TRACE_ENABLE
+
+// Records that the current key event reached the given stage.
+//  -- A trace starts at LATENCY_STAGE_MATRIX, or at LATENCY_STAGE_DEBOUNCE for matrices that cannot report raw changes.
+//  -- Only the first time a trace reaches a stage is recorded.
+//  -- The trace completes at LATENCY_STAGE_USB_SUBMIT.
+void latency_trace_mark(latency_stage_t stage);
+
+// Fills in the statistics of a stage.
+//  -- Return value: false if the stage is invalid or has no samples yet
+bool latency_trace_get_stats(latency_stage_t stage, latency_stats_t *stats);
+
+// Forgets all samples and any trace in progress.
+void latency_trace_reset(void);
+
+// Serialises the statistics of a stage for raw HID, as five big endian 16-bit values:
+// count, min, avg, max, p99. All zero if the stage has no samples.
+void latency_trace_get_stats_raw(latency_stage_t stage, uint8_t *data);
+
+// Prints the statistics of every stage to the console.
+void latency_trace_print(void);
+
+// Time source for the tracer, defaults to timer_read32(). Can be overridden for a finer resolution.
+uint32_t latency_trace_timestamp(void);
+
+// Prints the statistics periodically when debugging is enabled. Should not be invoked by keyboard/user code.
+void latency_trace_task(void);
+
+#else
+
+#    define latency_trace_mark(stage)
+#    define latency_trace_reset()
+#    define latency_trace_print()
+#    define latency_trace_task()
+
+#endif
@@ -0,0 +1,156 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "latency_trace.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class LatencyTraceTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(1000);
+        latency_trace_reset();
+    }
+
+    /* One key event through the whole pipeline, with the given delays between stages */
+    void trace(uint32_t debounce, uint32_t action, uint32_t host, uint32_t usb) {
+        latency_trace_mark(LATENCY_STAGE_MATRIX);
+        advance_time(debounce);
+        latency_trace_mark(LATENCY_STAGE_DEBOUNCE);
+        advance_time(action);
+        latency_trace_mark(LATENCY_STAGE_ACTION);
+        advance_time(host);
+        latency_trace_mark(LATENCY_STAGE_HOST_SEND);
+        advance_time(usb);
+        latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
+        advance_time(100);
+    }
+};
+
+TEST_F(LatencyTraceTest, NoSamples) {
+    latency_stats_t stats;
+    EXPECT_FALSE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.count, 0);
+}
+
+TEST_F(LatencyTraceTest, SingleTrace) {
+    trace(5, 0, 1, 2);
+
+    latency_stats_t stats;
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_MATRIX, &stats));
+    EXPECT_EQ(stats.max, 0);
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_DEBOUNCE, &stats));
+    EXPECT_EQ(stats.max, 5);
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_ACTION, &stats));
+    EXPECT_EQ(stats.max, 5);
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_HOST_SEND, &stats));
+    EXPECT_EQ(stats.max, 6);
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_EQ(stats.min, 8);
+    EXPECT_EQ(stats.avg, 8);
+    EXPECT_EQ(stats.max, 8);
+    EXPECT_EQ(stats.p99, 8);
+}
+
+TEST_F(LatencyTraceTest, Percentiles) {
+    /* 99 fast events and one slow one */
+    for (int i = 0; i < 99; i++) {
+        trace(5, 0, 0, 1);
+    }
+    trace(5, 0, 0, 95);
+
+    latency_stats_t stats;
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.count, 100);
+    EXPECT_EQ(stats.min, 6);
+    EXPECT_EQ(stats.avg, 6);
+    EXPECT_EQ(stats.p99, 6);
+    EXPECT_EQ(stats.max, 100);
+}
+
+TEST_F(LatencyTraceTest, RingKeepsMostRecentSamples) {
+    trace(5, 0, 0, 50);
+    for (int i = 0; i < 100; i++) {
+        trace(5, 0, 0, 1);
+    }
+
+    latency_stats_t stats;
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.count, 100);
+    EXPECT_EQ(stats.max, 6);
+}
+
+TEST_F(LatencyTraceTest, SwitchBounceKeepsFirstDetection) {
+    latency_trace_mark(LATENCY_STAGE_MATRIX);
+    advance_time(2);
+    latency_trace_mark(LATENCY_STAGE_MATRIX);
+    advance_time(3);
+    latency_trace_mark(LATENCY_STAGE_DEBOUNCE);
+    latency_trace_mark(LATENCY_STAGE_ACTION);
+    latency_trace_mark(LATENCY_STAGE_HOST_SEND);
+    latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
+
+    latency_stats_t stats;
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.max, 5);
+}
+
+TEST_F(LatencyTraceTest, EventWithoutReportIsDiscarded) {
+    /* e.g. a layer key: processed but never reported */
+    latency_trace_mark(LATENCY_STAGE_MATRIX);
+    advance_time(5);
+    latency_trace_mark(LATENCY_STAGE_DEBOUNCE);
+    latency_trace_mark(LATENCY_STAGE_ACTION);
+    advance_time(200);
+
+    trace(5, 0, 0, 1);
+
+    latency_stats_t stats;
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_ACTION, &stats));
+    EXPECT_EQ(stats.count, 1);
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_EQ(stats.max, 6);
+}
+
+TEST_F(LatencyTraceTest, ReportsWithoutKeyEventAreIgnored) {
+    latency_trace_mark(LATENCY_STAGE_HOST_SEND);
+    latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
+
+    latency_stats_t stats;
+    EXPECT_FALSE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+}
+
+TEST_F(LatencyTraceTest, TraceCanStartAtDebounce) {
+    /* Custom matrices that cannot report raw changes */
+    latency_trace_mark(LATENCY_STAGE_DEBOUNCE);
+    advance_time(1);
+    latency_trace_mark(LATENCY_STAGE_ACTION);
+    latency_trace_mark(LATENCY_STAGE_HOST_SEND);
+    advance_time(1);
+    latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
+
+    latency_stats_t stats;
+    EXPECT_FALSE(latency_trace_get_stats(LATENCY_STAGE_MATRIX, &stats));
+    ASSERT_TRUE(latency_trace_get_stats(LATENCY_STAGE_USB_SUBMIT, &stats));
+    EXPECT_EQ(stats.max, 2);
+}
+
+TEST_F(LatencyTraceTest, RawHidSerialisation) {
+    trace(5, 0, 0, 1);
+    trace(5, 0, 0, 3);
+
+    uint8_t data[10];
+    latency_trace_get_stats_raw(LATENCY_STAGE_USB_SUBMIT, data);
+    uint8_t expected[10] = {0, 2, 0, 6, 0, 7, 0, 8, 0, 8};
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(data[i], expected[i]) << "at byte " << i;
+    }
+}
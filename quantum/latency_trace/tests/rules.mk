@@ -0,0 +1,7 @@
+latency_trace_DEFS := -DLATENCY_TRACE_ENABLE -DLATENCY_TRACE_SAMPLES=100
+
+latency_trace_SRC := \
+	$(QUANTUM_PATH)/latency_trace/tests/latency_trace_tests.cpp \
+	$(QUANTUM_PATH)/latency_trace.c \
+	$(QUANTUM_PATH)/logging/debug.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
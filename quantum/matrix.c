@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#include "latency_trace.h"
 #ifdef SPLIT_KEYBOARD
 #    include "split_common/split_util.h"
 #    include "split_common/transactions.h"
@@ -254,6 +255,110 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_SCAN
+#    if !defined(DIRECT_PINS) && !(defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS))
+#        error MATRIX_IDLE_SCAN requires DIRECT_PINS or MATRIX_ROW_PINS and MATRIX_COL_PINS
+#    endif
+
+#    ifndef MATRIX_IDLE_TIMEOUT
+#        define MATRIX_IDLE_TIMEOUT 1000
+#    endif
+
+static bool     matrix_idle = false;
+static uint16_t matrix_idle_timer;
+
+__attribute__((weak)) void matrix_idle_changed_kb(bool idle) { matrix_idle_changed_user(idle); }
+__attribute__((weak)) void matrix_idle_changed_user(bool idle) {}
+
+// Drive every output line at once, so that any switch press shows up on the inputs
+static void matrix_idle_select_all(void) {
+#    if defined(DIRECT_PINS)
+    // switches are wired to ground, nothing to drive
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        select_row(x);
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+#    endif
+}
+
+static void matrix_idle_unselect_all(void) {
+#    if defined(DIRECT_PINS)
+#    elif (DIODE_DIRECTION == COL2ROW)
+    unselect_rows();
+#    elif (DIODE_DIRECTION == ROW2COL)
+    unselect_cols();
+#    endif
+}
+
+static bool matrix_idle_any_input_active(void) {
+#    if defined(DIRECT_PINS)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            pin_t pin = direct_pins[row][col];
+            if (pin != NO_PIN && readPin(pin) == 0) {
+                return true;
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        if (readMatrixPin(col_pins[x]) == 0) {
+            return true;
+        }
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        if (readMatrixPin(row_pins[x]) == 0) {
+            return true;
+        }
+    }
+#    endif
+    return false;
+}
+
+/* While idle, every line stays selected and a scan is a single read of the
+ * inputs. Returns true if nothing was touched and the full scan can be skipped.
+ */
+static bool matrix_idle_skip_scan(void) {
+    if (!matrix_idle) {
+        return false;
+    }
+    if (!matrix_idle_any_input_active()) {
+        return true;
+    }
+
+    matrix_idle_unselect_all();
+    matrix_output_unselect_delay(0, true);
+    matrix_idle       = false;
+    matrix_idle_timer = timer_read();
+    matrix_idle_changed_kb(false);
+    return false;
+}
+
+// Go idle once every key has been released and settled for MATRIX_IDLE_TIMEOUT
+static void matrix_idle_update(matrix_row_t cooked[]) {
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (raw_matrix[row] | cooked[row]) {
+            matrix_idle_timer = timer_read();
+            return;
+        }
+    }
+
+    if (timer_elapsed(matrix_idle_timer) >= MATRIX_IDLE_TIMEOUT) {
+        matrix_idle_select_all();
+        matrix_output_select_delay();
+        matrix_idle = true;
+        matrix_idle_changed_kb(true);
+    }
+}
+
+bool matrix_is_idle(void) { return matrix_idle; }
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     split_pre_init();
@@ -295,6 +400,11 @@ void matrix_init(void) {
 
     debounce_init(ROWS_PER_HAND);
 
+#ifdef MATRIX_IDLE_SCAN
+    matrix_idle       = false;
+    matrix_idle_timer = timer_read();
+#endif
+
     matrix_init_quantum();
 
 #ifdef SPLIT_KEYBOARD
@@ -340,29 +450,51 @@ bool matrix_post_scan(void) {
 #endif
 
 uint8_t matrix_scan(void) {
-    matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
+    bool changed = false;
+
+#ifdef MATRIX_IDLE_SCAN
+    if (!matrix_idle_skip_scan())
+#endif
+    {
+        matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
 
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
-    // Set row, read cols
-    for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
-        matrix_read_cols_on_row(curr_matrix, current_row);
-    }
+        // Set row, read cols
+        for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
+            matrix_read_cols_on_row(curr_matrix, current_row);
+        }
 #elif (DIODE_DIRECTION == ROW2COL)
-    // Set col, read rows
-    matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
-    for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
-        matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
-    }
+        // Set col, read rows
+        matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
+        for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++, row_shifter <<= 1) {
+            matrix_read_rows_on_col(curr_matrix, current_col, row_shifter);
+        }
+#endif
+
+        changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
+        if (changed) {
+            memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+            latency_trace_mark(LATENCY_STAGE_MATRIX);
+        }
+
+#ifdef SPLIT_KEYBOARD
+        matrix_row_t *cooked = matrix + thisHand;
+#else
+        matrix_row_t *cooked = matrix;
 #endif
+        // Nothing to do for the debounce algorithm if the raw matrix is unchanged and no timers are running
+        if (changed || debounce_pending()) {
+            debounce(raw_matrix, cooked, ROWS_PER_HAND, changed);
+        }
 
-    bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
-    if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+#ifdef MATRIX_IDLE_SCAN
+        matrix_idle_update(cooked);
+#endif
+    }
 
 #ifdef SPLIT_KEYBOARD
-    debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
     changed = (changed || matrix_post_scan());
 #else
-    debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
     matrix_scan_quantum();
 #endif
     return (uint8_t)changed;
@@ -74,6 +74,14 @@ void matrix_scan_kb(void);
 void matrix_init_user(void);
 void matrix_scan_user(void);
 
+#ifdef MATRIX_IDLE_SCAN
+/* whether the matrix is idle, with all lines selected waiting for a key press */
+bool matrix_is_idle(void);
+
+void matrix_idle_changed_kb(bool idle);
+void matrix_idle_changed_user(bool idle);
+#endif
+
 #ifdef SPLIT_KEYBOARD
 void matrix_slave_scan_kb(void);
 void matrix_slave_scan_user(void);
@@ -0,0 +1,33 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define MATRIX_ROWS 3
+#define MATRIX_COLS 4
+
+#ifndef DIODE_DIRECTION
+#    define DIODE_DIRECTION COL2ROW
+#endif
+#define MATRIX_ROW_PINS \
+    { 0, 1, 2 }
+#define MATRIX_COL_PINS \
+    { 3, 4, 5, 6 }
+
+#define DEBOUNCE 5
+
+#define MATRIX_IDLE_SCAN
+#define MATRIX_IDLE_TIMEOUT 100
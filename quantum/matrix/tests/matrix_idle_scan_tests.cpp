@@ -0,0 +1,140 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "quantum.h"
+#include "matrix.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+static int idle_changes = 0;
+
+extern "C" {
+void matrix_init_quantum(void) {}
+void matrix_scan_quantum(void) {}
+void matrix_idle_changed_kb(bool idle) { idle_changes++; }
+}
+
+class MatrixIdleScan : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        gpio_mock_reset();
+        set_time(1000);
+        idle_changes = 0;
+        matrix_init();
+    }
+
+    void press(uint8_t row, uint8_t col, bool pressed) { gpio_mock_set_switch(row_pins[row], col_pins[col], pressed); }
+
+    /* Scan once per millisecond */
+    uint8_t scan_for(uint32_t ms) {
+        uint8_t changed = 0;
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            changed |= matrix_scan();
+        }
+        return changed;
+    }
+};
+
+TEST_F(MatrixIdleScan, KeyPressIsScanned) {
+    press(1, 2, true);
+    scan_for(10);
+    EXPECT_EQ(matrix_get_row(0), 0);
+    EXPECT_EQ(matrix_get_row(1), 1 << 2);
+    EXPECT_EQ(matrix_get_row(2), 0);
+    EXPECT_FALSE(matrix_is_idle());
+}
+
+TEST_F(MatrixIdleScan, GoesIdleAfterTimeout) {
+    scan_for(MATRIX_IDLE_TIMEOUT - 2);
+    EXPECT_FALSE(matrix_is_idle());
+    scan_for(2);
+    EXPECT_TRUE(matrix_is_idle());
+    EXPECT_EQ(idle_changes, 1);
+
+#if (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        EXPECT_EQ(gpio_mock_get_mode(row_pins[row]), GPIO_MOCK_OUTPUT);
+    }
+#else
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        EXPECT_EQ(gpio_mock_get_mode(col_pins[col]), GPIO_MOCK_OUTPUT);
+    }
+#endif
+}
+
+TEST_F(MatrixIdleScan, IdleScanReadsEachInputOnce) {
+    gpio_mock_clear_read_count();
+    scan_for(1);
+    uint32_t full_scan_reads = gpio_mock_get_read_count();
+    EXPECT_EQ(full_scan_reads, MATRIX_ROWS * MATRIX_COLS);
+
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    ASSERT_TRUE(matrix_is_idle());
+
+    gpio_mock_clear_read_count();
+    EXPECT_EQ(scan_for(1000), 0);
+#if (DIODE_DIRECTION == COL2ROW)
+    EXPECT_EQ(gpio_mock_get_read_count(), 1000 * MATRIX_COLS);
+#else
+    EXPECT_EQ(gpio_mock_get_read_count(), 1000 * MATRIX_ROWS);
+#endif
+    EXPECT_TRUE(matrix_is_idle());
+}
+
+TEST_F(MatrixIdleScan, KeyPressWakesFromIdle) {
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    ASSERT_TRUE(matrix_is_idle());
+
+    press(2, 3, true);
+    advance_time(1);
+    EXPECT_EQ(matrix_scan(), 1);
+    EXPECT_FALSE(matrix_is_idle());
+    EXPECT_EQ(idle_changes, 2);
+    EXPECT_EQ(matrix_get_row(2), 0);
+
+    scan_for(DEBOUNCE);
+    EXPECT_EQ(matrix_get_row(0), 0);
+    EXPECT_EQ(matrix_get_row(1), 0);
+    EXPECT_EQ(matrix_get_row(2), 1 << 3);
+
+    press(2, 3, false);
+    scan_for(DEBOUNCE + 1);
+    EXPECT_EQ(matrix_get_row(2), 0);
+    EXPECT_FALSE(matrix_is_idle());
+}
+
+TEST_F(MatrixIdleScan, HeldKeyPreventsIdle) {
+    press(0, 0, true);
+    scan_for(MATRIX_IDLE_TIMEOUT * 3);
+    EXPECT_FALSE(matrix_is_idle());
+    EXPECT_EQ(matrix_get_row(0), 1);
+
+    press(0, 0, false);
+    scan_for(DEBOUNCE + 1);
+    EXPECT_FALSE(matrix_is_idle());
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_TRUE(matrix_is_idle());
+}
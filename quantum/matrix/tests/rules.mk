@@ -0,0 +1,20 @@
+MATRIX_IDLE_SCAN_COMMON_DEFS := -DNO_PRINT -DNO_DEBUG -DIGNORE_ATOMIC_BLOCK -include $(QUANTUM_PATH)/matrix/tests/config.h
+
+MATRIX_IDLE_SCAN_COMMON_INC := $(QUANTUM_PATH)/matrix/tests
+
+MATRIX_IDLE_SCAN_COMMON_SRC := \
+	$(QUANTUM_PATH)/matrix/tests/matrix_idle_scan_tests.cpp \
+	$(QUANTUM_PATH)/matrix.c \
+	$(QUANTUM_PATH)/matrix_common.c \
+	$(QUANTUM_PATH)/bitwise.c \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/gpio_mock.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+matrix_idle_scan_col2row_DEFS := $(MATRIX_IDLE_SCAN_COMMON_DEFS) -DDIODE_DIRECTION=COL2ROW
+matrix_idle_scan_col2row_INC := $(MATRIX_IDLE_SCAN_COMMON_INC)
+matrix_idle_scan_col2row_SRC := $(MATRIX_IDLE_SCAN_COMMON_SRC)
+
+matrix_idle_scan_row2col_DEFS := $(MATRIX_IDLE_SCAN_COMMON_DEFS) -DDIODE_DIRECTION=ROW2COL
+matrix_idle_scan_row2col_INC := $(MATRIX_IDLE_SCAN_COMMON_INC)
+matrix_idle_scan_row2col_SRC := $(MATRIX_IDLE_SCAN_COMMON_SRC)
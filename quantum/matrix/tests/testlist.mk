@@ -0,0 +1,3 @@
+TEST_LIST += \
+	matrix_idle_scan_col2row \
+	matrix_idle_scan_row2col
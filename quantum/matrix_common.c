@@ -4,6 +4,7 @@
 #include "wait.h"
 #include "print.h"
 #include "debug.h"
+#include "latency_trace.h"
 
 #ifndef MATRIX_IO_DELAY
 #    define MATRIX_IO_DELAY 30
@@ -45,6 +46,8 @@ inline matrix_row_t matrix_get_row(uint8_t row) {
 #endif
 }
 
+__attribute__((weak)) bool debounce_pending(void) { return debounce_active(); }
+
 // Deprecated.
 bool matrix_is_modified(void) {
     if (debounce_active()) return false;
@@ -111,8 +114,11 @@ __attribute__((weak)) void matrix_init(void) {
 
 __attribute__((weak)) uint8_t matrix_scan(void) {
     bool changed = matrix_scan_custom(raw_matrix);
+    if (changed) latency_trace_mark(LATENCY_STAGE_MATRIX);
 
-    debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    if (changed || debounce_pending()) {
+        debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    }
 
     matrix_scan_quantum();
     return changed;
@@ -18,14 +18,69 @@
 
 #include "pointing_device.h"
 #include <string.h>
+#include "timer.h"
 #ifdef MOUSEKEY_ENABLE
 #    include "mousekey.h"
 #endif
 #if (defined(POINTING_DEVICE_ROTATION_90) + defined(POINTING_DEVICE_ROTATION_180) + defined(POINTING_DEVICE_ROTATION_270)) > 1
 #    error More than one rotation selected.  This is not supported.
 #endif
+#if (defined(POINTING_DEVICE_ROTATION_90_RIGHT) + defined(POINTING_DEVICE_ROTATION_180_RIGHT) + defined(POINTING_DEVICE_ROTATION_270_RIGHT)) > 1
+#    error More than one rotation selected for the right half.  This is not supported.
+#endif
+#if defined(SPLIT_POINTING_ENABLE) && !defined(SPLIT_KEYBOARD)
+#    error SPLIT_POINTING_ENABLE is only supported on split keyboards.
+#endif
+
+#ifndef POINTING_DEVICE_SCALE_NUMERATOR
+#    define POINTING_DEVICE_SCALE_NUMERATOR 1
+#endif
+#ifndef POINTING_DEVICE_SCALE_DENOMINATOR
+#    define POINTING_DEVICE_SCALE_DENOMINATOR 1
+#endif
+// milliseconds between sensor reads while it is moving
+#ifndef POINTING_DEVICE_POLL_INTERVAL
+#    define POINTING_DEVICE_POLL_INTERVAL 1
+#endif
+// milliseconds without motion until the sensor counts as idle
+#ifndef POINTING_DEVICE_IDLE_TIMEOUT
+#    define POINTING_DEVICE_IDLE_TIMEOUT 100
+#endif
+// milliseconds between reads of an idle sensor without a motion pin
+#ifndef POINTING_DEVICE_IDLE_POLL_INTERVAL
+#    define POINTING_DEVICE_IDLE_POLL_INTERVAL POINTING_DEVICE_POLL_INTERVAL
+#endif
+// milliseconds between motion reports, the host does not read them any faster
+#ifndef POINTING_DEVICE_SEND_INTERVAL
+#    ifdef USB_POLLING_INTERVAL_MS
+#        define POINTING_DEVICE_SEND_INTERVAL USB_POLLING_INTERVAL_MS
+#    else
+#        define POINTING_DEVICE_SEND_INTERVAL 1
+#    endif
+#endif
 
 static report_mouse_t mouseReport = {};
+// motion that did not fit the last report yet, it goes out with the following ones
+static int32_t pending_x = 0, pending_y = 0, pending_v = 0, pending_h = 0;
+#if POINTING_DEVICE_SCALE_NUMERATOR != POINTING_DEVICE_SCALE_DENOMINATOR
+// fractions of a count left over from scaling
+static int32_t remainder_x = 0, remainder_y = 0;
+#endif
+
+static fast_timer_t last_sample = 0, last_send = 0, last_motion = 0;
+static bool         sensor_idle  = true;
+static uint8_t      sent_buttons = 0;
+#ifdef POINTING_DEVICE_STATS_ENABLE
+static pointing_device_stats_t stats       = {};
+static uint32_t                stats_start = 0;
+#endif
+#ifdef SPLIT_POINTING_ENABLE
+// slave: what its sensor gathered so far, master: motion of the other half that did not fit a report yet
+static pointing_device_shared_t shared_motion  = {};
+static int32_t                  shared_x = 0, shared_y = 0, shared_v = 0, shared_h = 0;
+static uint8_t                  shared_buttons = 0, merged_buttons = 0;
+static uint16_t                 shared_cpi     = 0;
+#endif
 
 extern const pointing_device_driver_t pointing_device_driver;
 
@@ -46,21 +101,76 @@ __attribute__((weak)) uint8_t pointing_device_handle_buttons(uint8_t buttons, bo
 }
 
 __attribute__((weak)) void pointing_device_init(void) {
-    pointing_device_driver.init();
+    if (POINTING_DEVICE_ON_THIS_SIDE()) {
+        pointing_device_driver.init();
 #ifdef POINTING_DEVICE_MOTION_PIN
-    setPinInputHigh(POINTING_DEVICE_MOTION_PIN);
+        setPinInputHigh(POINTING_DEVICE_MOTION_PIN);
+#endif
+    }
+#ifdef POINTING_DEVICE_STATS_ENABLE
+    pointing_device_stats_reset();
 #endif
     pointing_device_init_kb();
     pointing_device_init_user();
 }
 
+#if POINTING_DEVICE_SCALE_NUMERATOR != POINTING_DEVICE_SCALE_DENOMINATOR
+static int32_t pointing_device_scale(int32_t counts, int32_t *remainder) {
+    int32_t scaled = counts * POINTING_DEVICE_SCALE_NUMERATOR + *remainder;
+    *remainder     = scaled % POINTING_DEVICE_SCALE_DENOMINATOR;
+    return scaled / POINTING_DEVICE_SCALE_DENOMINATOR;
+}
+#endif
+
+// Moves the motion of the current report to the pending counts
+static void pointing_device_accumulate(void) {
+#if POINTING_DEVICE_SCALE_NUMERATOR != POINTING_DEVICE_SCALE_DENOMINATOR
+    pending_x += pointing_device_scale(mouseReport.x, &remainder_x);
+    pending_y += pointing_device_scale(mouseReport.y, &remainder_y);
+#else
+    pending_x += mouseReport.x;
+    pending_y += mouseReport.y;
+#endif
+    pending_v += mouseReport.v;
+    pending_h += mouseReport.h;
+    mouseReport.x = 0;
+    mouseReport.y = 0;
+    mouseReport.v = 0;
+    mouseReport.h = 0;
+}
+
+// Takes as much of the pending motion as one report can carry
+static int32_t pointing_device_take_motion(int32_t *pending, int32_t limit) {
+    int32_t motion = *pending < -limit ? -limit : (*pending > limit ? limit : *pending);
+    *pending -= motion;
+    return motion;
+}
+
 __attribute__((weak)) void pointing_device_send(void) {
     static report_mouse_t old_report = {};
+    int32_t               xy_limit   = MOUSE_REPORT_XY_MAX;
+#if defined(MOUSE_EXTENDED_REPORT) && !defined(MOUSE_SHARED_EP)
+    // boot protocol hosts only read 8 bits of X/Y
+    if (!mouse_protocol) {
+        xy_limit = 127;
+    }
+#endif
+
+    pointing_device_accumulate();
+    mouseReport.x = pointing_device_take_motion(&pending_x, xy_limit);
+    mouseReport.y = pointing_device_take_motion(&pending_y, xy_limit);
+    mouseReport.v = pointing_device_take_motion(&pending_v, 127);
+    mouseReport.h = pointing_device_take_motion(&pending_h, 127);
 
     // If you need to do other things, like debugging, this is the place to do it.
     if (has_mouse_report_changed(mouseReport, old_report)) {
         host_mouse_send(&mouseReport);
+#ifdef POINTING_DEVICE_STATS_ENABLE
+        stats.reports++;
+#endif
     }
+    last_send    = timer_read_fast();
+    sent_buttons = mouseReport.buttons;
     // send it and 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
     mouseReport.x = 0;
     mouseReport.y = 0;
@@ -70,51 +180,213 @@ __attribute__((weak)) void pointing_device_send(void) {
     memcpy(&old_report, &mouseReport, sizeof(mouseReport));
 }
 
-__attribute__((weak)) void pointing_device_task(void) {
-    // Gather report info
+// Whether the sensor should be read on this pass of the main loop
+static bool pointing_device_sample_due(void) {
+    if (!sensor_idle && timer_elapsed_fast(last_motion) >= POINTING_DEVICE_IDLE_TIMEOUT) {
+        sensor_idle = true;
+    }
 #ifdef POINTING_DEVICE_MOTION_PIN
-    if (!readPin(POINTING_DEVICE_MOTION_PIN))
+    // the sensor only has motion to report while it holds the pin low, which also wakes it up from idle
+    if (readPin(POINTING_DEVICE_MOTION_PIN)) {
+        return false;
+    }
+    return sensor_idle || timer_elapsed_fast(last_sample) >= POINTING_DEVICE_POLL_INTERVAL;
+#else
+    return timer_elapsed_fast(last_sample) >= (sensor_idle ? POINTING_DEVICE_IDLE_POLL_INTERVAL : POINTING_DEVICE_POLL_INTERVAL);
 #endif
-        mouseReport = pointing_device_driver.get_report(mouseReport);
+}
 
-        // Support rotation of the sensor data
+static void pointing_device_adjust_by_defines(report_mouse_t *report) {
+    // Support rotation of the sensor data
 #if defined(POINTING_DEVICE_ROTATION_90) || defined(POINTING_DEVICE_ROTATION_180) || defined(POINTING_DEVICE_ROTATION_270)
-    int8_t x = mouseReport.x, y = mouseReport.y;
+    mouse_xy_report_t x = report->x, y = report->y;
 #    if defined(POINTING_DEVICE_ROTATION_90)
-    mouseReport.x = y;
-    mouseReport.y = -x;
+    report->x = y;
+    report->y = -x;
 #    elif defined(POINTING_DEVICE_ROTATION_180)
-    mouseReport.x = -x;
-    mouseReport.y = -y;
+    report->x = -x;
+    report->y = -y;
 #    elif defined(POINTING_DEVICE_ROTATION_270)
-    mouseReport.x = -y;
-    mouseReport.y = x;
+    report->x = -y;
+    report->y = x;
 #    else
 #        error "How the heck did you get here?!"
 #    endif
 #endif
     // Support Inverting the X and Y Axises
 #if defined(POINTING_DEVICE_INVERT_X)
-    mouseReport.x = -mouseReport.x;
+    report->x = -report->x;
 #endif
 #if defined(POINTING_DEVICE_INVERT_Y)
-    mouseReport.y = -mouseReport.y;
+    report->y = -report->y;
 #endif
+}
 
-    // allow kb to intercept and modify report
-    mouseReport = pointing_device_task_kb(mouseReport);
+#if defined(SPLIT_POINTING_ENABLE) && defined(POINTING_DEVICE_COMBINED)
+// The sensor of the right half when both halves have one
+static void pointing_device_adjust_by_defines_right(report_mouse_t *report) {
+#    if defined(POINTING_DEVICE_ROTATION_90_RIGHT) || defined(POINTING_DEVICE_ROTATION_180_RIGHT) || defined(POINTING_DEVICE_ROTATION_270_RIGHT)
+    mouse_xy_report_t x = report->x, y = report->y;
+#        if defined(POINTING_DEVICE_ROTATION_90_RIGHT)
+    report->x = y;
+    report->y = -x;
+#        elif defined(POINTING_DEVICE_ROTATION_180_RIGHT)
+    report->x = -x;
+    report->y = -y;
+#        elif defined(POINTING_DEVICE_ROTATION_270_RIGHT)
+    report->x = -y;
+    report->y = x;
+#        endif
+#    endif
+#    if defined(POINTING_DEVICE_INVERT_X_RIGHT)
+    report->x = -report->x;
+#    endif
+#    if defined(POINTING_DEVICE_INVERT_Y_RIGHT)
+    report->y = -report->y;
+#    endif
+}
+#endif
+
+static void pointing_device_sample(void) {
+    // Gather report info
+    mouseReport = pointing_device_driver.get_report(mouseReport);
+    last_sample = timer_read_fast();
+#ifdef POINTING_DEVICE_STATS_ENABLE
+    stats.samples++;
+#endif
+    if (mouseReport.x || mouseReport.y) {
+        last_motion = last_sample;
+        sensor_idle = false;
+    }
+
+#if defined(SPLIT_POINTING_ENABLE) && defined(POINTING_DEVICE_COMBINED)
+    if (!is_keyboard_left()) {
+        pointing_device_adjust_by_defines_right(&mouseReport);
+        return;
+    }
+#endif
+    pointing_device_adjust_by_defines(&mouseReport);
+}
+
+#ifdef SPLIT_POINTING_ENABLE
+// Adds the motion of this half to the running totals the master reads
+static void pointing_device_share(void) {
+    shared_motion.x += mouseReport.x;
+    shared_motion.y += mouseReport.y;
+    shared_motion.v += mouseReport.v;
+    shared_motion.h += mouseReport.h;
+    shared_motion.buttons = mouseReport.buttons;
+    mouseReport.x         = 0;
+    mouseReport.y         = 0;
+    mouseReport.v         = 0;
+    mouseReport.h         = 0;
+}
+
+// Adds as much motion of the other half as the report can carry, the rest waits for the next pass
+static bool pointing_device_merge_shared(void) {
+    if (!shared_x && !shared_y && !shared_v && !shared_h && shared_buttons == merged_buttons) {
+        return false;
+    }
+    shared_x += mouseReport.x;
+    shared_y += mouseReport.y;
+    shared_v += mouseReport.v;
+    shared_h += mouseReport.h;
+    mouseReport.x       = pointing_device_take_motion(&shared_x, MOUSE_REPORT_XY_MAX);
+    mouseReport.y       = pointing_device_take_motion(&shared_y, MOUSE_REPORT_XY_MAX);
+    mouseReport.v       = pointing_device_take_motion(&shared_v, 127);
+    mouseReport.h       = pointing_device_take_motion(&shared_h, 127);
+    mouseReport.buttons = (mouseReport.buttons & ~merged_buttons) | shared_buttons;
+    merged_buttons      = shared_buttons;
+    return true;
+}
+#endif
+
+__attribute__((weak)) void pointing_device_task(void) {
+    bool sampled = false;
+    if (POINTING_DEVICE_ON_THIS_SIDE() && pointing_device_sample_due()) {
+        pointing_device_sample();
+        sampled = true;
+    }
+#ifdef SPLIT_POINTING_ENABLE
+    // the slave only gathers motion, the master reads it with the matrix
+    if (!is_keyboard_master()) {
+        if (sampled) {
+            pointing_device_share();
+        }
+        return;
+    }
+    sampled |= pointing_device_merge_shared();
+#endif
+    if (sampled) {
+        // allow kb to intercept and modify report
+        mouseReport = pointing_device_task_kb(mouseReport);
+        // motion waits for the next report, buttons are checked on every pass
+        pointing_device_accumulate();
+    }
     // combine with mouse report to ensure that the combined is sent correctly
 #ifdef MOUSEKEY_ENABLE
     report_mouse_t mousekey_report = mousekey_get_report();
     mouseReport.buttons            = mouseReport.buttons | mousekey_report.buttons;
 #endif
-    pointing_device_send();
+    // button changes go out right away, motion once per polling interval of the host
+    if (mouseReport.buttons != sent_buttons || timer_elapsed_fast(last_send) >= POINTING_DEVICE_SEND_INTERVAL) {
+        pointing_device_send();
+    }
 }
 
 report_mouse_t pointing_device_get_report(void) { return mouseReport; }
 
 void pointing_device_set_report(report_mouse_t newMouseReport) { mouseReport = newMouseReport; }
 
+#ifdef SPLIT_POINTING_ENABLE
+uint16_t pointing_device_get_cpi(void) { return POINTING_DEVICE_ON_THIS_SIDE() ? pointing_device_driver.get_cpi() : shared_cpi; }
+
+void pointing_device_set_cpi(uint16_t cpi) {
+    if (POINTING_DEVICE_ON_OTHER_SIDE()) {
+        shared_cpi = cpi;
+    }
+    if (POINTING_DEVICE_ON_THIS_SIDE()) {
+        pointing_device_driver.set_cpi(cpi);
+    }
+}
+
+void pointing_device_set_cpi_on_side(bool left, uint16_t cpi) {
+    if (left != is_keyboard_left()) {
+        shared_cpi = cpi;
+    } else if (POINTING_DEVICE_ON_THIS_SIDE()) {
+        pointing_device_driver.set_cpi(cpi);
+    }
+}
+
+void pointing_device_get_shared_motion(pointing_device_shared_t *totals) { *totals = shared_motion; }
+
+void pointing_device_add_shared_motion(int32_t x, int32_t y, int32_t v, int32_t h, uint8_t buttons) {
+    shared_x += x;
+    shared_y += y;
+    shared_v += v;
+    shared_h += h;
+    shared_buttons = buttons;
+}
+
+uint16_t pointing_device_get_shared_cpi(void) { return shared_cpi; }
+#else
 uint16_t pointing_device_get_cpi(void) { return pointing_device_driver.get_cpi(); }
 
 void pointing_device_set_cpi(uint16_t cpi) { pointing_device_driver.set_cpi(cpi); }
+#endif
+
+#ifdef POINTING_DEVICE_STATS_ENABLE
+void pointing_device_get_stats(pointing_device_stats_t *out) {
+    *out         = stats;
+    out->elapsed = timer_elapsed32(stats_start);
+    if (out->elapsed) {
+        out->sample_rate = (uint32_t)stats.samples * 1000 / out->elapsed;
+        out->report_rate = (uint32_t)stats.reports * 1000 / out->elapsed;
+    }
+}
+
+void pointing_device_stats_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+    stats_start = timer_read32();
+}
+#endif
@@ -21,6 +21,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "report.h"
 
+#ifdef SPLIT_POINTING_ENABLE
+#    include "keyboard.h"
+// Which halves of a split keyboard have a sensor
+#    if defined(POINTING_DEVICE_COMBINED)
+#        define POINTING_DEVICE_ON_THIS_SIDE() true
+#        define POINTING_DEVICE_ON_OTHER_SIDE() true
+#    elif defined(POINTING_DEVICE_LEFT)
+#        define POINTING_DEVICE_ON_THIS_SIDE() is_keyboard_left()
+#        define POINTING_DEVICE_ON_OTHER_SIDE() (!is_keyboard_left())
+#    elif defined(POINTING_DEVICE_RIGHT)
+#        define POINTING_DEVICE_ON_THIS_SIDE() (!is_keyboard_left())
+#        define POINTING_DEVICE_ON_OTHER_SIDE() is_keyboard_left()
+#    else
+#        error "SPLIT_POINTING_ENABLE requires POINTING_DEVICE_LEFT, POINTING_DEVICE_RIGHT or POINTING_DEVICE_COMBINED"
+#    endif
+#else
+#    define POINTING_DEVICE_ON_THIS_SIDE() true
+#endif
+
 #if defined(POINTING_DEVICE_DRIVER_adns5050)
 #    include "drivers/sensors/adns5050.h"
 #elif defined(POINTING_DEVICE_DRIVER_adns9800)
@@ -72,12 +91,25 @@ typedef enum {
     POINTING_DEVICE_BUTTON8,
 } pointing_device_buttons_t;
 
+typedef struct {
+    uint32_t samples;     /* sensor reads */
+    uint32_t reports;     /* reports handed to the host driver */
+    uint32_t elapsed;     /* milliseconds since the counters were reset */
+    uint16_t sample_rate; /* achieved sensor reads per second */
+    uint16_t report_rate; /* achieved reports per second */
+} pointing_device_stats_t;
+
+typedef struct {
+    uint32_t x, y, v, h; /* running totals of the motion counts, wrapping around */
+    uint8_t  buttons;
+} pointing_device_shared_t;
+
 void           pointing_device_init(void);
 void           pointing_device_task(void);
 void           pointing_device_send(void);
 report_mouse_t pointing_device_get_report(void);
 void           pointing_device_set_report(report_mouse_t newMouseReport);
-bool           has_mouse_report_changed(report_mouse_t new, report_mouse_t old);
+bool           has_mouse_report_changed(report_mouse_t new_report, report_mouse_t old_report);
 uint16_t       pointing_device_get_cpi(void);
 void           pointing_device_set_cpi(uint16_t cpi);
 
@@ -86,3 +118,15 @@ void           pointing_device_init_user(void);
 report_mouse_t pointing_device_task_kb(report_mouse_t mouse_report);
 report_mouse_t pointing_device_task_user(report_mouse_t mouse_report);
 uint8_t        pointing_device_handle_buttons(uint8_t buttons, bool pressed, pointing_device_buttons_t button);
+
+#ifdef SPLIT_POINTING_ENABLE
+void     pointing_device_set_cpi_on_side(bool left, uint16_t cpi);
+void     pointing_device_get_shared_motion(pointing_device_shared_t *totals);
+void     pointing_device_add_shared_motion(int32_t x, int32_t y, int32_t v, int32_t h, uint8_t buttons);
+uint16_t pointing_device_get_shared_cpi(void);
+#endif
+
+#ifdef POINTING_DEVICE_STATS_ENABLE
+void pointing_device_get_stats(pointing_device_stats_t *stats);
+void pointing_device_stats_reset(void);
+#endif
@@ -22,8 +22,8 @@
 #include "timer.h"
 #include <stddef.h>
 
-// hid mouse reports cannot exceed -127 to 127, so constrain to that value
-#define constrain_hid(amt) ((amt) < -127 ? -127 : ((amt) > 127 ? 127 : (amt)))
+// hid mouse reports cannot exceed the range of their X/Y fields, so constrain to that value
+#define constrain_hid(amt) ((amt) < MOUSE_REPORT_XY_MIN ? MOUSE_REPORT_XY_MIN : ((amt) > MOUSE_REPORT_XY_MAX ? MOUSE_REPORT_XY_MAX : (amt)))
 
 // get_report functions should probably be moved to their respective drivers.
 #if defined(POINTING_DEVICE_DRIVER_adns5050)
@@ -55,8 +55,8 @@ const pointing_device_driver_t pointing_device_driver = {
 report_mouse_t adns9800_get_report_driver(report_mouse_t mouse_report) {
     report_adns9800_t sensor_report = adns9800_get_report();
 
-    int8_t clamped_x = constrain_hid(sensor_report.x);
-    int8_t clamped_y = constrain_hid(sensor_report.y);
+    mouse_xy_report_t clamped_x = constrain_hid(sensor_report.x);
+    mouse_xy_report_t clamped_y = constrain_hid(sensor_report.y);
 
     mouse_report.x = clamped_x;
     mouse_report.y = clamped_y;
@@ -115,16 +115,16 @@ const pointing_device_driver_t pointing_device_driver = {
 #    endif
 
 report_mouse_t cirque_pinnacle_get_report(report_mouse_t mouse_report) {
-    pinnacle_data_t touchData = cirque_pinnacle_read_data();
-    static uint16_t x = 0, y = 0, mouse_timer = 0;
-    int8_t          report_x = 0, report_y = 0;
-    static bool     is_z_down = false;
+    pinnacle_data_t   touchData = cirque_pinnacle_read_data();
+    static uint16_t   x = 0, y = 0, mouse_timer = 0;
+    mouse_xy_report_t report_x = 0, report_y = 0;
+    static bool       is_z_down = false;
 
     cirque_pinnacle_scale_data(&touchData, cirque_pinnacle_get_scale(), cirque_pinnacle_get_scale());  // Scale coordinates to arbitrary X, Y resolution
 
     if (x && y && touchData.xValue && touchData.yValue) {
-        report_x = (int8_t)(touchData.xValue - x);
-        report_y = (int8_t)(touchData.yValue - y);
+        report_x = (mouse_xy_report_t)(touchData.xValue - x);
+        report_y = (mouse_xy_report_t)(touchData.yValue - y);
     }
     x = touchData.xValue;
     y = touchData.yValue;
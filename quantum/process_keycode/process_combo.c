@@ -49,6 +49,9 @@ static uint16_t timer = 0;
 #endif
 static bool     b_combo_enable = true;  // defaults to enabled
 static uint16_t longest_term   = 0;
+#ifdef COMBO_INDEX_ENABLE
+static bool combo_state_dirty = false;  // some combo may have state for clear_combos() to reset
+#endif
 
 typedef struct {
     keyrecord_t record;
@@ -174,6 +177,13 @@ static inline uint16_t _get_combo_term(uint16_t combo_index, combo_t *combo) {
 void clear_combos(void) {
     uint16_t index = 0;
     longest_term   = 0;
+#ifdef COMBO_INDEX_ENABLE
+    // Without this, every key event would still visit every combo
+    if (!combo_state_dirty) {
+        return;
+    }
+    combo_state_dirty = false;
+#endif
     for (index = 0; index < COMBO_LEN; ++index) {
         combo_t *combo = &key_combos[index];
         if (!COMBO_ACTIVE(combo)) {
@@ -228,6 +238,90 @@ static inline void dump_key_buffer(void) {
         state &= ~(1 << key_index);    \
     } while (0)
 
+#ifdef COMBO_INDEX_ENABLE
+#    ifndef COMBO_INDEX_SIZE
+#        define COMBO_INDEX_SIZE 256
+#    endif
+
+#    if MAX_COMBO_LENGTH > 16
+#        define COMBO_INDEX_KEY_BITS 5
+#    elif MAX_COMBO_LENGTH > 8
+#        define COMBO_INDEX_KEY_BITS 4
+#    else
+#        define COMBO_INDEX_KEY_BITS 3
+#    endif
+
+/* An entry packs a combo index and the position of one of its keys. */
+#    define COMBO_INDEX_ENTRY(combo_index, key_index) ((uint16_t)(((combo_index) << COMBO_INDEX_KEY_BITS) | (key_index)))
+#    define COMBO_INDEX_ENTRY_COMBO(entry) ((entry) >> COMBO_INDEX_KEY_BITS)
+#    define COMBO_INDEX_ENTRY_KEY(entry) ((entry) & ((1 << COMBO_INDEX_KEY_BITS) - 1))
+#    define COMBO_INDEX_MAX_COMBOS (1 << (16 - COMBO_INDEX_KEY_BITS))
+
+/* Every key of every combo, sorted by keycode and then by combo index. The
+ * combos containing a keycode are then a contiguous run, in combo order.
+ * Empty if the index does not fit, in which case all combos are scanned. */
+static uint16_t combo_lookup[COMBO_INDEX_SIZE];
+static uint16_t combo_lookup_length = 0;
+static bool     combo_lookup_built  = false;
+
+static inline uint16_t combo_lookup_keycode(uint16_t entry) { return pgm_read_word(&key_combos[COMBO_INDEX_ENTRY_COMBO(entry)].keys[COMBO_INDEX_ENTRY_KEY(entry)]); }
+
+static inline bool combo_lookup_less(uint16_t entry1, uint16_t entry2) {
+    uint16_t keycode1 = combo_lookup_keycode(entry1);
+    uint16_t keycode2 = combo_lookup_keycode(entry2);
+    return keycode1 < keycode2 || (keycode1 == keycode2 && entry1 < entry2);
+}
+
+static void combo_lookup_build(void) {
+    combo_lookup_built  = true;
+    combo_lookup_length = 0;
+    if (COMBO_LEN > COMBO_INDEX_MAX_COMBOS) {
+        dprintln("Too many combos to index");
+        return;
+    }
+
+    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+        const uint16_t *keys = key_combos[idx].keys;
+        for (uint8_t key_index = 0; pgm_read_word(&keys[key_index]) != COMBO_END; key_index++) {
+            if (combo_lookup_length == COMBO_INDEX_SIZE) {
+                dprintln("COMBO_INDEX_SIZE too small, scanning all combos");
+                combo_lookup_length = 0;
+                return;
+            }
+            combo_lookup[combo_lookup_length++] = COMBO_INDEX_ENTRY(idx, key_index);
+        }
+    }
+
+    // Shell sort, only runs once
+    for (uint16_t gap = combo_lookup_length / 2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < combo_lookup_length; i++) {
+            uint16_t entry = combo_lookup[i];
+            uint16_t j     = i;
+            while (j >= gap && combo_lookup_less(entry, combo_lookup[j - gap])) {
+                combo_lookup[j] = combo_lookup[j - gap];
+                j -= gap;
+            }
+            combo_lookup[j] = entry;
+        }
+    }
+}
+
+/* Returns the position of the first entry with the given keycode, or of the first greater one. */
+static uint16_t combo_lookup_find(uint16_t keycode) {
+    uint16_t low  = 0;
+    uint16_t high = combo_lookup_length;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_lookup_keycode(combo_lookup[mid]) < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+#endif
+
 static inline void _find_key_index_and_count(const uint16_t *keys, uint16_t keycode, uint16_t *key_index, uint8_t *key_count) {
     while (true) {
         uint16_t key = pgm_read_word(&keys[*key_count]);
@@ -487,10 +581,34 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     keycode = keymap_key_to_keycode(COMBO_ONLY_FROM_LAYER, record->event.key);
 #endif
 
-    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
-        combo_t *combo = &key_combos[idx];
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#ifdef COMBO_INDEX_ENABLE
+    if (!combo_lookup_built) {
+        combo_lookup_build();
+    }
+    if (combo_lookup_length) {
+        // Only visit the combos containing this keycode. Combos not containing it are left untouched by process_single_combo().
+        uint16_t last_idx = (uint16_t)-1;
+        for (uint16_t i = combo_lookup_find(keycode); i < combo_lookup_length && combo_lookup_keycode(combo_lookup[i]) == keycode; ++i) {
+            uint16_t idx = COMBO_INDEX_ENTRY_COMBO(combo_lookup[i]);
+            if (idx == last_idx) {
+                // keycode appears more than once in this combo
+                continue;
+            }
+            last_idx = idx;
+            is_combo_key |= process_single_combo(&key_combos[idx], keycode, record, idx);
+            combo_state_dirty = true;
+        }
+    } else
+#endif
+    {
+        for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+            combo_t *combo = &key_combos[idx];
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+            no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+        }
+#ifdef COMBO_INDEX_ENABLE
+        combo_state_dirty = true;
+#endif
     }
 
     if (record->event.pressed && is_combo_key) {
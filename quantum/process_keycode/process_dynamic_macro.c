@@ -16,7 +16,12 @@
  */
 
 /* Author: Wojciech Siewierski < wojciech dot siewierski at onet dot pl > */
+#include <string.h>
 #include "process_dynamic_macro.h"
+#include "deferred_exec.h"
+#ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 
 // default feedback method
 void dynamic_macro_led_blink(void) {
@@ -37,103 +42,391 @@ __attribute__((weak)) void dynamic_macro_record_key_user(int8_t direction, keyre
 
 __attribute__((weak)) void dynamic_macro_record_end_user(int8_t direction) { dynamic_macro_led_blink(); }
 
-/* Convenience macros used for retrieving the debug info. All of them
- * need a `direction` variable accessible at the call site.
+/* All the macros share one arena, one after the other in no particular
+ * order. Each of them starts with a 3 byte header, its slot and its
+ * length in bytes (little endian), followed by its key events:
+ *
+ *   flags        DM_PRESSED, DM_DELAY, DM_KEYCODE and the tap state
+ *   row, column  the key position, played back through the keymap
+ *   keycode      with DM_KEYCODE, 16 bits little endian (combos only)
+ *   delay        with DM_DELAY, milliseconds since the previous event,
+ *                7 bits per byte lowest first, the high bit set on all
+ *                bytes but the last
+ *
+ * Starting to record a slot removes its previous macro, moving down the
+ * ones after it, and the new one is written after the last of them.
+ * The recording is stopped when it reaches the end of the arena, so there
+ * is no limit on the macros' length in relation to each other.
+ */
+#define DM_PRESSED 0x80
+#define DM_DELAY 0x40
+#define DM_KEYCODE 0x20
+#define DM_TAP_INTERRUPTED 0x10
+#define DM_TAP_COUNT 0x0F
+
+#define DM_HEADER_SIZE 3
+#define DM_EEPROM_MAGIC 0xD1
+
+typedef struct {
+    uint16_t      position;
+    uint16_t      end;
+    uint8_t       slot;
+    layer_state_t saved_layer_state;
+} dynamic_macro_playback_t;
+
+static uint8_t  arena[DYNAMIC_MACRO_ARENA_SIZE];
+static uint16_t arena_used = 0;
+
+/* 0 when no macro is being recorded, the slot + 1 otherwise. The macro
+ * being recorded is written at arena_used and only becomes part of the
+ * used arena once the recording ends.
  */
-#define DYNAMIC_MACRO_CURRENT_SLOT() (direction > 0 ? 1 : 2)
-#define DYNAMIC_MACRO_CURRENT_LENGTH(BEGIN, POINTER) ((int)(direction * ((POINTER) - (BEGIN))))
-#define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) ((int)(direction * ((END2) - (BEGIN)) + 1))
+static uint8_t  recording = 0;
+static uint16_t recording_end;
+/* After the last key-up event: the keys being held when stopping the
+ * recording, i.e. the keys used to access the layer DYN_REC_STOP is on,
+ * are not saved.
+ */
+static uint16_t recording_kept;
+#ifdef DYNAMIC_MACRO_TIMING
+static uint16_t recording_time;
+#endif
 
-/**
- * Start recording of the dynamic macro.
- *
- * @param[out] macro_pointer The new macro buffer iterator.
- * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
+/* The macros being played back, the innermost last. */
+static dynamic_macro_playback_t playback[DYNAMIC_MACRO_MAX_NESTING];
+static uint8_t                  playback_depth = 0;
+static deferred_token           playback_token = INVALID_DEFERRED_TOKEN;
+
+/* The user hooks get +1 for the first macro and -1 for the second one,
+ * which used to be recorded from the other end of the buffer.
  */
-void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_buffer) {
-    dprintln("dynamic macro recording: started");
+static int8_t dynamic_macro_direction(uint8_t slot) { return slot == 0 ? 1 : -(int8_t)slot; }
 
-    dynamic_macro_record_start_user();
+static uint16_t dynamic_macro_header_length(uint16_t offset) { return arena[offset + 1] | (arena[offset + 2] << 8); }
 
-    clear_keyboard();
-    layer_clear();
-    *macro_pointer = macro_buffer;
+/* The offset of a slot's macro header, arena_used if the slot is empty. */
+static uint16_t dynamic_macro_find(uint8_t slot) {
+    uint16_t offset = 0;
+    while (offset < arena_used && arena[offset] != slot) {
+        offset += DM_HEADER_SIZE + dynamic_macro_header_length(offset);
+    }
+    return offset;
+}
+
+static void dynamic_macro_remove(uint8_t slot) {
+    uint16_t offset = dynamic_macro_find(slot);
+    if (offset == arena_used) {
+        return;
+    }
+    uint16_t size = DM_HEADER_SIZE + dynamic_macro_header_length(offset);
+    memmove(&arena[offset], &arena[offset + size], arena_used - offset - size);
+    arena_used -= size;
 }
 
 /**
- * Play the dynamic macro.
+ * Decode the key event at a position of the arena.
  *
- * @param macro_buffer[in] The beginning of the macro buffer being played.
- * @param macro_end[in]    The element after the last macro buffer element.
- * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
+ * @param position[in] The position of the event.
+ * @param record[out]  The key event, to be passed to process_record().
+ * @param delay[out]   Milliseconds to wait before playing it back.
+ * @return The position of the next event.
  */
-void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_t direction) {
-    dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
+static uint16_t dynamic_macro_decode(uint16_t position, keyrecord_t *record, uint16_t *delay) {
+    uint8_t flags = arena[position++];
+
+    memset(record, 0, sizeof(keyrecord_t));
+    record->event.pressed   = flags & DM_PRESSED;
+    record->event.key.row   = arena[position++];
+    record->event.key.col   = arena[position++];
+    record->event.time      = timer_read() | 1;
+#ifndef NO_ACTION_TAPPING
+    record->tap.interrupted = flags & DM_TAP_INTERRUPTED;
+    record->tap.count       = flags & DM_TAP_COUNT;
+#endif
+    if (flags & DM_KEYCODE) {
+#ifdef COMBO_ENABLE
+        record->keycode = arena[position] | (arena[position + 1] << 8);
+#endif
+        position += 2;
+    }
 
-    layer_state_t saved_layer_state = layer_state;
+    *delay = 0;
+    if (flags & DM_DELAY) {
+        for (uint8_t shift = 0;; shift += 7) {
+            uint8_t byte = arena[position++];
+            *delay |= (uint16_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+    }
+    return position;
+}
 
-    clear_keyboard();
-    layer_clear();
+#ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+static void dynamic_macro_save(void) {
+    /* Invalidate the saved macros before overwriting them, so that an
+     * interrupted save leaves no macros rather than broken ones.
+     */
+    uint8_t header[DM_HEADER_SIZE] = {0, arena_used & 0xFF, arena_used >> 8};
+    dynamic_keymap_recorded_macro_set_buffer(0, 1, header);
+    dynamic_keymap_recorded_macro_set_buffer(DM_HEADER_SIZE, arena_used, arena);
+    header[0] = DM_EEPROM_MAGIC;
+    dynamic_keymap_recorded_macro_set_buffer(0, DM_HEADER_SIZE, header);
+}
 
-    while (macro_buffer != macro_end) {
-        process_record(macro_buffer);
-        macro_buffer += direction;
+/* Whether the key events of a saved macro end exactly at its length. */
+static bool dynamic_macro_events_valid(uint16_t position, uint16_t end) {
+    while (position < end) {
+        uint8_t flags = arena[position];
+        position += (flags & DM_KEYCODE) ? 5 : 3;
+        if (flags & DM_DELAY) {
+            /* At most three bytes hold the 16 bit delay */
+            for (uint8_t i = 0;; i++) {
+                if (position >= end || i == 3) {
+                    return false;
+                }
+                if (!(arena[position++] & 0x80)) {
+                    break;
+                }
+            }
+        }
     }
+    return position == end;
+}
+#endif
 
-    clear_keyboard();
+void dynamic_macro_init(void) {
+    arena_used = 0;
+    recording  = 0;
+#ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+    uint8_t header[DM_HEADER_SIZE];
+    dynamic_keymap_recorded_macro_get_buffer(0, DM_HEADER_SIZE, header);
+    uint16_t used = header[1] | (header[2] << 8);
+    if (header[0] != DM_EEPROM_MAGIC || used > DYNAMIC_MACRO_ARENA_SIZE) {
+        dprintln("dynamic macro: no saved macros");
+        return;
+    }
+    dynamic_keymap_recorded_macro_get_buffer(DM_HEADER_SIZE, used, arena);
+
+    /* Keep the macros up to the first one that does not make sense. */
+    uint16_t offset = 0;
+    while (offset + DM_HEADER_SIZE <= used && arena[offset] < DYNAMIC_MACRO_COUNT && offset + DM_HEADER_SIZE + dynamic_macro_header_length(offset) <= used) {
+        uint16_t end = offset + DM_HEADER_SIZE + dynamic_macro_header_length(offset);
+        if (!dynamic_macro_events_valid(offset + DM_HEADER_SIZE, end)) {
+            break;
+        }
+        offset = end;
+    }
+    arena_used = offset;
+    dprintf("dynamic macro: loaded %d bytes\n", arena_used);
+#endif
+}
 
-    layer_state = saved_layer_state;
+/**
+ * Start recording of the dynamic macro.
+ *
+ * @param slot[in] The slot to record, its previous macro is removed.
+ */
+void dynamic_macro_record_start(uint8_t slot) {
+    if (slot >= DYNAMIC_MACRO_COUNT || recording || playback_depth) {
+        return;
+    }
+    dprintln("dynamic macro recording: started");
 
-    dynamic_macro_play_user(direction);
+    dynamic_macro_record_start_user();
+
+    clear_keyboard();
+    layer_clear();
+    dynamic_macro_remove(slot);
+    recording      = slot + 1;
+    recording_end  = arena_used + DM_HEADER_SIZE;
+    recording_kept = recording_end;
 }
 
 /**
  * Record a single key in a dynamic macro.
  *
- * @param macro_buffer[in] The start of the used macro buffer.
- * @param macro_pointer[in,out] The current buffer position.
- * @param macro2_end[in] The end of the other macro.
- * @param direction[in]  Either +1 or -1, which way to iterate the buffer.
- * @param record[in]     The current keypress.
+ * @param record[in] The current keypress.
  */
-void dynamic_macro_record_key(keyrecord_t *macro_buffer, keyrecord_t **macro_pointer, keyrecord_t *macro2_end, int8_t direction, keyrecord_t *record) {
+static void dynamic_macro_record_key(keyrecord_t *record) {
+    uint16_t start = arena_used + DM_HEADER_SIZE;
+
     /* If we've just started recording, ignore all the key releases. */
-    if (!record->event.pressed && *macro_pointer == macro_buffer) {
+    if (!record->event.pressed && recording_end == start) {
         dprintln("dynamic macro: ignoring a leading key-up event");
         return;
     }
 
-    /* The other end of the other macro is the last buffer element it
-     * is safe to use before overwriting the other macro.
-     */
-    if (*macro_pointer - direction != macro2_end) {
-        **macro_pointer = *record;
-        *macro_pointer += direction;
+    uint8_t event[8];
+    uint8_t size = 0;
+    event[size++] = record->event.pressed ? DM_PRESSED : 0;
+#ifndef NO_ACTION_TAPPING
+    event[0] |= (record->tap.interrupted ? DM_TAP_INTERRUPTED : 0) | (record->tap.count & DM_TAP_COUNT);
+#endif
+    event[size++] = record->event.key.row;
+    event[size++] = record->event.key.col;
+#ifdef COMBO_ENABLE
+    if (record->keycode) {
+        event[0] |= DM_KEYCODE;
+        event[size++] = record->keycode & 0xFF;
+        event[size++] = record->keycode >> 8;
+    }
+#endif
+#ifdef DYNAMIC_MACRO_TIMING
+    uint16_t delay = recording_end == start ? 0 : TIMER_DIFF_16(record->event.time, recording_time);
+    if (delay) {
+        event[0] |= DM_DELAY;
+        for (; delay >= 0x80; delay >>= 7) {
+            event[size++] = (delay & 0x7F) | 0x80;
+        }
+        event[size++] = delay;
+    }
+#endif
+
+    if (recording_end + size <= DYNAMIC_MACRO_ARENA_SIZE) {
+        memcpy(&arena[recording_end], event, size);
+        recording_end += size;
+        if (!record->event.pressed) {
+            recording_kept = recording_end;
+        }
+#ifdef DYNAMIC_MACRO_TIMING
+        recording_time = record->event.time;
+#endif
     } else {
-        dynamic_macro_record_key_user(direction, record);
+        dynamic_macro_record_key_user(dynamic_macro_direction(recording - 1), record);
     }
 
-    dprintf("dynamic macro: slot %d length: %d/%d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_pointer), DYNAMIC_MACRO_CURRENT_CAPACITY(macro_buffer, macro2_end));
+    dprintf("dynamic macro: slot %d length: %d/%d\n", recording, recording_end - start, DYNAMIC_MACRO_ARENA_SIZE - start);
 }
 
 /**
- * End recording of the dynamic macro. Essentially just update the
- * pointer to the end of the macro.
+ * End recording of the dynamic macro. The macro joins the used arena,
+ * unless nothing was recorded.
  */
-void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_pointer, int8_t direction, keyrecord_t **macro_end) {
-    dynamic_macro_record_end_user(direction);
+void dynamic_macro_record_end(void) {
+    if (!recording) {
+        return;
+    }
+    uint8_t slot = recording - 1;
+    recording    = 0;
 
-    /* Do not save the keys being held when stopping the recording,
-     * i.e. the keys used to access the layer DYN_REC_STOP is on.
-     */
-    while (macro_pointer != macro_buffer && (macro_pointer - direction)->event.pressed) {
-        dprintln("dynamic macro: trimming a trailing key-down event");
-        macro_pointer -= direction;
+    dynamic_macro_record_end_user(dynamic_macro_direction(slot));
+
+    if (recording_kept != recording_end) {
+        dprintln("dynamic macro: trimming trailing key-down events");
+    }
+    uint16_t length = recording_kept - arena_used - DM_HEADER_SIZE;
+    if (length) {
+        arena[arena_used]     = slot;
+        arena[arena_used + 1] = length & 0xFF;
+        arena[arena_used + 2] = length >> 8;
+        arena_used            = recording_kept;
+    }
+
+    dprintf("dynamic macro: slot %d saved, length: %d\n", slot + 1, length);
+
+#ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+    dynamic_macro_save();
+#endif
+}
+
+/* Leaves the macros that were played back to the end, the innermost first. */
+static void dynamic_macro_play_pop(void) {
+    while (playback_depth && playback[playback_depth - 1].position >= playback[playback_depth - 1].end) {
+        dynamic_macro_playback_t *frame = &playback[--playback_depth];
+
+        clear_keyboard();
+
+        layer_state = frame->saved_layer_state;
+
+        dynamic_macro_play_user(dynamic_macro_direction(frame->slot));
+    }
+}
+
+/* Plays back one key event per call from the main loop, and waits as long
+ * as the next one asks for.
+ */
+static uint32_t dynamic_macro_play_task(uint32_t trigger_time, void *cb_arg) {
+    dynamic_macro_playback_t *frame = &playback[playback_depth - 1];
+    keyrecord_t               record;
+    uint16_t                  delay;
+
+    if (frame->position < frame->end) {
+        frame->position = dynamic_macro_decode(frame->position, &record, &delay);
+        /* May start playing back another macro. */
+        process_record(&record);
+    }
+
+    dynamic_macro_play_pop();
+    if (!playback_depth) {
+        playback_token = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
+
+    frame = &playback[playback_depth - 1];
+    dynamic_macro_decode(frame->position, &record, &delay);
+    return delay ? delay : DYNAMIC_MACRO_PLAYBACK_INTERVAL;
+}
+
+/**
+ * Play the dynamic macro. The key events are played back from the main
+ * loop, so that the keyboard keeps running meanwhile. Real key events wait
+ * in the keyboard's queue until the playback ends, as the layer state is
+ * the macro's until then.
+ *
+ * @param slot[in] The slot to play back.
+ */
+void dynamic_macro_play(uint8_t slot) {
+    if (slot >= DYNAMIC_MACRO_COUNT || recording == slot + 1) {
+        return;
+    }
+    if (playback_depth == DYNAMIC_MACRO_MAX_NESTING) {
+        dprintln("dynamic macro: ignoring playback nested too deep");
+        return;
     }
+    dprintf("dynamic macro: slot %d playback\n", slot + 1);
+
+    uint16_t                  offset = dynamic_macro_find(slot);
+    dynamic_macro_playback_t *frame  = &playback[playback_depth++];
+    frame->slot                      = slot;
+    frame->position                  = offset + DM_HEADER_SIZE;
+    frame->end                       = offset == arena_used ? frame->position : frame->position + dynamic_macro_header_length(offset);
+    frame->saved_layer_state         = layer_state;
+
+    clear_keyboard();
+    layer_clear();
+
+    if (playback_token == INVALID_DEFERRED_TOKEN) {
+        playback_token = defer_exec(DYNAMIC_MACRO_PLAYBACK_INTERVAL, dynamic_macro_play_task, NULL);
+    }
+}
 
-    dprintf("dynamic macro: slot %d saved, length: %d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, macro_pointer));
+bool dynamic_macro_is_recording(void) { return recording != 0; }
 
-    *macro_end = macro_pointer;
+bool dynamic_macro_is_playing(void) { return playback_depth != 0; }
+
+uint16_t dynamic_macro_get_length(uint8_t slot) {
+    uint16_t offset = dynamic_macro_find(slot);
+    return offset == arena_used ? 0 : dynamic_macro_header_length(offset);
+}
+
+uint16_t dynamic_macro_get_free(void) { return arena_used + DM_HEADER_SIZE < DYNAMIC_MACRO_ARENA_SIZE ? DYNAMIC_MACRO_ARENA_SIZE - arena_used - DM_HEADER_SIZE : 0; }
+
+void dynamic_macro_clear(void) {
+    if (playback_depth) {
+        cancel_deferred_exec(playback_token);
+        playback_token = INVALID_DEFERRED_TOKEN;
+        clear_keyboard();
+        layer_state    = playback[0].saved_layer_state;
+        playback_depth = 0;
+    }
+    recording  = 0;
+    arena_used = 0;
+
+#ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+    dynamic_macro_save();
+#endif
 }
 
 /* Handle the key events related to the dynamic macros. Should be
@@ -147,69 +440,21 @@ void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_poin
  *   }
  */
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
-    /* Both macros use the same buffer but read/write on different
-     * ends of it.
-     *
-     * Macro1 is written left-to-right starting from the beginning of
-     * the buffer.
-     *
-     * Macro2 is written right-to-left starting from the end of the
-     * buffer.
-     *
-     * &macro_buffer   macro_end
-     *  v                   v
-     * +------------------------------------------------------------+
-     * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
-     * +------------------------------------------------------------+
-     *                           ^                                 ^
-     *                         r_macro_end                  r_macro_buffer
-     *
-     * During the recording when one macro encounters the end of the
-     * other macro, the recording is stopped. Apart from this, there
-     * are no arbitrary limits for the macros' length in relation to
-     * each other: for example one can either have two medium sized
-     * macros or one long macro and one short macro. Or even one empty
-     * and one using the whole buffer.
-     */
-    static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
-
-    /* Pointer to the first buffer element after the first macro.
-     * Initially points to the very beginning of the buffer since the
-     * macro is empty. */
-    static keyrecord_t *macro_end = macro_buffer;
-
-    /* The other end of the macro buffer. Serves as the beginning of
-     * the second macro. */
-    static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
-
-    /* Like macro_end but for the second macro. */
-    static keyrecord_t *r_macro_end = r_macro_buffer;
-
-    /* A persistent pointer to the current macro position (iterator)
-     * used during the recording. */
-    static keyrecord_t *macro_pointer = NULL;
-
-    /* 0   - no macro is being recorded right now
-     * 1,2 - either macro 1 or 2 is being recorded */
-    static uint8_t macro_id = 0;
-
-    if (macro_id == 0) {
+    if (!recording) {
         /* No macro recording in progress. */
         if (!record->event.pressed) {
             switch (keycode) {
                 case DYN_REC_START1:
-                    dynamic_macro_record_start(&macro_pointer, macro_buffer);
-                    macro_id = 1;
+                    dynamic_macro_record_start(0);
                     return false;
                 case DYN_REC_START2:
-                    dynamic_macro_record_start(&macro_pointer, r_macro_buffer);
-                    macro_id = 2;
+                    dynamic_macro_record_start(1);
                     return false;
                 case DYN_MACRO_PLAY1:
-                    dynamic_macro_play(macro_buffer, macro_end, +1);
+                    dynamic_macro_play(0);
                     return false;
                 case DYN_MACRO_PLAY2:
-                    dynamic_macro_play(r_macro_buffer, r_macro_end, -1);
+                    dynamic_macro_play(1);
                     return false;
             }
         }
@@ -223,15 +468,7 @@ bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
                 if (record->event.pressed ^ (keycode != DYN_REC_STOP)) { /* Ignore the initial release
                                                                           * just after the recording
                                                                           * starts for DYN_REC_STOP. */
-                    switch (macro_id) {
-                        case 1:
-                            dynamic_macro_record_end(macro_buffer, macro_pointer, +1, &macro_end);
-                            break;
-                        case 2:
-                            dynamic_macro_record_end(r_macro_buffer, macro_pointer, -1, &r_macro_end);
-                            break;
-                    }
-                    macro_id = 0;
+                    dynamic_macro_record_end();
                 }
                 return false;
 #ifdef DYNAMIC_MACRO_NO_NESTING
@@ -242,14 +479,7 @@ bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
 #endif
             default:
                 /* Store the key in the macro buffer and process it normally. */
-                switch (macro_id) {
-                    case 1:
-                        dynamic_macro_record_key(macro_buffer, &macro_pointer, r_macro_end, +1, record);
-                        break;
-                    case 2:
-                        dynamic_macro_record_key(r_macro_buffer, &macro_pointer, macro_end, -1, record);
-                        break;
-                }
+                dynamic_macro_record_key(record);
                 return true;
                 break;
         }
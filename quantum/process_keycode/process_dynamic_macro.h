@@ -33,9 +33,68 @@
 #    define DYNAMIC_MACRO_SIZE 128
 #endif
 
+/* Bytes shared by all the macros. Defaults to the memory DYNAMIC_MACRO_SIZE
+ * full key records used to take, or to what fits next to the VIA macros in
+ * a small EEPROM with DYNAMIC_MACRO_EEPROM_ENABLE. Each key event takes
+ * 3 bytes (5 for combos), plus 1 to 3 bytes for its timing with
+ * DYNAMIC_MACRO_TIMING.
+ */
+#ifndef DYNAMIC_MACRO_ARENA_SIZE
+#    ifdef DYNAMIC_MACRO_EEPROM_ENABLE
+#        define DYNAMIC_MACRO_ARENA_SIZE 256
+#    else
+#        define DYNAMIC_MACRO_ARENA_SIZE (DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t))
+#    endif
+#endif
+
+/* Number of macros, only the first two have keycodes. */
+#ifndef DYNAMIC_MACRO_COUNT
+#    define DYNAMIC_MACRO_COUNT 2
+#endif
+
+/* Milliseconds between two played back key events, unless
+ * DYNAMIC_MACRO_TIMING recorded the actual time between them.
+ */
+#ifndef DYNAMIC_MACRO_PLAYBACK_INTERVAL
+#    define DYNAMIC_MACRO_PLAYBACK_INTERVAL 1
+#endif
+
+/* How many macros may be played back from within each other. */
+#ifndef DYNAMIC_MACRO_MAX_NESTING
+#    define DYNAMIC_MACRO_MAX_NESTING 4
+#endif
+
+/* Bytes of the VIA macro EEPROM region that DYNAMIC_MACRO_EEPROM_ENABLE
+ * keeps the macros in: the arena and a 3 byte header.
+ */
+#define DYNAMIC_MACRO_EEPROM_SIZE (DYNAMIC_MACRO_ARENA_SIZE + 3)
+
 void dynamic_macro_led_blink(void);
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
 void dynamic_macro_record_start_user(void);
 void dynamic_macro_play_user(int8_t direction);
 void dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record);
 void dynamic_macro_record_end_user(int8_t direction);
+
+// Loads the macros saved with DYNAMIC_MACRO_EEPROM_ENABLE. Should not be invoked by keyboard/user code.
+void dynamic_macro_init(void);
+
+// Starts recording a macro into a slot below DYNAMIC_MACRO_COUNT, replacing what it held.
+void dynamic_macro_record_start(uint8_t slot);
+
+// Stops the recording, if any, and keeps the macro.
+void dynamic_macro_record_end(void);
+
+// Starts playing back a macro from the main loop, one key event at a time.
+void dynamic_macro_play(uint8_t slot);
+
+// Whether a macro is being recorded or played back.
+bool dynamic_macro_is_recording(void);
+bool dynamic_macro_is_playing(void);
+
+// Bytes a macro takes in the arena, and those still free.
+uint16_t dynamic_macro_get_length(uint8_t slot);
+uint16_t dynamic_macro_get_free(void);
+
+// Deletes all macros, including the saved ones.
+void dynamic_macro_clear(void);
@@ -84,6 +84,27 @@ static bool enabled = true;
 // Public variables
 __attribute__((weak)) const key_override_t **key_overrides = NULL;
 
+#ifdef KEY_OVERRIDE_INDEX_ENABLE
+#    ifndef KEY_OVERRIDE_INDEX_SIZE
+#        define KEY_OVERRIDE_INDEX_SIZE 64
+#    endif
+#    if KEY_OVERRIDE_INDEX_SIZE > 255
+#        error KEY_OVERRIDE_INDEX_SIZE must be less than 256
+#    endif
+
+// A run of key_override_lookup entries
+typedef struct {
+    uint8_t begin;
+    uint8_t end;
+} key_override_bucket_t;
+
+// Positions in key_overrides, sorted by trigger. Empty if the index does not fit, in which case all overrides are scanned.
+static uint8_t                key_override_lookup[KEY_OVERRIDE_INDEX_SIZE];
+static uint8_t                key_override_lookup_length     = 0;
+static uint8_t                key_override_lookup_no_trigger = 0;     // length of the KC_NO bucket at the start
+static const key_override_t **key_override_lookup_source     = NULL;  // key_overrides the index was built for
+#endif
+
 // Forward decls
 static const key_override_t *clear_active_override(const bool allow_reregister);
 
@@ -241,138 +262,251 @@ static bool check_activation_event(const key_override_t *override, const bool ke
     }
 }
 
-/** Iterates through the list of key overrides and tries activating each, until it finds one that activates or reaches the end of overrides. Returns true if the key action for `keycode` should be sent */
-static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
-    if (key_overrides == NULL) {
-        return true;
+/** Checks whether the key event activates the provided override. Sets `trigger_down` to whether the event is the trigger key going down. */
+static bool can_activate_override(const key_override_t *override, const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *trigger_down) {
+    // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
+    if (active_mods == 0 && override->trigger_mods != 0) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
     }
 
-    for (uint8_t i = 0;; i++) {
-        const key_override_t *const override = key_overrides[i];
+    // Check layer
+    if ((override->layers & (1 << layer)) == 0) {
+        key_override_printf("Not activating override: Not set to activate on pressed layer\n");
+        return false;
+    }
 
-        // End of array
-        if (override == NULL) {
-            break;
-        }
+    // Check allowed activation events
+    if (!check_activation_event(override, key_down, is_mod)) {
+        key_override_printf("Not activating override: Activation event not allowed\n");
+        return false;
+    }
 
-        // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
-        if (active_mods == 0 && override->trigger_mods != 0) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
-        }
+    const bool is_trigger = override->trigger == keycode;
 
-        // Check layer
-        if ((override->layers & (1 << layer)) == 0) {
-            key_override_printf("Not activating override: Not set to activate on pressed layer\n");
-            continue;
-        }
+    // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
+    if (is_trigger && !key_down) {
+        key_override_printf("Not activating override: Trigger lifted\n");
+        return false;
+    }
 
-        // Check allowed activation events
-        if (!check_activation_event(override, key_down, is_mod)) {
-            key_override_printf("Not activating override: Activation event not allowed\n");
-            continue;
-        }
+    // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
+    const bool no_trigger = override->trigger == KC_NO;
+
+    // Check if aleady active
+    if (override == active_override) {
+        key_override_printf("Not activating override: Alerady actived\n");
+        return false;
+    }
 
-        const bool is_trigger = override->trigger == keycode;
+    // Check if enabled
+    if (override->enabled != NULL && !((*(override->enabled) & 1))) {
+        key_override_printf("Not activating override: Not enabled\n");
+        return false;
+    }
 
-        // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
-        if (is_trigger && !key_down) {
-            key_override_printf("Not activating override: Trigger lifted\n");
-            continue;
-        }
+    // Check mods precisely
+    if (!key_override_matches_active_modifiers(override, active_mods)) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
+    }
 
-        // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
-        const bool no_trigger = override->trigger == KC_NO;
+    // Check if trigger key is down.
+    *trigger_down = is_trigger && key_down;
 
-        // Check if aleady active
-        if (override == active_override) {
-            key_override_printf("Not activating override: Alerady actived\n");
-            continue;
-        }
+    // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
+    // If no trigger key is required, yes.
+    // If the trigger was just pressed, yes.
+    // If the last non-mod key that was pressed down is the trigger key, yes.
+    bool should_activate = no_trigger || *trigger_down || last_key_down == override->trigger;
 
-        // Check if enabled
-        if (override->enabled != NULL && !((*(override->enabled) & 1))) {
-            key_override_printf("Not activating override: Not enabled\n");
-            continue;
-        }
+    if (!should_activate) {
+        key_override_printf("Not activating override. Trigger not down\n");
+        return false;
+    }
 
-        // Check mods precisely
-        if (!key_override_matches_active_modifiers(override, active_mods)) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
-        }
+    return true;
+}
+
+/** Activates the provided override. Returns true if the key action for the event should be sent */
+static bool activate_override(const key_override_t *override, const bool trigger_down, const bool is_mod) {
+    const bool no_trigger = override->trigger == KC_NO;
+
+    key_override_printf("Activating override\n");
 
-        // Check if trigger key is down.
-        const bool trigger_down = is_trigger && key_down;
+    clear_active_override(false);
+
+    active_override                 = override;
+    active_override_trigger_is_down = true;
 
-        // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
-        // If no trigger key is required, yes.
-        // If the trigger was just pressed, yes.
-        // If the last non-mod key that was pressed down is the trigger key, yes.
-        bool should_activate = no_trigger || trigger_down || last_key_down == override->trigger;
+    set_suppressed_override_mods(override->suppressed_mods);
 
-        if (!should_activate) {
-            key_override_printf("Not activating override. Trigger not down\n");
-            continue;
+    if (!trigger_down && !no_trigger) {
+        // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
+        if (IS_KEY(override->trigger)) {
+            del_key(override->trigger);
+        } else {
+            unregister_code(override->trigger);
         }
+    }
 
-        key_override_printf("Activating override\n");
+    const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
 
-        clear_active_override(false);
+    bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
+                                mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
 
-        active_override                 = override;
-        active_override_trigger_is_down = true;
+    // Try firing the custom handler
+    if (override->custom_action != NULL) {
+        register_replacement &= override->custom_action(true, override->context);
+    }
 
-        set_suppressed_override_mods(override->suppressed_mods);
+    if (register_replacement) {
+        const uint8_t override_mods = extract_mod_bits(override->replacement);
+        set_weak_override_mods(override_mods);
 
-        if (!trigger_down && !no_trigger) {
-            // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
-            if (IS_KEY(override->trigger)) {
-                del_key(override->trigger);
+        // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
+        if (is_mod) {
+            key_override_printf("Deferring register replacement key\n");
+            schedule_deferred_register(mod_free_replacement);
+            send_keyboard_report();
+        } else {
+            if (IS_KEY(mod_free_replacement)) {
+                add_key(mod_free_replacement);
             } else {
-                unregister_code(override->trigger);
+                key_override_printf("NOT KEY 2\n");
+                send_keyboard_report();
+                // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
+                wait_ms(10);
+                register_code(mod_free_replacement);
             }
         }
+    } else {
+        // If not registering the replacement key send keyboard report to update the unregistered keys.
+        send_keyboard_report();
+    }
 
-        const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
+    // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
+    return !trigger_down;
+}
+
+#ifdef KEY_OVERRIDE_INDEX_ENABLE
+/** Builds the index of key_overrides by trigger. Overrides are sorted by trigger and then by position, so the overrides of one trigger form a bucket in list order, with the modifier-only (KC_NO) bucket first. */
+static void key_override_lookup_build(void) {
+    key_override_lookup_source     = key_overrides;
+    key_override_lookup_length     = 0;
+    key_override_lookup_no_trigger = 0;
 
-        bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
-                                    mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
+    uint16_t count = 0;
+    while (key_overrides[count] != NULL) {
+        count++;
+    }
+    if (count > KEY_OVERRIDE_INDEX_SIZE) {
+        key_override_printf("KEY_OVERRIDE_INDEX_SIZE too small, scanning all overrides\n");
+        return;
+    }
 
-        // Try firing the custom handler
-        if (override->custom_action != NULL) {
-            register_replacement &= override->custom_action(true, override->context);
+    // Insertion sort, only runs when key_overrides changes
+    for (uint8_t i = 0; i < count; i++) {
+        const uint16_t trigger = key_overrides[i]->trigger;
+        uint8_t        j       = i;
+        while (j > 0 && key_overrides[key_override_lookup[j - 1]]->trigger > trigger) {
+            key_override_lookup[j] = key_override_lookup[j - 1];
+            j--;
+        }
+        key_override_lookup[j] = i;
+        if (trigger == KC_NO) {
+            key_override_lookup_no_trigger++;
         }
+    }
+    key_override_lookup_length = count;
+}
+
+/** Finds the bucket of overrides with the given trigger. */
+static key_override_bucket_t key_override_lookup_find(const uint16_t trigger) {
+    key_override_bucket_t bucket;
+    if (trigger == KC_NO) {
+        // Fast path for the overrides keyed only on modifiers
+        bucket.begin = 0;
+        bucket.end   = key_override_lookup_no_trigger;
+        return bucket;
+    }
 
-        if (register_replacement) {
-            const uint8_t override_mods = extract_mod_bits(override->replacement);
-            set_weak_override_mods(override_mods);
+    uint8_t low  = key_override_lookup_no_trigger;
+    uint8_t high = key_override_lookup_length;
+    while (low < high) {
+        uint8_t mid = low + (high - low) / 2;
+        if (key_overrides[key_override_lookup[mid]]->trigger < trigger) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    bucket.begin = low;
+    while (high < key_override_lookup_length && key_overrides[key_override_lookup[high]]->trigger == trigger) {
+        high++;
+    }
+    bucket.end = high;
+    return bucket;
+}
+#endif
 
-            // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
-            if (is_mod) {
-                key_override_printf("Deferring register replacement key\n");
-                schedule_deferred_register(mod_free_replacement);
-                send_keyboard_report();
-            } else {
-                if (IS_KEY(mod_free_replacement)) {
-                    add_key(mod_free_replacement);
-                } else {
-                    key_override_printf("NOT KEY 2\n");
-                    send_keyboard_report();
-                    // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
-                    wait_ms(10);
-                    register_code(mod_free_replacement);
+/** Iterates through the list of key overrides and tries activating each, until it finds one that activates or reaches the end of overrides. Returns true if the key action for `keycode` should be sent */
+static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
+    if (key_overrides == NULL) {
+        return true;
+    }
+
+    bool trigger_down = false;
+
+#ifdef KEY_OVERRIDE_INDEX_ENABLE
+    if (key_override_lookup_source != key_overrides) {
+        key_override_lookup_build();
+    }
+
+    if (key_override_lookup_length) {
+        // Only overrides triggered by this key, by the last key pressed down or by no key at all can activate. Visit their buckets merged back into list order, so the first override in the list still wins.
+        const key_override_bucket_t empty      = {0, 0};
+        key_override_bucket_t       buckets[3] = {
+            key_override_lookup_find(keycode),
+            last_key_down != keycode ? key_override_lookup_find(last_key_down) : empty,
+            keycode != KC_NO && last_key_down != KC_NO ? key_override_lookup_find(KC_NO) : empty,
+        };
+
+        while (true) {
+            key_override_bucket_t *next = NULL;
+            for (uint8_t b = 0; b < 3; b++) {
+                if (buckets[b].begin < buckets[b].end && (next == NULL || key_override_lookup[buckets[b].begin] < key_override_lookup[next->begin])) {
+                    next = &buckets[b];
                 }
             }
-        } else {
-            // If not registering the replacement key send keyboard report to update the unregistered keys.
-            send_keyboard_report();
+            if (next == NULL) {
+                break;
+            }
+
+            const key_override_t *const override = key_overrides[key_override_lookup[next->begin++]];
+            if (can_activate_override(override, keycode, layer, key_down, is_mod, active_mods, &trigger_down)) {
+                *activated = true;
+                return activate_override(override, trigger_down, is_mod);
+            }
         }
 
-        *activated = true;
+        *activated = false;
+        return true;
+    }
+#endif
+
+    for (uint8_t i = 0;; i++) {
+        const key_override_t *const override = key_overrides[i];
 
-        // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
-        return !trigger_down;
+        // End of array
+        if (override == NULL) {
+            break;
+        }
+
+        if (can_activate_override(override, keycode, layer, key_down, is_mod, active_mods, &trigger_down)) {
+            *activated = true;
+            return activate_override(override, trigger_down, is_mod);
+        }
     }
 
     *activated = false;
@@ -37,6 +37,10 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom_cache.h"
+#endif
+
 #ifdef AUDIO_ENABLE
 #    ifndef GOODBYE_SONG
 #        define GOODBYE_SONG SONG(GOODBYE_SOUND)
@@ -134,6 +138,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
 #endif
     bootloader_jump();
 }
@@ -190,118 +197,183 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
-/* Core keycode function, hands off handling to other functions,
-    then processes internal quantum keycodes, and then processes
-    ACTIONs.                                                      */
-bool process_record_quantum(keyrecord_t *record) {
-    uint16_t keycode = get_record_keycode(record, true);
-
-    // This is how you use actions here
-    // if (keycode == KC_LEAD) {
-    //   action_t action;
-    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
-    //   process_action(record, action);
-    //   return false;
-    // }
-
-#ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled() && record->event.pressed) {
-        velocikey_accelerate();
-    }
+// Adapt the handlers taking const arguments to the table's function type
+#ifdef KEY_OVERRIDE_ENABLE
+static bool process_key_override_handler(uint16_t keycode, keyrecord_t *record) { return process_key_override(keycode, record); }
 #endif
-
-#ifdef WPM_ENABLE
-    if (record->event.pressed) {
-        update_wpm(keycode);
-    }
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+static bool process_rgb_handler(uint16_t keycode, keyrecord_t *record) { return process_rgb(keycode, record); }
 #endif
 
-#ifdef TAP_DANCE_ENABLE
-    preprocess_tap_dance(keycode, record);
-#endif
+typedef bool (*process_record_handler_fn_t)(uint16_t keycode, keyrecord_t *record);
 
-    if (!(
-#if defined(KEY_LOCK_ENABLE)
-            // Must run first to be able to mask key_up events.
-            process_key_lock(&keycode, record) &&
-#endif
+typedef struct {
+    uint16_t                    first;
+    uint16_t                    last;
+    process_record_handler_fn_t handler;
+} process_record_handler_t;
+
+// Handlers that have to see every event, whatever its keycode
+#define PROCESS_RECORD_ALL QK_BASIC, QK_UNICODE_MAX
+
+/* The process_* handlers of the enabled features, in the order they run, with
+ * the keycodes each of them acts on. Events skip the handlers whose range does
+ * not contain their keycode, and any handler returning false ends the chain.
+ * A handler acting on several ranges gets an entry for each. */
+static const process_record_handler_t PROGMEM process_record_handlers[] = {
 #if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
-            // Must run asap to ensure all keypresses are recorded.
-            process_dynamic_macro(keycode, record) &&
+    // Must run asap to ensure all keypresses are recorded.
+    {PROCESS_RECORD_ALL, process_dynamic_macro},
 #endif
 #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
-            process_clicky(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_clicky},
 #endif
 #ifdef HAPTIC_ENABLE
-            process_haptic(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_haptic},
 #endif
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+    {FN_MO13, MACRO15, process_record_via},
 #endif
-            process_record_kb(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_record_kb},
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+    {SQ_ON, SEQUENCER_TRACK_MAX, process_sequencer},
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+    {MIDI_TONE_MIN, MI_BENDU, process_midi},
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+    {AU_ON, AU_TOG, process_audio},
+    {MUV_IN, MUV_DE, process_audio},
 #endif
 #if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
-            process_backlight(keycode, record) &&
+    {BL_ON, BL_BRTG, process_backlight},
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+    {QK_STENO, QK_STENO_MAX, process_steno},
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
-            process_music(keycode, record) &&
+    // Takes over every key while music mode is on
+    {PROCESS_RECORD_ALL, process_music},
 #endif
 #ifdef KEY_OVERRIDE_ENABLE
-            process_key_override(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_key_override_handler},
 #endif
 #ifdef TAP_DANCE_ENABLE
-            process_tap_dance(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_tap_dance},
 #endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
-            process_unicode_common(keycode, record) &&
+#if defined(UCIS_ENABLE)
+    // Takes over every key while a UCIS sequence is typed
+    {PROCESS_RECORD_ALL, process_unicode_common},
+#elif defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE)
+    {UNICODE_MODE_FORWARD, UNICODE_MODE_WINC, process_unicode_common},
+    {QK_UNICODE, QK_UNICODE_MAX, process_unicode_common},
 #endif
 #ifdef LEADER_ENABLE
-            process_leader(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_leader},
 #endif
 #ifdef PRINTING_ENABLE
-            process_printer(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_printer},
 #endif
 #ifdef AUTO_SHIFT_ENABLE
-            process_auto_shift(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_auto_shift},
 #endif
 #ifdef DYNAMIC_TAPPING_TERM_ENABLE
-            process_dynamic_tapping_term(keycode, record) &&
+    {DT_PRNT, DT_DOWN, process_dynamic_tapping_term},
 #endif
 #ifdef TERMINAL_ENABLE
-            process_terminal(keycode, record) &&
+    {PROCESS_RECORD_ALL, process_terminal},
 #endif
 #ifdef SPACE_CADET_ENABLE
-            process_space_cadet(keycode, record) &&
+    // Any other key cancels a pending tap
+    {PROCESS_RECORD_ALL, process_space_cadet},
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+    {MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_TOGGLE_ALT_GUI, process_magic},
+    {MAGIC_SWAP_LCTL_LGUI, MAGIC_EE_HANDS_RIGHT, process_magic},
+    {MAGIC_TOGGLE_GUI, MAGIC_TOGGLE_GUI, process_magic},
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+    {GRAVE_ESC, GRAVE_ESC, process_grave_esc},
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+    {RGB_TOG, RGB_MODE_RGBTEST, process_rgb_handler},
+    {RGB_MODE_TWINKLE, RGB_MODE_TWINKLE, process_rgb_handler},
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+    {JS_BUTTON0, JS_BUTTON_MAX, process_joystick},
 #endif
 #ifdef PROGRAMMABLE_BUTTON_ENABLE
-            process_programmable_button(keycode, record) &&
+    {PROGRAMMABLE_BUTTON_MIN, PROGRAMMABLE_BUTTON_MAX, process_programmable_button},
 #endif
-            true)) {
+};
+
+#ifdef PROCESS_RECORD_STATS_ENABLE
+static process_record_stats_t process_record_stats;
+
+void process_record_get_stats(process_record_stats_t *stats) { *stats = process_record_stats; }
+
+void process_record_stats_reset(void) { process_record_stats = (process_record_stats_t){0}; }
+#endif
+
+/* Core keycode function, hands off handling to other functions,
+    then processes internal quantum keycodes, and then processes
+    ACTIONs.                                                      */
+bool process_record_quantum(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+
+    // This is how you use actions here
+    // if (keycode == KC_LEAD) {
+    //   action_t action;
+    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
+    //   process_action(record, action);
+    //   return false;
+    // }
+
+#ifdef VELOCIKEY_ENABLE
+    if (velocikey_enabled() && record->event.pressed) {
+        velocikey_accelerate();
+    }
+#endif
+
+#ifdef WPM_ENABLE
+    if (record->event.pressed) {
+        update_wpm(keycode);
+    }
+#endif
+
+#if defined(SEND_STRING_ASYNC_ENABLE) && !defined(SEND_STRING_ASYNC_NO_CANCEL)
+    if (record->event.pressed) {
+        send_string_async_cancel();
+    }
+#endif
+
+#ifdef TAP_DANCE_ENABLE
+    preprocess_tap_dance(keycode, record);
+#endif
+
+#if defined(KEY_LOCK_ENABLE)
+    // Must run first to be able to mask key_up events.
+    if (!process_key_lock(&keycode, record)) {
         return false;
     }
+#endif
+
+#ifdef PROCESS_RECORD_STATS_ENABLE
+    process_record_stats.events++;
+#endif
+    for (uint8_t i = 0; i < sizeof(process_record_handlers) / sizeof(process_record_handlers[0]); i++) {
+        const process_record_handler_t *entry = &process_record_handlers[i];
+        if (keycode < pgm_read_word(&entry->first) || keycode > pgm_read_word(&entry->last)) {
+            continue;
+        }
+#ifdef PROCESS_RECORD_STATS_ENABLE
+        process_record_stats.handler_calls++;
+#endif
+        process_record_handler_fn_t handler = (process_record_handler_fn_t)pgm_read_ptr(&entry->handler);
+        if (!handler(keycode, record)) {
+            return false;
+        }
+    }
 
     if (record->event.pressed) {
         switch (keycode) {
@@ -488,6 +560,10 @@ __attribute__((weak)) void suspend_power_down_user(void) {}
 __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user(); }
 
 void suspend_power_down_quantum(void) {
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
+#endif
+
 #ifndef NO_SUSPEND_POWER_DOWN
 // Turn off backlight
 #    ifdef BACKLIGHT_ENABLE
@@ -236,6 +236,16 @@ bool     process_record_user(uint16_t keycode, keyrecord_t *record);
 void     post_process_record_kb(uint16_t keycode, keyrecord_t *record);
 void     post_process_record_user(uint16_t keycode, keyrecord_t *record);
 
+#ifdef PROCESS_RECORD_STATS_ENABLE
+typedef struct {
+    uint32_t events;         // process_record_quantum() calls
+    uint32_t handler_calls;  // process_* handlers those events were dispatched to
+} process_record_stats_t;
+
+void process_record_get_stats(process_record_stats_t *stats);
+void process_record_stats_reset(void);
+#endif
+
 void reset_keyboard(void);
 
 void startup_user(void);
@@ -36,8 +36,8 @@ static bool decrease_heatmap_values;
 
 bool TYPING_HEATMAP(effect_params_t* params) {
     // Modified version of RGB_MATRIX_USE_LIMITS to work off of matrix row / col size
-    uint8_t led_min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;
-    uint8_t led_max = led_min + RGB_MATRIX_LED_PROCESS_LIMIT;
+    uint8_t led_min = RGB_MATRIX_LED_SLICE * params->iter;
+    uint8_t led_max = led_min + RGB_MATRIX_LED_SLICE;
     if (led_max > sizeof(g_rgb_frame_buffer)) led_max = sizeof(g_rgb_frame_buffer);
 
     if (params->init) {
@@ -46,7 +46,7 @@ bool TYPING_HEATMAP(effect_params_t* params) {
     }
 
     // The heatmap animation might run in several iterations depending on
-    // `RGB_MATRIX_LED_PROCESS_LIMIT`, therefore we only want to update the
+    // `RGB_MATRIX_LED_SLICE`, therefore we only want to update the
     // timer when the animation starts.
     if (params->iter == 0) {
         decrease_heatmap_values = timer_elapsed(heatmap_decrease_timer) >= RGB_MATRIX_TYPING_HEATMAP_DECREASE_DELAY_MS;
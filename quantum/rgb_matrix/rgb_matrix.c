@@ -38,7 +38,7 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 
 // ------------------------------------------
 // -----Begin rgb effect includes macros-----
-#define RGB_MATRIX_EFFECT(name)
+#define RGB_MATRIX_EFFECT(name, ...)
 #define RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 #include "rgb_matrix_effects.inc"
@@ -54,6 +54,33 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 // -----End rgb effect includes macros-------
 // ------------------------------------------
 
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+typedef struct {
+    bool is_static;
+} rgb_effect_traits_t;
+
+// ------------------------------------------
+// -----Begin rgb effect traits macros-------
+static const rgb_effect_traits_t rgb_effect_traits[RGB_MATRIX_EFFECT_MAX] = {
+#    define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_##name] = {__VA_ARGS__},
+#    include "rgb_matrix_effects.inc"
+#    undef RGB_MATRIX_EFFECT
+
+#    if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
+#        define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_CUSTOM_##name] = {__VA_ARGS__},
+#        ifdef RGB_MATRIX_CUSTOM_KB
+#            include "rgb_matrix_kb.inc"
+#        endif
+#        ifdef RGB_MATRIX_CUSTOM_USER
+#            include "rgb_matrix_user.inc"
+#        endif
+#        undef RGB_MATRIX_EFFECT
+#    endif
+};
+// -----End rgb effect traits macros---------
+// ------------------------------------------
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+
 #if defined(RGB_DISABLE_AFTER_TIMEOUT) && !defined(RGB_DISABLE_TIMEOUT)
 #    define RGB_DISABLE_TIMEOUT (RGB_DISABLE_AFTER_TIMEOUT * 1200UL)
 #endif
@@ -127,6 +154,34 @@ static rgb_task_states rgb_task_state    = SYNCING;
 #if RGB_DISABLE_TIMEOUT > 0
 static uint32_t rgb_anykey_timer;
 #endif  // RGB_DISABLE_TIMEOUT > 0
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+// What calls to rgb_matrix_set_color() are currently recorded as
+enum { RGB_CAPTURE_NONE, RGB_CAPTURE_EFFECT, RGB_CAPTURE_INDICATORS };
+static uint8_t      rgb_capture = RGB_CAPTURE_NONE;
+static RGB          rgb_effect_frame[DRIVER_LED_TOTAL];  // last colours set by the effect
+static bool         rgb_effect_frame_cached = false;     // the frame of a static effect is complete
+static rgb_config_t rgb_cached_config;
+// Colours set by the indicator callbacks during the current and the previous run, and which LEDs they set
+static RGB     rgb_indicator_frame[2][DRIVER_LED_TOTAL];
+static uint8_t rgb_indicator_mask[2][(DRIVER_LED_TOTAL + 7) / 8];
+static uint8_t rgb_indicator_run = 0;
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+// params->iter is 8 bits wide, slices must stay large enough to cover all LEDs in 256 calls
+#    define RGB_MATRIX_LED_SLICE_MIN ((DRIVER_LED_TOTAL + UINT8_MAX - 1) / UINT8_MAX)
+#    if RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_SLICE_MIN
+uint8_t g_rgb_led_process_limit = RGB_MATRIX_LED_SLICE_MIN;
+#    elif RGB_MATRIX_LED_PROCESS_LIMIT > DRIVER_LED_TOTAL
+uint8_t g_rgb_led_process_limit = DRIVER_LED_TOTAL;
+#    else
+uint8_t g_rgb_led_process_limit = RGB_MATRIX_LED_PROCESS_LIMIT;
+#    endif
+static uint32_t rgb_frame_max_slice_us  = 0;
+static uint32_t rgb_render_max_slice_us = 0;
+static uint16_t rgb_frame_count         = 0;
+static uint16_t rgb_frames_per_second   = 0;
+static uint32_t rgb_frame_count_timer   = 0;
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
 
 // double buffers
 static uint32_t rgb_timer_buffer;
@@ -178,9 +233,34 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+static void rgb_capture_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index < 0 || index >= DRIVER_LED_TOTAL) return;
+    switch (rgb_capture) {
+        case RGB_CAPTURE_EFFECT:
+            rgb_effect_frame[index] = (RGB){red, green, blue};
+            break;
+        case RGB_CAPTURE_INDICATORS:
+            rgb_indicator_frame[rgb_indicator_run][index] = (RGB){red, green, blue};
+            rgb_indicator_mask[rgb_indicator_run][index / 8] |= 1 << (index % 8);
+            break;
+    }
+}
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+    rgb_capture_color(index, red, green, blue);
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+    rgb_matrix_driver.set_color(index, red, green, blue);
+}
 
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+    if (rgb_capture != RGB_CAPTURE_NONE) {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_capture_color(i, red, green, blue);
+    }
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_matrix_set_color(i, red, green, blue);
 #else
@@ -303,7 +383,83 @@ static void rgb_task_sync(void) {
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
 }
 
-static void rgb_task_start(void) {
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+#    ifdef PROTOCOL_CHIBIOS
+// Only ChibiOS has a default, other platforms need the keyboard to provide one.
+__attribute__((weak)) uint32_t rgb_matrix_render_timestamp(void) { return timer_read_us32(); }
+#    endif
+
+// Sizes the slices of the next frame from the slowest render call of the previous one.
+// Slices shrink in proportion to the overrun, and grow slowly while well within the budget.
+static void rgb_task_adapt_slice(void) {
+    uint32_t limit = g_rgb_led_process_limit;
+    if (rgb_frame_max_slice_us > RGB_MATRIX_RENDER_BUDGET_US) {
+        limit = limit * RGB_MATRIX_RENDER_BUDGET_US / rgb_frame_max_slice_us;
+    } else if (rgb_frame_max_slice_us < RGB_MATRIX_RENDER_BUDGET_US * 3 / 4) {
+        limit += limit / 8 + 1;
+    }
+    if (limit < RGB_MATRIX_LED_SLICE_MIN) limit = RGB_MATRIX_LED_SLICE_MIN;
+    if (limit > DRIVER_LED_TOTAL) limit = DRIVER_LED_TOTAL;
+    g_rgb_led_process_limit = limit;
+    rgb_frame_max_slice_us  = 0;
+}
+
+void rgb_matrix_get_render_stats(rgb_matrix_render_stats_t *stats) {
+    stats->frames_per_second = rgb_frames_per_second;
+    stats->max_slice_us      = rgb_render_max_slice_us;
+    stats->led_process_limit = g_rgb_led_process_limit;
+}
+
+void rgb_matrix_reset_render_stats(void) {
+    rgb_render_max_slice_us = 0;
+    rgb_frames_per_second   = 0;
+    rgb_frame_count         = 0;
+    rgb_frame_count_timer   = sync_timer_read32();
+}
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
+
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+#    define RGB_TASK_CAPTURE(what) rgb_capture = (what)
+
+static void rgb_task_next_indicator_run(void) {
+    rgb_indicator_run ^= 1;
+    memset(rgb_indicator_mask[rgb_indicator_run], 0, sizeof(rgb_indicator_mask[0]));
+}
+
+static inline bool rgb_indicator_was_set(uint8_t run, uint8_t index) { return rgb_indicator_mask[run][index / 8] & (1 << (index % 8)); }
+
+// Runs the indicator callbacks over the cached frame of a static effect, and flushes only if
+// their output differs from the previous run. LEDs the indicators no longer set get their effect colour back.
+static void rgb_task_update_indicators(void) {
+    uint8_t last = rgb_indicator_run;
+    rgb_task_next_indicator_run();
+
+    RGB_TASK_CAPTURE(RGB_CAPTURE_INDICATORS);
+    rgb_matrix_indicators();
+    rgb_matrix_indicators_advanced_kb(0, DRIVER_LED_TOTAL);
+    rgb_matrix_indicators_advanced_user(0, DRIVER_LED_TOTAL);
+    RGB_TASK_CAPTURE(RGB_CAPTURE_NONE);
+
+    bool changed = false;
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        if (rgb_indicator_was_set(rgb_indicator_run, i)) {
+            if (!rgb_indicator_was_set(last, i) || memcmp(&rgb_indicator_frame[last][i], &rgb_indicator_frame[rgb_indicator_run][i], sizeof(RGB)) != 0) {
+                changed = true;
+            }
+        } else if (rgb_indicator_was_set(last, i)) {
+            rgb_matrix_set_color(i, rgb_effect_frame[i].r, rgb_effect_frame[i].g, rgb_effect_frame[i].b);
+            changed = true;
+        }
+    }
+    if (changed) {
+        rgb_matrix_update_pwm_buffers();
+    }
+}
+#else
+#    define RGB_TASK_CAPTURE(what)
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+
+static void rgb_task_start(uint8_t effect) {
     // reset iter
     rgb_effect_params.iter = 0;
 
@@ -313,6 +469,21 @@ static void rgb_task_start(void) {
     g_last_hit_tracker = last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+    // a static effect would render the same frame again, skip straight to the indicators
+    if (rgb_effect_frame_cached && effect == rgb_last_effect && rgb_matrix_config.enable == rgb_last_enable && memcmp(&rgb_cached_config, &rgb_matrix_config, sizeof(rgb_config_t)) == 0) {
+        rgb_task_update_indicators();
+        rgb_task_state = SYNCING;
+        return;
+    }
+    rgb_effect_frame_cached = false;
+    rgb_cached_config       = rgb_matrix_config;
+    rgb_task_next_indicator_run();
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+    rgb_task_adapt_slice();
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
+
     // next task
     rgb_task_state = RENDERING;
 }
@@ -385,6 +556,21 @@ static void rgb_task_flush(uint8_t effect) {
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
 
+#ifdef RGB_MATRIX_STATIC_EFFECT_CACHE
+    // rgb_cached_config holds the config the frame was started with
+    rgb_effect_frame_cached = effect < RGB_MATRIX_EFFECT_MAX && rgb_effect_traits[effect].is_static;
+#endif  // RGB_MATRIX_STATIC_EFFECT_CACHE
+
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+    rgb_frame_count++;
+    uint32_t elapsed = sync_timer_elapsed32(rgb_frame_count_timer);
+    if (elapsed >= 1000) {
+        rgb_frames_per_second = (uint32_t)rgb_frame_count * 1000 / elapsed;
+        rgb_frame_count       = 0;
+        rgb_frame_count_timer = sync_timer_read32();
+    }
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
+
     // next task
     rgb_task_state = SYNCING;
 }
@@ -404,15 +590,26 @@ void rgb_matrix_task(void) {
 
     switch (rgb_task_state) {
         case STARTING:
-            rgb_task_start();
+            rgb_task_start(effect);
             break;
-        case RENDERING:
+        case RENDERING: {
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+            uint32_t slice_start = rgb_matrix_render_timestamp();
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
+            RGB_TASK_CAPTURE(RGB_CAPTURE_EFFECT);
             rgb_task_render(effect);
             if (effect) {
+                RGB_TASK_CAPTURE(RGB_CAPTURE_INDICATORS);
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
-            break;
+            RGB_TASK_CAPTURE(RGB_CAPTURE_NONE);
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+            uint32_t slice_us = rgb_matrix_render_timestamp() - slice_start;
+            if (slice_us > rgb_frame_max_slice_us) rgb_frame_max_slice_us = slice_us;
+            if (slice_us > rgb_render_max_slice_us) rgb_render_max_slice_us = slice_us;
+#endif  // RGB_MATRIX_RENDER_BUDGET_US > 0
+        } break;
         case FLUSHING:
             rgb_task_flush(effect);
             break;
@@ -437,9 +634,9 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
-    uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
-    uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
+#if defined(RGB_MATRIX_LED_SLICING)
+    uint8_t min = RGB_MATRIX_LED_SLICE * (params->iter - 1);
+    uint8_t max = min + RGB_MATRIX_LED_SLICE;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
@@ -456,6 +653,10 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifdef RGB_MATRIX_GEOMETRY_TABLES
+    rgb_matrix_geometry_init();
+#endif
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
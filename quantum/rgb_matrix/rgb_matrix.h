@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "rgb_matrix_types.h"
+#include "rgb_matrix_geometry.h"
 #include "color.h"
 #include "quantum.h"
 
@@ -48,19 +49,32 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+// Number of LEDs an effect renders per call. With a render budget, it is adapted between frames
+// so that each call takes about RGB_MATRIX_RENDER_BUDGET_US.
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+extern uint8_t g_rgb_led_process_limit;
+#    define RGB_MATRIX_LED_SLICE g_rgb_led_process_limit
+#    define RGB_MATRIX_LED_SLICING
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#    define RGB_MATRIX_LED_SLICE RGB_MATRIX_LED_PROCESS_LIMIT
+#    define RGB_MATRIX_LED_SLICING
+#else
+#    define RGB_MATRIX_LED_SLICE RGB_MATRIX_LED_PROCESS_LIMIT
+#endif
+
+#if defined(RGB_MATRIX_LED_SLICING)
 #    if defined(RGB_MATRIX_SPLIT)
 #        define RGB_MATRIX_USE_LIMITS(min, max)                                                   \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;                            \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;                                     \
+            uint8_t min = RGB_MATRIX_LED_SLICE * params->iter;                                    \
+            uint8_t max = min + RGB_MATRIX_LED_SLICE;                                             \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;                                   \
             uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;                                     \
             if (is_keyboard_left() && (max > k_rgb_matrix_split[0])) max = k_rgb_matrix_split[0]; \
             if (!(is_keyboard_left()) && (min < k_rgb_matrix_split[0])) min = k_rgb_matrix_split[0];
 #    else
-#        define RGB_MATRIX_USE_LIMITS(min, max)                        \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
+#        define RGB_MATRIX_USE_LIMITS(min, max)                \
+            uint8_t min = RGB_MATRIX_LED_SLICE * params->iter; \
+            uint8_t max = min + RGB_MATRIX_LED_SLICE;          \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #    endif
 #else
@@ -86,6 +100,10 @@
 #define RGB_MATRIX_TEST_LED_FLAGS() \
     if (!HAS_ANY_FLAGS(g_led_config.flags[i], params->flags)) continue
 
+// Optional second argument of RGB_MATRIX_EFFECT(), for effects whose output only depends on
+// rgb_matrix_config and the LED flags. See RGB_MATRIX_STATIC_EFFECT_CACHE.
+#define RGB_MATRIX_EFFECT_STATIC .is_static = true
+
 enum rgb_matrix_effects {
     RGB_MATRIX_NONE = 0,
 
@@ -180,6 +198,20 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 
+#if defined(RGB_MATRIX_RENDER_BUDGET_US) && RGB_MATRIX_RENDER_BUDGET_US > 0
+typedef struct {
+    uint16_t frames_per_second;  // frames flushed during the last full second
+    uint32_t max_slice_us;       // longest single render call since the last reset
+    uint8_t  led_process_limit;  // LEDs currently rendered per call
+} rgb_matrix_render_stats_t;
+
+void rgb_matrix_get_render_stats(rgb_matrix_render_stats_t *stats);
+void rgb_matrix_reset_render_stats(void);
+// Time source for the render budget in microseconds. Defaults to the system tick on ChibiOS,
+// and must be provided by the keyboard on other platforms.
+uint32_t rgb_matrix_render_timestamp(void);
+#endif
+
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
 #    define rgblight_toggle rgb_matrix_toggle
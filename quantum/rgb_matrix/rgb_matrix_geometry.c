@@ -0,0 +1,34 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "rgb_matrix_types.h"
+#include "rgb_matrix_geometry.h"
+#include <lib/lib8tion/lib8tion.h>
+
+#ifdef RGB_MATRIX_GEOMETRY_TABLES
+
+extern led_config_t      g_led_config;
+extern const led_point_t k_rgb_matrix_center;
+
+uint8_t g_led_center_dist[DRIVER_LED_TOTAL];
+uint8_t g_led_center_angle[DRIVER_LED_TOTAL];
+uint8_t g_led_distance[DRIVER_LED_TOTAL * (DRIVER_LED_TOTAL - 1) / 2];
+
+void rgb_matrix_geometry_init(void) {
+    uint8_t *distance = g_led_distance;
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx            = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy            = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        g_led_center_dist[i]  = sqrt16(dx * dx + dy * dy);
+        g_led_center_angle[i] = atan2_8(dy, dx);
+
+        // row i of the lower triangle, in the order rgb_matrix_led_distance() looks it up
+        for (uint8_t j = 0; j < i; j++) {
+            dx          = g_led_config.point[i].x - g_led_config.point[j].x;
+            dy          = g_led_config.point[i].y - g_led_config.point[j].y;
+            *distance++ = sqrt16(dx * dx + dy * dy);
+        }
+    }
+}
+
+#endif
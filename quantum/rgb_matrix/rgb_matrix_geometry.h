@@ -0,0 +1,33 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef RGB_MATRIX_GEOMETRY_TABLES
+
+// Distance and angle of every LED from k_rgb_matrix_center, as sqrt16() and atan2_8() give them.
+extern uint8_t g_led_center_dist[DRIVER_LED_TOTAL];
+extern uint8_t g_led_center_angle[DRIVER_LED_TOTAL];
+
+// Distance between every pair of LEDs, only the lower triangle is stored.
+extern uint8_t g_led_distance[DRIVER_LED_TOTAL * (DRIVER_LED_TOTAL - 1) / 2];
+
+// Fills the tables from g_led_config. Called by rgb_matrix_init(), call it again after changing g_led_config.points at runtime.
+void rgb_matrix_geometry_init(void);
+
+// Distance between two LEDs, equal to sqrt16(dx * dx + dy * dy) of their points.
+static inline uint8_t rgb_matrix_led_distance(uint8_t a, uint8_t b) {
+    if (a == b) {
+        return 0;
+    }
+    if (a < b) {
+        uint8_t t = a;
+        a         = b;
+        b         = t;
+    }
+    return g_led_distance[(uint16_t)a * (a - 1) / 2 + b];
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "rgb_matrix_types.h"
+#include "rgb_matrix_geometry.h"
+#include "lib/lib8tion/lib8tion.h"
+
+led_config_t             g_led_config;
+extern const led_point_t k_rgb_matrix_center = {112, 32};
+}
+
+#define HITS 8
+
+class RgbMatrixGeometryTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        /* A grid of keys, like a full size board */
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            g_led_config.point[i] = {(uint8_t)(i % MATRIX_COLS * 224 / (MATRIX_COLS - 1)), (uint8_t)(i / MATRIX_COLS * 64 / (MATRIX_ROWS - 1))};
+        }
+        rgb_matrix_geometry_init();
+    }
+};
+
+TEST_F(RgbMatrixGeometryTest, TablesMatchDirectComputation) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        EXPECT_EQ(g_led_center_dist[i], sqrt16(dx * dx + dy * dy)) << "LED " << (int)i;
+        EXPECT_EQ(g_led_center_angle[i], atan2_8(dy, dx)) << "LED " << (int)i;
+
+        for (uint8_t j = 0; j < DRIVER_LED_TOTAL; j++) {
+            dx = g_led_config.point[i].x - g_led_config.point[j].x;
+            dy = g_led_config.point[i].y - g_led_config.point[j].y;
+            ASSERT_EQ(rgb_matrix_led_distance(i, j), sqrt16(dx * dx + dy * dy)) << "LEDs " << (int)i << ", " << (int)j;
+        }
+    }
+}
+
+TEST_F(RgbMatrixGeometryTest, TablesFollowLayoutChanges) {
+    g_led_config.point[5] = {0, 0};
+    g_led_config.point[9] = {30, 40};
+    rgb_matrix_geometry_init();
+    EXPECT_EQ(rgb_matrix_led_distance(5, 9), 50);
+    EXPECT_EQ(rgb_matrix_led_distance(9, 5), 50);
+    EXPECT_EQ(g_led_center_dist[5], sqrt16(112 * 112 + 32 * 32));
+}
+
+/* Distance work of one frame of a multi splash effect with every hit tracked, computed against looked up */
+TEST_F(RgbMatrixGeometryTest, Benchmark) {
+    uint8_t hit_index[HITS];
+    for (uint8_t j = 0; j < HITS; j++) {
+        hit_index[j] = j * 13 % DRIVER_LED_TOTAL;
+    }
+
+    const int         frames = 2000;
+    volatile uint32_t sink   = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            for (uint8_t j = 0; j < HITS; j++) {
+                int16_t dx = g_led_config.point[i].x - g_led_config.point[hit_index[j]].x;
+                int16_t dy = g_led_config.point[i].y - g_led_config.point[hit_index[j]].y;
+                sum += sqrt16(dx * dx + dy * dy);
+            }
+        }
+        sink = sink + sum;
+    }
+    double computed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            for (uint8_t j = 0; j < HITS; j++) {
+                sum += rgb_matrix_led_distance(i, hit_index[j]);
+            }
+        }
+        sink = sink + sum;
+    }
+    double looked_up = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    /* Only logged, wall-clock times vary too much between hosts to assert on */
+    std::cout << DRIVER_LED_TOTAL << " LEDs, " << HITS << " hits, ns per frame: sqrt16 " << computed << ", table " << looked_up << std::endl;
+    RecordProperty("sqrt16_ns_per_frame", (int)computed);
+    RecordProperty("distance_table_ns_per_frame", (int)looked_up);
+}
@@ -0,0 +1,8 @@
+rgb_matrix_geometry_DEFS := -DRGB_MATRIX_GEOMETRY_TABLES -DDRIVER_LED_TOTAL=120 -DMATRIX_ROWS=6 -DMATRIX_COLS=20
+
+rgb_matrix_geometry_INC := \
+	$(QUANTUM_PATH)/rgb_matrix
+
+rgb_matrix_geometry_SRC := \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_geometry_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix/rgb_matrix_geometry.c
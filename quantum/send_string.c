@@ -312,3 +312,203 @@ void tap_random_base64(void) {
             break;
     }
 }
+
+#ifdef SEND_STRING_ASYNC_ENABLE
+
+#    ifndef SEND_STRING_ASYNC_BUFFER_SIZE
+#        define SEND_STRING_ASYNC_BUFFER_SIZE 128
+#    endif
+
+// Time between two key presses or releases
+#    ifndef SEND_STRING_ASYNC_INTERVAL
+#        if TAP_CODE_DELAY > 0
+#            define SEND_STRING_ASYNC_INTERVAL TAP_CODE_DELAY
+#        else
+#            define SEND_STRING_ASYNC_INTERVAL 1
+#        endif
+#    endif
+
+// Keys the playback can hold down at once through SS_DOWN()
+#    ifndef SEND_STRING_ASYNC_MAX_HELD
+#        define SEND_STRING_ASYNC_MAX_HELD 8
+#    endif
+
+typedef struct {
+    uint8_t keycode;
+    bool    pressed;
+} async_step_t;
+
+static char           async_buffer[SEND_STRING_ASYNC_BUFFER_SIZE];
+static uint16_t       async_head  = 0;
+static uint16_t       async_count = 0;
+static async_step_t   async_steps[8];  // transitions of the character being played: shift, altgr, key, and a dead key space
+static uint8_t        async_step_count = 0;
+static uint8_t        async_step_index = 0;
+static uint8_t        async_held[SEND_STRING_ASYNC_MAX_HELD];
+static uint8_t        async_held_count = 0;
+static deferred_token async_token      = INVALID_DEFERRED_TOKEN;
+
+// Returns 0 once the buffer is empty, so a truncated code is read as no key
+static char async_pop(void) {
+    if (!async_count) {
+        return 0;
+    }
+    char c     = async_buffer[async_head];
+    async_head = (async_head + 1) % SEND_STRING_ASYNC_BUFFER_SIZE;
+    async_count--;
+    return c;
+}
+
+static void async_add_step(uint8_t keycode, bool pressed) {
+    if (keycode != KC_NO && async_step_count < sizeof(async_steps) / sizeof(async_steps[0])) {
+        async_steps[async_step_count++] = (async_step_t){.keycode = keycode, .pressed = pressed};
+    }
+}
+
+static void async_add_char(char ascii_code) {
+    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
+    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
+    bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
+    bool    is_dead    = PGM_LOADBIT(ascii_to_dead_lut, (uint8_t)ascii_code);
+
+    if (keycode == KC_NO) {
+        return;
+    }
+    if (is_shifted) {
+        async_add_step(KC_LSFT, true);
+    }
+    if (is_altgred) {
+        async_add_step(KC_RALT, true);
+    }
+    async_add_step(keycode, true);
+    async_add_step(keycode, false);
+    if (is_altgred) {
+        async_add_step(KC_RALT, false);
+    }
+    if (is_shifted) {
+        async_add_step(KC_LSFT, false);
+    }
+    if (is_dead) {
+        async_add_step(KC_SPACE, true);
+        async_add_step(KC_SPACE, false);
+    }
+}
+
+// Decodes queued characters until there are transitions to play.
+//  -- Return value: milliseconds to wait first if a delay code was read, otherwise 0
+static uint32_t async_load_steps(void) {
+    async_step_count = 0;
+    async_step_index = 0;
+    while (async_count && !async_step_count) {
+        char ascii_code = async_pop();
+        if (ascii_code != SS_QMK_PREFIX) {
+            async_add_char(ascii_code);
+            continue;
+        }
+        switch (async_pop()) {
+            case SS_TAP_CODE: {
+                uint8_t keycode = async_pop();
+                async_add_step(keycode, true);
+                async_add_step(keycode, false);
+                break;
+            }
+            case SS_DOWN_CODE:
+                async_add_step(async_pop(), true);
+                break;
+            case SS_UP_CODE:
+                async_add_step(async_pop(), false);
+                break;
+            case SS_DELAY_CODE: {
+                // digits, then a terminator
+                uint32_t ms      = 0;
+                char     keycode = async_pop();
+                while (isdigit(keycode) && async_count) {
+                    ms      = ms * 10 + keycode - '0';
+                    keycode = async_pop();
+                }
+                if (ms) {
+                    return ms;
+                }
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+static void async_hold(uint8_t keycode, bool pressed) {
+    for (uint8_t i = 0; i < async_held_count; i++) {
+        if (async_held[i] == keycode) {
+            if (!pressed) {
+                async_held[i] = async_held[--async_held_count];
+            }
+            return;
+        }
+    }
+    if (pressed && async_held_count < SEND_STRING_ASYNC_MAX_HELD) {
+        async_held[async_held_count++] = keycode;
+    }
+}
+
+static uint32_t send_string_async_tick(uint32_t trigger_time, void *cb_arg) {
+    if (async_step_index == async_step_count) {
+        uint32_t delay = async_load_steps();
+        if (delay) {
+            return delay;
+        }
+        if (!async_step_count) {
+            async_token = INVALID_DEFERRED_TOKEN;
+            return 0;
+        }
+    }
+
+    async_step_t step = async_steps[async_step_index++];
+    if (step.pressed) {
+        register_code(step.keycode);
+    } else {
+        unregister_code(step.keycode);
+    }
+    async_hold(step.keycode, step.pressed);
+    return SEND_STRING_ASYNC_INTERVAL;
+}
+
+static bool send_string_async_enqueue(const char *str, uint16_t length, bool progmem) {
+    if (length > SEND_STRING_ASYNC_BUFFER_SIZE - async_count) {
+        return false;
+    }
+    if (async_token == INVALID_DEFERRED_TOKEN) {
+        async_token = defer_exec(SEND_STRING_ASYNC_INTERVAL, send_string_async_tick, NULL);
+        if (async_token == INVALID_DEFERRED_TOKEN) {
+            return false;
+        }
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        async_buffer[(async_head + async_count) % SEND_STRING_ASYNC_BUFFER_SIZE] = progmem ? pgm_read_byte(str + i) : str[i];
+        async_count++;
+    }
+    return true;
+}
+
+bool send_string_async(const char *str) { return send_string_async_enqueue(str, strlen(str), false); }
+
+bool send_string_async_P(const char *str) { return send_string_async_enqueue(str, strlen_P(str), true); }
+
+bool send_string_async_active(void) { return async_token != INVALID_DEFERRED_TOKEN; }
+
+uint16_t send_string_async_free(void) { return SEND_STRING_ASYNC_BUFFER_SIZE - async_count; }
+
+void send_string_async_cancel(void) {
+    if (async_token == INVALID_DEFERRED_TOKEN) {
+        return;
+    }
+    cancel_deferred_exec(async_token);
+    async_token      = INVALID_DEFERRED_TOKEN;
+    async_count      = 0;
+    async_step_count = 0;
+    async_step_index = 0;
+    while (async_held_count) {
+        unregister_code(async_held[--async_held_count]);
+    }
+}
+
+#endif
@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "progmem.h"
@@ -52,3 +53,22 @@ void send_byte(uint8_t number);
 void send_nibble(uint8_t number);
 
 void tap_random_base64(void);
+
+#ifdef SEND_STRING_ASYNC_ENABLE
+#    define SEND_STRING_ASYNC(string) send_string_async_P(PSTR(string))
+
+// Queues a string for playback from the main loop, one key press or release at a time.
+// Takes the same characters and SS_* codes as send_string().
+//  -- Return value: false if the string does not fit into the buffer, in which case nothing was queued
+bool send_string_async(const char *str);
+bool send_string_async_P(const char *str);
+
+// Whether queued keystrokes are still being played back.
+bool send_string_async_active(void);
+
+// Bytes left in the playback buffer.
+uint16_t send_string_async_free(void);
+
+// Drops everything that is queued and releases the keys the playback holds down.
+void send_string_async_cancel(void);
+#endif
@@ -0,0 +1,32 @@
+SPLIT_TRANSACTIONS_COMMON_DEFS := -DSPLIT_KEYBOARD -DWPM_ENABLE -DNO_PRINT -DNO_DEBUG -DIGNORE_ATOMIC_BLOCK \
+	-include $(QUANTUM_PATH)/split_common/tests/config.h
+
+SPLIT_TRANSACTIONS_COMMON_INC := \
+	$(QUANTUM_PATH)/split_common \
+	$(QUANTUM_PATH)/split_common/tests
+
+SPLIT_TRANSACTIONS_COMMON_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_transactions_tests.cpp \
+	$(QUANTUM_PATH)/split_common/tests/transport_loopback.c \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(QUANTUM_PATH)/crc.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+split_transactions_DEFS := $(SPLIT_TRANSACTIONS_COMMON_DEFS)
+split_transactions_INC := $(SPLIT_TRANSACTIONS_COMMON_INC)
+split_transactions_SRC := $(SPLIT_TRANSACTIONS_COMMON_SRC)
+
+split_state_frame_DEFS := $(SPLIT_TRANSACTIONS_COMMON_DEFS) -DSPLIT_STATE_FRAME_ENABLE
+split_state_frame_INC := $(SPLIT_TRANSACTIONS_COMMON_INC)
+split_state_frame_SRC := $(SPLIT_TRANSACTIONS_COMMON_SRC)
+
+split_transport_stats_DEFS := $(SPLIT_TRANSACTIONS_COMMON_DEFS) -DSPLIT_TRANSPORT_STATS_ENABLE
+split_transport_stats_INC := $(SPLIT_TRANSACTIONS_COMMON_INC)
+split_transport_stats_SRC := $(SPLIT_TRANSACTIONS_COMMON_SRC) \
+	$(QUANTUM_PATH)/split_common/transport_stats.c \
+	$(QUANTUM_PATH)/bitwise.c
+
+split_pointing_DEFS := $(SPLIT_TRANSACTIONS_COMMON_DEFS) -DSPLIT_TRANSPORT_STATS_ENABLE \
+	-DPOINTING_DEVICE_ENABLE -DSPLIT_POINTING_ENABLE -DPOINTING_DEVICE_COMBINED
+split_pointing_INC := $(SPLIT_TRANSACTIONS_COMMON_INC)
+split_pointing_SRC := $(split_transport_stats_SRC)
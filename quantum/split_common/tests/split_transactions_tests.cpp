@@ -0,0 +1,601 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "quantum.h"
+#include "transport.h"
+#include "transport_loopback.h"
+#include "transport_stats.h"
+// C11 spelling of static_assert in the transaction IDs
+#define _Static_assert static_assert
+#include "transaction_id_define.h"
+#undef _Static_assert
+
+bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+#define ROWS_PER_HAND ((MATRIX_ROWS) / 2)
+
+#ifndef FORCED_SYNC_THROTTLE_MS
+#    define FORCED_SYNC_THROTTLE_MS 100
+#endif
+
+/* State normally owned by other modules; swapped per half while it runs */
+extern "C" {
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+static uint8_t real_mods, weak_mods, oneshot_mods, current_wpm;
+
+uint8_t get_mods(void) { return real_mods; }
+void    set_mods(uint8_t mods) { real_mods = mods; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void    set_weak_mods(uint8_t mods) { weak_mods = mods; }
+uint8_t get_oneshot_mods(void) { return oneshot_mods; }
+void    set_oneshot_mods(uint8_t mods) { oneshot_mods = mods; }
+uint8_t get_current_wpm(void) { return current_wpm; }
+void    set_current_wpm(uint8_t wpm) { current_wpm = wpm; }
+}
+
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+/* The slave's sensor, and what reached the pointing device of the master */
+static pointing_device_shared_t slave_pointing;
+static int64_t                  received_x, received_y, received_v, received_h;
+static uint8_t                  received_buttons;
+static uint16_t                 master_shared_cpi, slave_cpi;
+static uint32_t                 slave_cpi_updates;
+
+extern "C" {
+bool is_keyboard_left(void) { return false; }
+
+void pointing_device_get_shared_motion(pointing_device_shared_t *totals) { *totals = slave_pointing; }
+
+void pointing_device_add_shared_motion(int32_t x, int32_t y, int32_t v, int32_t h, uint8_t buttons) {
+    received_x += x;
+    received_y += y;
+    received_v += v;
+    received_h += h;
+    received_buttons = buttons;
+}
+
+uint16_t pointing_device_get_shared_cpi(void) { return master_shared_cpi; }
+
+void pointing_device_set_cpi_on_side(bool left, uint16_t cpi) {
+    slave_cpi = cpi;
+    slave_cpi_updates++;
+}
+}
+
+static void move(int32_t x, int32_t y, int32_t v = 0, int32_t h = 0) {
+    slave_pointing.x += x;
+    slave_pointing.y += y;
+    slave_pointing.v += v;
+    slave_pointing.h += h;
+}
+#endif
+
+struct HalfState {
+    layer_state_t layer_state;
+    layer_state_t default_layer_state;
+    uint8_t       real_mods;
+    uint8_t       weak_mods;
+    uint8_t       oneshot_mods;
+    uint8_t       current_wpm;
+
+    void load() const {
+        ::layer_state         = layer_state;
+        ::default_layer_state = default_layer_state;
+        ::real_mods           = real_mods;
+        ::weak_mods           = weak_mods;
+        ::oneshot_mods        = oneshot_mods;
+        ::current_wpm         = current_wpm;
+    }
+
+    void save() {
+        layer_state         = ::layer_state;
+        default_layer_state = ::default_layer_state;
+        real_mods           = ::real_mods;
+        weak_mods           = ::weak_mods;
+        oneshot_mods        = ::oneshot_mods;
+        current_wpm         = ::current_wpm;
+    }
+};
+
+class SplitTransactions : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        transport_loopback_reset();
+        split_transport_stats_reset();
+        memset(slave_matrix_, 0, sizeof(slave_matrix_));
+        memset(received_, 0, sizeof(received_));
+        master_ = {};
+        slave_  = {};
+        set_time(10000);
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+        // The running totals carry on from the previous test, only what arrives from here on counts
+        slave_pointing.buttons = 0;
+        master_shared_cpi      = 0;
+#endif
+        settle();
+        split_transport_stats_reset();
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+        received_x = received_y = received_v = received_h = 0;
+        slave_cpi_updates                                  = 0;
+#endif
+    }
+
+    void run_slave() {
+        matrix_row_t master_matrix[ROWS_PER_HAND] = {0};
+        slave_.load();
+        transport_loopback_run_slave(master_matrix, slave_matrix_);
+        slave_.save();
+    }
+
+    bool run_master() {
+        matrix_row_t master_matrix[ROWS_PER_HAND] = {0};
+        master_.load();
+        bool okay = transactions_master(master_matrix, received_);
+        master_.save();
+        return okay;
+    }
+
+    void scan() {
+        advance_time(1);
+        run_slave();
+        run_master();
+    }
+
+    void settle() {
+        for (int i = 0; i < 3; i++) {
+            scan();
+        }
+    }
+
+    bool matrix_in_sync() { return memcmp(slave_matrix_, received_, sizeof(received_)) == 0; }
+
+    matrix_row_t slave_matrix_[ROWS_PER_HAND];
+    matrix_row_t received_[ROWS_PER_HAND];
+    HalfState    master_;
+    HalfState    slave_;
+};
+
+TEST_F(SplitTransactions, SlaveMatrixReachesMaster) {
+    slave_matrix_[2] = 0x05;
+    settle();
+    EXPECT_TRUE(matrix_in_sync());
+
+    slave_matrix_[2] = 0;
+    slave_matrix_[3] = 0x21;
+    settle();
+    EXPECT_TRUE(matrix_in_sync());
+}
+
+TEST_F(SplitTransactions, MasterStateReachesSlave) {
+    master_.layer_state         = 1 << 3;
+    master_.default_layer_state = 1 << 1;
+    master_.real_mods           = 0x02;
+    master_.oneshot_mods        = 0x10;
+    master_.current_wpm         = 87;
+    settle();
+
+    EXPECT_EQ(slave_.layer_state, master_.layer_state);
+    EXPECT_EQ(slave_.default_layer_state, master_.default_layer_state);
+    EXPECT_EQ(slave_.real_mods, master_.real_mods);
+    EXPECT_EQ(slave_.weak_mods, master_.weak_mods);
+    EXPECT_EQ(slave_.oneshot_mods, master_.oneshot_mods);
+    EXPECT_EQ(slave_.current_wpm, master_.current_wpm);
+}
+
+TEST_F(SplitTransactions, RecoversAfterDisconnect) {
+    transport_loopback_set_connected(false);
+    slave_matrix_[0]    = 0x3F;
+    master_.layer_state = 1 << 2;
+    for (int i = 0; i < 5; i++) {
+        scan();
+    }
+    EXPECT_FALSE(matrix_in_sync());
+
+    transport_loopback_set_connected(true);
+    settle();
+    EXPECT_TRUE(matrix_in_sync());
+    EXPECT_EQ(slave_.layer_state, master_.layer_state);
+}
+
+#ifdef SPLIT_STATE_FRAME_ENABLE
+
+TEST_F(SplitTransactions, AtMostTwoTransactionsPerScan) {
+    for (int i = 0; i < 10; i++) {
+        transport_loopback_clear_counters();
+        slave_matrix_[i % ROWS_PER_HAND] ^= 1;
+        master_.layer_state ^= 1 << (i % 8);
+        master_.current_wpm++;
+        scan();
+        EXPECT_LE(transport_loopback_get_transactions(), 2u);
+    }
+
+    // The slave frame is only fetched when its checksum changed
+    settle();
+    transport_loopback_clear_counters();
+    scan();
+    EXPECT_EQ(transport_loopback_get_transactions(), 1u);
+}
+
+TEST_F(SplitTransactions, FramesOnlyCarryChangedSections) {
+    // Once acknowledged, an idle master frame is only the header, and only the slave checksum is read back
+    transport_loopback_clear_counters();
+    scan();
+    EXPECT_EQ(transport_loopback_get_bytes(), SPLIT_STATE_FRAME_HEADER_SIZE + sizeof(uint8_t));
+
+    // A single changed row is the only row in the slave frame
+    slave_matrix_[1] = 0x04;
+    scan();
+    EXPECT_TRUE(matrix_in_sync());
+    EXPECT_EQ(split_shmem->state_frame_s2m[5], 1 << 1);
+    EXPECT_EQ(split_shmem->state_frame_s2m[6], 0);
+
+    // A single changed byte of master state is the only payload in the master frame
+    settle();
+    master_.current_wpm = 42;
+    transport_loopback_clear_counters();
+    scan();
+    EXPECT_EQ(transport_loopback_get_bytes(), SPLIT_STATE_FRAME_HEADER_SIZE + sizeof(uint8_t) + sizeof(uint8_t));
+    run_slave();
+    EXPECT_EQ(slave_.current_wpm, 42);
+}
+
+TEST_F(SplitTransactions, AcknowledgedSectionsLeaveTheFrameUnderContinuousChange) {
+    // The slave never acknowledges the latest frame while WPM changes on every scan
+    master_.layer_state = 1 << 4;
+    for (int i = 0; i < 5; i++) {
+        master_.current_wpm++;
+        scan();
+    }
+
+    const uint8_t *frame    = split_shmem->state_frame_m2s;
+    uint32_t       sections = (uint32_t)frame[5] | ((uint32_t)frame[6] << 8) | ((uint32_t)frame[7] << 16) | ((uint32_t)frame[8] << 24);
+    EXPECT_EQ(__builtin_popcount(sections), 1);
+    EXPECT_EQ(slave_.layer_state, master_.layer_state);
+}
+
+TEST_F(SplitTransactions, CorruptFrameKeepsLastKnownGoodMatrix) {
+    slave_matrix_[0] = 0x01;
+    settle();
+    ASSERT_TRUE(matrix_in_sync());
+
+    slave_matrix_[0] = 0x03;
+    run_slave();
+    transport_loopback_corrupt_next();
+    advance_time(1);
+    // The handler retries on failure, so the next attempt goes through
+    EXPECT_TRUE(run_master());
+    EXPECT_TRUE(matrix_in_sync());
+}
+
+TEST_F(SplitTransactions, MissedFramesNeverApplyStaleState) {
+    std::mt19937 rng(1234);
+
+    std::vector<std::vector<matrix_row_t>> slave_history;
+    std::vector<layer_state_t>             master_history;
+
+    for (int step = 0; step < 5000; step++) {
+        advance_time(rng() % 3);
+
+        // The slave may publish several frames between two master transactions
+        int slave_runs = rng() % 4;
+        for (int i = 0; i < slave_runs; i++) {
+            if (rng() % 2) {
+                slave_matrix_[rng() % ROWS_PER_HAND] ^= 1 << (rng() % MATRIX_COLS);
+            }
+            run_slave();
+            slave_history.emplace_back(slave_matrix_, slave_matrix_ + ROWS_PER_HAND);
+            if (slave_history.size() > 64) slave_history.erase(slave_history.begin());
+
+            auto found = std::find(master_history.begin(), master_history.end(), slave_.layer_state);
+            if (!master_history.empty()) {
+                EXPECT_NE(found, master_history.end()) << "slave applied a layer state the master never had, step " << step;
+            }
+        }
+
+        if (rng() % 3 == 0) {
+            master_.layer_state = 1 << (rng() % 8);
+        }
+        master_history.push_back(master_.layer_state);
+        if (master_history.size() > 64) master_history.erase(master_history.begin());
+
+        transport_loopback_set_connected(rng() % 20 != 0);
+        run_master();
+
+        std::vector<matrix_row_t> received(received_, received_ + ROWS_PER_HAND);
+        if (!slave_history.empty()) {
+            auto found = std::find(slave_history.begin(), slave_history.end(), received);
+            EXPECT_NE(found, slave_history.end()) << "master applied a matrix the slave never had, step " << step;
+        }
+    }
+
+    transport_loopback_set_connected(true);
+    settle();
+    EXPECT_TRUE(matrix_in_sync());
+    EXPECT_EQ(slave_.layer_state, master_.layer_state);
+}
+
+#else  // SPLIT_STATE_FRAME_ENABLE
+
+TEST_F(SplitTransactions, TransactionsGrowWithFeatures) {
+    // Forced sync of the slave matrix, layer state, default layer state, mods and WPM
+    advance_time(FORCED_SYNC_THROTTLE_MS);
+    transport_loopback_clear_counters();
+    scan();
+#    if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    // Pointing motion is read on every scan
+    EXPECT_EQ(transport_loopback_get_transactions(), 7u);
+#    else
+    EXPECT_EQ(transport_loopback_get_transactions(), 6u);
+#    endif
+}
+
+#endif  // SPLIT_STATE_FRAME_ENABLE
+
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
+TEST_F(SplitTransactions, PointingMotionArrivesInTheSameScan) {
+    move(5, -3, 1, 0);
+    slave_pointing.buttons = 0x01;
+    scan();
+    EXPECT_EQ(received_x, 5);
+    EXPECT_EQ(received_y, -3);
+    EXPECT_EQ(received_v, 1);
+    EXPECT_EQ(received_buttons, 0x01);
+
+    move(-2, 2, 0, -1);
+    slave_pointing.buttons = 0;
+    scan();
+    EXPECT_EQ(received_x, 3);
+    EXPECT_EQ(received_y, -1);
+    EXPECT_EQ(received_h, -1);
+    EXPECT_EQ(received_buttons, 0);
+
+    // No new motion, nothing is applied twice
+    settle();
+    EXPECT_EQ(received_x, 3);
+}
+
+TEST_F(SplitTransactions, PointingMotionSurvivesLostReads) {
+    transport_loopback_set_connected(false);
+    for (int i = 0; i < 10; i++) {
+        move(3, -4);
+        scan();
+    }
+    EXPECT_EQ(received_x, 0);
+
+    transport_loopback_set_connected(true);
+    scan();
+    EXPECT_EQ(received_x, 30);
+    EXPECT_EQ(received_y, -40);
+
+    // A corrupted read is retried, and its motion applied once
+    move(7, 0);
+    run_slave();
+    transport_loopback_corrupt_next_of(GET_POINTING_DATA);
+    advance_time(1);
+    EXPECT_TRUE(run_master());
+    EXPECT_EQ(received_x, 37);
+}
+
+TEST_F(SplitTransactions, PointingSlaveRestartIsNotMotion) {
+    move(500, -500);
+    settle();
+    EXPECT_EQ(received_x, 500);
+
+    // The restarted slave counts from zero again, which is no motion
+    slave_pointing = {};
+    transport_loopback_restart_slave();
+    settle();
+    EXPECT_EQ(received_x, 500);
+    EXPECT_EQ(received_y, -500);
+
+    move(7, 0);
+    settle();
+    EXPECT_EQ(received_x, 507);
+}
+
+TEST_F(SplitTransactions, PointingOverflowIsCarried) {
+    // Far more than one report could carry piles up while the link is down
+    transport_loopback_set_connected(false);
+    for (int i = 0; i < 4; i++) {
+        move(30000, -30000, 200, -200);
+        scan();
+    }
+    transport_loopback_set_connected(true);
+    scan();
+    EXPECT_EQ(received_x, 120000);
+    EXPECT_EQ(received_y, -120000);
+    EXPECT_EQ(received_v, 800);
+    EXPECT_EQ(received_h, -800);
+
+    // The running totals wrap around without losing motion
+    for (int i = 0; i < 3; i++) {
+        move(0x70000000, -0x70000000);
+        scan();
+    }
+    EXPECT_EQ(received_x, 120000 + 3 * (int64_t)0x70000000);
+    EXPECT_EQ(received_y, -120000 - 3 * (int64_t)0x70000000);
+}
+
+TEST_F(SplitTransactions, PointingMotionIsExactOverAFlakyLink) {
+    std::mt19937 rng(4321);
+
+    int64_t moved_x = 0, moved_y = 0;
+    for (int step = 0; step < 5000; step++) {
+        int32_t x = (int32_t)(rng() % 2001) - 1000, y = (int32_t)(rng() % 201) - 100;
+        move(x, y);
+        moved_x += x;
+        moved_y += y;
+
+        transport_loopback_set_connected(rng() % 10 != 0);
+        if (rng() % 10 == 0) {
+            transport_loopback_corrupt_next_of(GET_POINTING_DATA);
+        }
+        scan();
+    }
+
+    transport_loopback_set_connected(true);
+    settle();
+    EXPECT_EQ(received_x, moved_x);
+    EXPECT_EQ(received_y, moved_y);
+}
+
+TEST_F(SplitTransactions, PointingCpiReachesSlave) {
+    settle();
+    EXPECT_EQ(slave_cpi_updates, 0u);
+
+    // The slave applies it on its next pass
+    master_shared_cpi = 1600;
+    scan();
+    run_slave();
+    EXPECT_EQ(slave_cpi, 1600);
+
+    // The forced sync resends it, but the sensor is only updated on a change
+    advance_time(FORCED_SYNC_THROTTLE_MS);
+    settle();
+    EXPECT_EQ(slave_cpi_updates, 1u);
+}
+
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+
+/* Every timestamp is ROUND_TRIP_US after the previous one */
+#    define ROUND_TRIP_US 150
+
+extern "C" uint32_t split_transport_stats_timestamp(void) {
+    static uint32_t now = 0;
+    return now += ROUND_TRIP_US;
+}
+
+TEST_F(SplitTransactions, StatsCountEveryTransaction) {
+    transport_loopback_clear_counters();
+    for (int i = 0; i < 10; i++) {
+        slave_matrix_[i % ROWS_PER_HAND] ^= 1;
+        master_.current_wpm++;
+        scan();
+    }
+
+    split_transport_stats_t total;
+    ASSERT_TRUE(split_transport_stats_get(SPLIT_TRANSPORT_STATS_TOTAL, &total));
+    EXPECT_EQ(total.attempts, transport_loopback_get_transactions());
+    EXPECT_EQ(total.bytes, transport_loopback_get_bytes());
+    EXPECT_EQ(total.failures, 0u);
+    EXPECT_EQ(total.retries, 0u);
+    EXPECT_EQ(total.max_round_trip_us, (uint32_t)ROUND_TRIP_US);
+    EXPECT_EQ(split_transport_link_quality(), 100);
+
+    // The totals are the sum of the individual transaction IDs
+    uint32_t attempts = 0;
+    for (int8_t id = 0; id < 127; id++) {
+        split_transport_stats_t entry;
+        if (!split_transport_stats_get(id, &entry)) break;
+        attempts += entry.attempts;
+    }
+    EXPECT_EQ(attempts, total.attempts);
+}
+
+TEST_F(SplitTransactions, StatsTrackFailuresAndLinkQuality) {
+    transport_loopback_set_connected(false);
+    for (int i = 0; i < 40; i++) {
+        scan();
+    }
+
+    split_transport_stats_t total;
+    split_transport_stats_get(SPLIT_TRANSPORT_STATS_TOTAL, &total);
+    EXPECT_EQ(total.failures, total.attempts);
+    EXPECT_GE(total.failures, 40u);
+    EXPECT_EQ(split_transport_link_quality(), 0);
+
+    // Quality recovers as successful transactions push the failures out of the window
+    transport_loopback_set_connected(true);
+    scan();
+    uint8_t recovering = split_transport_link_quality();
+    EXPECT_GT(recovering, 0);
+    EXPECT_LT(recovering, 100);
+    for (int i = 0; i < 32; i++) {
+        scan();
+    }
+    EXPECT_EQ(split_transport_link_quality(), 100);
+}
+
+TEST_F(SplitTransactions, StatsCountRetries) {
+    slave_matrix_[0] = 0x03;
+    run_slave();
+    transport_loopback_corrupt_next();
+    advance_time(1);
+    EXPECT_TRUE(run_master());
+
+    // The transport itself succeeded, but the corrupt data made the handler retry
+    split_transport_stats_t total;
+    split_transport_stats_get(SPLIT_TRANSPORT_STATS_TOTAL, &total);
+    EXPECT_EQ(total.failures, 0u);
+    EXPECT_GT(total.retries, 0u);
+    EXPECT_LT(split_transport_link_quality(), 100);
+}
+
+TEST_F(SplitTransactions, StatsRawIsBigEndian) {
+    settle();
+
+    split_transport_stats_t total;
+    split_transport_stats_get(SPLIT_TRANSPORT_STATS_TOTAL, &total);
+
+    uint8_t data[21];
+    split_transport_stats_get_raw(SPLIT_TRANSPORT_STATS_TOTAL, data);
+    const uint32_t expected[] = {total.attempts, total.failures, total.retries, total.bytes, total.max_round_trip_us};
+    for (int i = 0; i < 5; i++) {
+        uint32_t value = ((uint32_t)data[i * 4] << 24) | ((uint32_t)data[i * 4 + 1] << 16) | ((uint32_t)data[i * 4 + 2] << 8) | data[i * 4 + 3];
+        EXPECT_EQ(value, expected[i]);
+    }
+    EXPECT_EQ(data[20], split_transport_link_quality());
+
+    split_transport_stats_reset();
+    split_transport_stats_get_raw(SPLIT_TRANSPORT_STATS_TOTAL, data);
+    EXPECT_EQ(data[3], 0);
+    EXPECT_EQ(data[20], 100);
+}
+
+#    if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+TEST_F(SplitTransactions, StatsTrackPointingLatency) {
+    for (int i = 0; i < 10; i++) {
+        move(1, 1);
+        scan();
+    }
+
+    // Motion is a single read per scan, the round trip is what it adds to the latency
+    split_transport_stats_t pointing;
+    ASSERT_TRUE(split_transport_stats_get(GET_POINTING_DATA, &pointing));
+    EXPECT_EQ(pointing.attempts, 10u);
+    EXPECT_EQ(pointing.bytes, 10 * sizeof(split_slave_pointing_sync_t));
+    EXPECT_EQ(pointing.max_round_trip_us, (uint32_t)ROUND_TRIP_US);
+}
+#    endif
+
+#endif  // SPLIT_TRANSPORT_STATS_ENABLE
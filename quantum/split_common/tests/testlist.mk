@@ -0,0 +1,5 @@
+TEST_LIST += \
+	split_transactions \
+	split_state_frame \
+	split_transport_stats \
+	split_pointing
@@ -0,0 +1,110 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "transactions.h"
+#include "transport.h"
+#include "transport_loopback.h"
+
+static split_shared_memory_t shared_memory;
+split_shared_memory_t *const split_shmem = &shared_memory;
+
+static split_shared_memory_t slave_memory;
+static bool                  connected;
+static bool                  corrupt_next;
+static int8_t                corrupt_id;
+static uint32_t              transactions;
+static uint32_t              bytes;
+
+static void swap_memory(void) {
+    split_shared_memory_t temp;
+    memcpy(&temp, &shared_memory, sizeof(temp));
+    memcpy(&shared_memory, &slave_memory, sizeof(temp));
+    memcpy(&slave_memory, &temp, sizeof(temp));
+}
+
+void transport_loopback_reset(void) {
+    memset(&shared_memory, 0, sizeof(shared_memory));
+    memset(&slave_memory, 0, sizeof(slave_memory));
+    connected    = true;
+    corrupt_next = false;
+    corrupt_id   = -1;
+    transport_loopback_clear_counters();
+}
+
+void transport_loopback_run_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    swap_memory();
+    transactions_slave(master_matrix, slave_matrix);
+    swap_memory();
+}
+
+void transport_loopback_restart_slave(void) { memset(&slave_memory, 0, sizeof(slave_memory)); }
+
+void transport_loopback_set_connected(bool state) { connected = state; }
+
+void transport_loopback_corrupt_next(void) { transport_loopback_corrupt_next_of(-1); }
+
+void transport_loopback_corrupt_next_of(int8_t id) {
+    corrupt_next = true;
+    corrupt_id   = id;
+}
+
+uint32_t transport_loopback_get_transactions(void) { return transactions; }
+
+uint32_t transport_loopback_get_bytes(void) { return bytes; }
+
+void transport_loopback_clear_counters(void) {
+    transactions = 0;
+    bytes        = 0;
+}
+
+bool is_transport_connected(void) { return connected; }
+
+bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+
+    transactions++;
+    if (!connected) {
+        return false;
+    }
+
+    if (initiator2target_length > 0) {
+        size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
+        memcpy(split_trans_initiator2target_buffer(trans), initiator2target_buf, len);
+        memcpy(((uint8_t *)&slave_memory) + trans->initiator2target_offset, split_trans_initiator2target_buffer(trans), len);
+        bytes += len;
+    }
+
+    if (trans->slave_callback) {
+        swap_memory();
+        trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->target2initiator_buffer_size, split_trans_target2initiator_buffer(trans));
+        swap_memory();
+    }
+
+    if (target2initiator_length > 0) {
+        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        memcpy(split_trans_target2initiator_buffer(trans), ((uint8_t *)&slave_memory) + trans->target2initiator_offset, len);
+        if (corrupt_next && (corrupt_id < 0 || corrupt_id == id)) {
+            ((uint8_t *)split_trans_target2initiator_buffer(trans))[len > 1 ? 1 : 0] ^= 0x5A;
+            corrupt_next = false;
+        }
+        memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+        bytes += len;
+    }
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Host-side split transport connecting both halves within one process. The
+ * live split_shmem holds the master's view; the slave's shared memory is
+ * kept separately and swapped in while the slave runs.
+ */
+
+void transport_loopback_reset(void);
+void transport_loopback_run_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+void transport_loopback_restart_slave(void);  // clears the shared memory of the slave only
+
+void transport_loopback_set_connected(bool connected);
+void transport_loopback_corrupt_next(void);
+void transport_loopback_corrupt_next_of(int8_t id);  // only the next read of one transaction ID
+
+uint32_t transport_loopback_get_transactions(void);
+uint32_t transport_loopback_get_bytes(void);
+void     transport_loopback_clear_counters(void);
+
+#ifdef __cplusplus
+}
+#endif
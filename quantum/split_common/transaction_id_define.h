@@ -21,8 +21,13 @@ enum serial_transaction_id {
     I2C_EXECUTE_CALLBACK,
 #endif  // USE_I2C
 
+#ifdef SPLIT_STATE_FRAME_ENABLE
+    EXCHANGE_STATE_FRAME,
+    GET_STATE_FRAME_DATA,
+#else  // SPLIT_STATE_FRAME_ENABLE
     GET_SLAVE_MATRIX_CHECKSUM,
     GET_SLAVE_MATRIX_DATA,
+#endif  // SPLIT_STATE_FRAME_ENABLE
 
 #ifdef SPLIT_TRANSPORT_MIRROR
     PUT_MASTER_MATRIX,
@@ -33,10 +38,17 @@ enum serial_transaction_id {
     GET_ENCODERS_DATA,
 #endif  // ENCODER_ENABLE
 
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    GET_POINTING_DATA,
+    PUT_POINTING_CPI,
+    PUT_POINTING_SYNCED,
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
 #ifndef DISABLE_SYNC_TIMER
     PUT_SYNC_TIMER,
 #endif  // DISABLE_SYNC_TIMER
 
+#ifndef SPLIT_STATE_FRAME_ENABLE
 #if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
     PUT_LAYER_STATE,
     PUT_DEFAULT_LAYER_STATE,
@@ -77,6 +89,7 @@ enum serial_transaction_id {
 #if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
     PUT_ST7565,
 #endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+#endif  // SPLIT_STATE_FRAME_ENABLE
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
     PUT_RPC_INFO,
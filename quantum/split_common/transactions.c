@@ -25,6 +25,7 @@
 #include "transport.h"
 #include "split_util.h"
 #include "transaction_id_define.h"
+#include "transport_stats.h"
 
 #define SYNC_TIMER_OFFSET 2
 
@@ -42,8 +43,24 @@
     { &dummy, 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+static bool transaction_retrying = false;
+
+static bool transport_execute_transaction_tracked(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    uint16_t                  bytes = (trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length) + (trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length);
+
+    uint32_t start = split_transport_stats_timestamp();
+    bool     okay  = transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+    split_transport_stats_record(id, okay, transaction_retrying, bytes, split_transport_stats_timestamp() - start);
+    return okay;
+}
+#else  // SPLIT_TRANSPORT_STATS_ENABLE
+#    define transport_execute_transaction_tracked transport_execute_transaction
+#endif  // SPLIT_TRANSPORT_STATS_ENABLE
+
+#define transport_write(id, data, length) transport_execute_transaction_tracked(id, data, length, NULL, 0)
+#define transport_read(id, data, length) transport_execute_transaction_tracked(id, NULL, 0, data, length)
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
@@ -55,19 +72,29 @@ void slave_rpc_exec_callback(uint8_t initiator2target_buffer_size, const void *i
 // Helpers
 
 static bool transaction_handler_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[], const char *prefix, bool (*handler)(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])) {
-    int num_retries = is_transport_connected() ? 10 : 1;
-    for (int iter = 1; iter <= num_retries; ++iter) {
+    int  num_retries = is_transport_connected() ? 10 : 1;
+    bool okay        = false;
+    for (int iter = 1; !okay && iter <= num_retries; ++iter) {
         if (iter > 1) {
             for (int i = 0; i < iter * iter; ++i) {
                 wait_us(10);
             }
         }
-        bool this_okay = true;
-        ATOMIC_BLOCK_FORCEON { this_okay = handler(master_matrix, slave_matrix); };
-        if (this_okay) return true;
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+        transaction_retrying = iter > 1;
+#endif  // SPLIT_TRANSPORT_STATS_ENABLE
+        ATOMIC_BLOCK_FORCEON { okay = handler(master_matrix, slave_matrix); };
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+        split_transport_stats_record_sync(okay);
+#endif  // SPLIT_TRANSPORT_STATS_ENABLE
     }
-    dprintf("Failed to execute %s\n", prefix);
-    return false;
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+    transaction_retrying = false;
+#endif  // SPLIT_TRANSPORT_STATS_ENABLE
+    if (!okay) {
+        dprintf("Failed to execute %s\n", prefix);
+    }
+    return okay;
 }
 
 #define TRANSACTION_HANDLER_MASTER(prefix)                                                                              \
@@ -114,6 +141,8 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
 ////////////////////////////////////////////////////
 // Slave matrix
 
+#ifndef SPLIT_STATE_FRAME_ENABLE
+
 static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     static uint32_t     last_update                    = 0;
     static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0};  // last successfully-read matrix, so we can replicate if there are checksum errors
@@ -135,13 +164,22 @@ static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row
 }
 
 // clang-format off
-#define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
     [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
     [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix),
 // clang-format on
 
+#else  // SPLIT_STATE_FRAME_ENABLE
+
+// The slave matrix is carried by the state frame
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER()
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE()
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
+
+#endif  // SPLIT_STATE_FRAME_ENABLE
+
 ////////////////////////////////////////////////////
 // Master matrix
 
@@ -208,6 +246,75 @@ static void encoder_handlers_slave(matrix_row_t master_matrix[], matrix_row_t sl
 
 #endif  // ENCODER_ENABLE
 
+////////////////////////////////////////////////////
+// Pointing device
+
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
+static bool pointing_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static pointing_device_shared_t last_motion     = {0};      // running totals of the last good read
+    static bool                     synced          = false;  // last_motion continues the totals of the slave
+    static uint32_t                 last_cpi_update = 0;
+
+    if (!POINTING_DEVICE_ON_OTHER_SIDE()) {
+        return true;
+    }
+
+    // Read every scan, motion is too latency sensitive to wait for a checksum change
+    split_slave_pointing_sync_t temp;
+    bool                        okay = transport_read(GET_POINTING_DATA, &temp, sizeof(temp));
+    okay &= temp.checksum == crc8(&temp.synced, sizeof(temp) - offsetof(split_slave_pointing_sync_t, synced));
+    if (okay) {
+        if (synced && temp.synced) {
+            // The slave keeps counting while reads fail, so the difference includes the motion of every lost read
+            pointing_device_add_shared_motion((int32_t)(temp.motion.x - last_motion.x), (int32_t)(temp.motion.y - last_motion.y), (int32_t)(temp.motion.v - last_motion.v), (int32_t)(temp.motion.h - last_motion.h), temp.motion.buttons);
+        } else {
+            // First read since either half started, the totals are only a starting point
+            pointing_device_add_shared_motion(0, 0, 0, 0, temp.motion.buttons);
+            synced = true;
+            okay   = transport_write(PUT_POINTING_SYNCED, &synced, sizeof(synced));
+        }
+        last_motion = temp.motion;
+    }
+
+    uint16_t cpi = pointing_device_get_shared_cpi();
+    if (cpi) {
+        okay &= send_if_condition(PUT_POINTING_CPI, &last_cpi_update, cpi != split_shmem->pointing_cpi, &cpi, sizeof(cpi));
+    }
+    return okay;
+}
+
+static void pointing_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static uint16_t applied_cpi = 0;
+
+    // Always prepare the running totals for read
+    split_shmem->pointing.synced = split_shmem->pointing_synced;
+    pointing_device_get_shared_motion(&split_shmem->pointing.motion);
+    split_shmem->pointing.checksum = crc8(&split_shmem->pointing.synced, sizeof(split_shmem->pointing) - offsetof(split_slave_pointing_sync_t, synced));
+
+    if (split_shmem->pointing_cpi && split_shmem->pointing_cpi != applied_cpi) {
+        applied_cpi = split_shmem->pointing_cpi;
+        pointing_device_set_cpi_on_side(is_keyboard_left(), applied_cpi);
+    }
+}
+
+// clang-format off
+#    define TRANSACTIONS_POINTING_MASTER() TRANSACTION_HANDLER_MASTER(pointing)
+#    define TRANSACTIONS_POINTING_SLAVE() TRANSACTION_HANDLER_SLAVE(pointing)
+#    define TRANSACTIONS_POINTING_REGISTRATIONS \
+    [GET_POINTING_DATA]   = trans_target2initiator_initializer(pointing), \
+    [PUT_POINTING_CPI]    = trans_initiator2target_initializer(pointing_cpi), \
+    [PUT_POINTING_SYNCED] = trans_initiator2target_initializer(pointing_synced),
+// clang-format on
+
+#else  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
+#    define TRANSACTIONS_POINTING_MASTER()
+#    define TRANSACTIONS_POINTING_SLAVE()
+#    define TRANSACTIONS_POINTING_REGISTRATIONS
+
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
 ////////////////////////////////////////////////////
 // Sync timer
 
@@ -247,6 +354,8 @@ static void sync_timer_handlers_slave(matrix_row_t master_matrix[], matrix_row_t
 
 #endif  // DISABLE_SYNC_TIMER
 
+#ifndef SPLIT_STATE_FRAME_ENABLE
+
 ////////////////////////////////////////////////////
 // Layer state
 
@@ -578,6 +687,442 @@ static void st7565_handlers_slave(matrix_row_t master_matrix[], matrix_row_t sla
 
 #endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
 
+#else  // SPLIT_STATE_FRAME_ENABLE
+
+////////////////////////////////////////////////////
+// State frame
+//
+// A single transaction per scan exchanges one frame in each direction: the
+// master state towards the slave, and the slave matrix towards the master.
+// Each frame only carries the sections (matrix rows, or master subsystems)
+// that changed since the last frame acknowledged by the receiving half, so
+// the receiver can apply it on top of any frame it has seen since then. The
+// master only reads back the checksum of the slave frame, and fetches the
+// frame itself when the checksum differs from the last one it decoded.
+
+#    define STATE_FRAME_FLAG_FULL (1 << 0)    // frame carries every section
+#    define STATE_FRAME_FLAG_RESYNC (1 << 1)  // sender needs a full frame
+
+#    define STATE_FRAME_HISTORY 4  // frames whose changed sections are remembered, power of two
+
+#    define state_section(member) \
+        { offsetof(split_state_t, member), sizeof_member(split_state_t, member) }
+
+typedef struct {
+    uint8_t offset;
+    uint8_t size;
+} state_frame_section_t;
+
+typedef struct {
+    uint8_t                      count;
+    uint8_t                      stride;    // section size when sections is NULL
+    const state_frame_section_t *sections;  // NULL for equally sized sections
+} state_frame_layout_t;
+
+typedef struct {
+    uint8_t  tx_seq;                           // last frame published
+    uint8_t  tx_base;                          // last frame acknowledged by the other half
+    bool     tx_full;                          // send every section until acknowledged
+    uint8_t  tx_full_seq;                      // first full frame
+    uint32_t tx_pending;                       // sections changed since tx_base
+    uint32_t tx_changed[STATE_FRAME_HISTORY];  // sections changed by each of the last frames
+    uint8_t  rx_seq;      // last frame applied
+    bool     rx_synced;   // false until a full frame has been applied
+    bool     rx_resync;   // request a full frame even though in sync
+} state_frame_link_t;
+
+enum state_frame_section {
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    STATE_SECTION_LAYER_STATE,
+    STATE_SECTION_DEFAULT_LAYER_STATE,
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#    ifdef SPLIT_LED_STATE_ENABLE
+    STATE_SECTION_LED_STATE,
+#    endif  // SPLIT_LED_STATE_ENABLE
+#    ifdef SPLIT_MODS_ENABLE
+    STATE_SECTION_MODS,
+#    endif  // SPLIT_MODS_ENABLE
+#    ifdef BACKLIGHT_ENABLE
+    STATE_SECTION_BACKLIGHT,
+#    endif  // BACKLIGHT_ENABLE
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    STATE_SECTION_RGBLIGHT,
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    STATE_SECTION_LED_MATRIX,
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    STATE_SECTION_RGB_MATRIX,
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    STATE_SECTION_WPM,
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    STATE_SECTION_OLED,
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    STATE_SECTION_ST7565,
+#    endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    STATE_SECTION_COUNT
+};
+
+// clang-format off
+static const state_frame_section_t state_sections[STATE_SECTION_COUNT + 1] = {  // +1 so the table is never empty
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    [STATE_SECTION_LAYER_STATE]         = state_section(layer_state),
+    [STATE_SECTION_DEFAULT_LAYER_STATE] = state_section(default_layer_state),
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#    ifdef SPLIT_LED_STATE_ENABLE
+    [STATE_SECTION_LED_STATE]           = state_section(led_state),
+#    endif  // SPLIT_LED_STATE_ENABLE
+#    ifdef SPLIT_MODS_ENABLE
+    [STATE_SECTION_MODS]                = state_section(mods),
+#    endif  // SPLIT_MODS_ENABLE
+#    ifdef BACKLIGHT_ENABLE
+    [STATE_SECTION_BACKLIGHT]           = state_section(backlight_level),
+#    endif  // BACKLIGHT_ENABLE
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    [STATE_SECTION_RGBLIGHT]            = state_section(rgblight_sync),
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    [STATE_SECTION_LED_MATRIX]          = state_section(led_matrix_sync),
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    [STATE_SECTION_RGB_MATRIX]          = state_section(rgb_matrix_sync),
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    [STATE_SECTION_WPM]                 = state_section(current_wpm),
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    [STATE_SECTION_OLED]                = state_section(current_oled_state),
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    [STATE_SECTION_ST7565]              = state_section(current_st7565_state),
+#    endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+};
+// clang-format on
+
+static const state_frame_layout_t state_layout  = {STATE_SECTION_COUNT, 0, state_sections};
+static const state_frame_layout_t matrix_layout = {(MATRIX_ROWS) / 2, sizeof(matrix_row_t), NULL};
+
+_Static_assert(STATE_SECTION_COUNT <= 32, "Too many state frame sections");
+_Static_assert((MATRIX_ROWS) / 2 <= 32, "Too many matrix rows for the state frame");
+// Frame lengths and section offsets are uint8_t
+_Static_assert(SPLIT_STATE_FRAME_M2S_SIZE <= UINT8_MAX, "split_state_t too large for the state frame");
+_Static_assert(SPLIT_STATE_FRAME_S2M_SIZE <= UINT8_MAX, "Matrix too large for the state frame");
+
+static inline uint8_t state_frame_section_offset(const state_frame_layout_t *layout, uint8_t section) { return layout->sections ? layout->sections[section].offset : section * layout->stride; }
+
+static inline uint8_t state_frame_section_size(const state_frame_layout_t *layout, uint8_t section) { return layout->sections ? layout->sections[section].size : layout->stride; }
+
+static inline uint32_t state_frame_all_sections(const state_frame_layout_t *layout) { return layout->count >= 32 ? UINT32_MAX : (((uint32_t)1 << layout->count) - 1); }
+
+static inline bool state_frame_seq_within(uint8_t seq, uint8_t first, uint8_t last) { return (uint8_t)(seq - first) <= (uint8_t)(last - first); }
+
+// Send every section from the next frame on, until a full frame is acknowledged
+static void state_frame_send_full(state_frame_link_t *link) {
+    if (!link->tx_full) {
+        link->tx_full                                        = true;
+        link->tx_full_seq                                    = ++link->tx_seq;
+        link->tx_changed[link->tx_seq % STATE_FRAME_HISTORY] = 0;
+    }
+}
+
+// Handle the acknowledgement carried by a frame from the other half
+static void state_frame_handle_ack(state_frame_link_t *link, uint8_t ack, uint8_t flags) {
+    if (flags & STATE_FRAME_FLAG_RESYNC) {
+        state_frame_send_full(link);
+        return;
+    }
+    if (ack == link->tx_base || !state_frame_seq_within(ack, link->tx_base, link->tx_seq)) {
+        return;
+    }
+    // The other half holds every section as of ack, so only the frames after it are still pending
+    if ((uint8_t)(link->tx_seq - ack) < STATE_FRAME_HISTORY) {
+        uint32_t pending = 0;
+        for (uint8_t seq = ack; seq != link->tx_seq;) {
+            pending |= link->tx_changed[++seq % STATE_FRAME_HISTORY];
+        }
+        link->tx_base    = ack;
+        link->tx_pending = pending;
+    }
+    if (link->tx_full && state_frame_seq_within(ack, link->tx_full_seq, link->tx_seq)) {
+        link->tx_full = false;
+    }
+}
+
+// Publish a new frame if the local state changed since the last one, and write it out. Returns the frame length.
+static uint8_t state_frame_encode(state_frame_link_t *link, const state_frame_layout_t *layout, const uint8_t *current, uint8_t *published, uint8_t *frame) {
+    uint32_t changed = 0;
+    for (uint8_t i = 0; i < layout->count; i++) {
+        uint8_t offset = state_frame_section_offset(layout, i);
+        uint8_t size   = state_frame_section_size(layout, i);
+        if (memcmp(current + offset, published + offset, size) != 0) {
+            memcpy(published + offset, current + offset, size);
+            changed |= (uint32_t)1 << i;
+        }
+    }
+    if (changed) {
+        link->tx_pending |= changed;
+        link->tx_seq++;
+        link->tx_changed[link->tx_seq % STATE_FRAME_HISTORY] = changed;
+    }
+
+    uint32_t sections = link->tx_full ? state_frame_all_sections(layout) : link->tx_pending;
+    uint8_t  flags    = (link->tx_full ? STATE_FRAME_FLAG_FULL : 0) | ((!link->rx_synced || link->rx_resync) ? STATE_FRAME_FLAG_RESYNC : 0);
+
+    frame[1] = link->tx_seq;
+    frame[2] = link->tx_base;
+    frame[3] = link->rx_seq;
+    frame[4] = flags;
+    frame[5] = sections & 0xFF;
+    frame[6] = (sections >> 8) & 0xFF;
+    frame[7] = (sections >> 16) & 0xFF;
+    frame[8] = (sections >> 24) & 0xFF;
+
+    uint8_t length = SPLIT_STATE_FRAME_HEADER_SIZE;
+    for (uint8_t i = 0; i < layout->count; i++) {
+        if (sections & ((uint32_t)1 << i)) {
+            uint8_t size = state_frame_section_size(layout, i);
+            memcpy(frame + length, published + state_frame_section_offset(layout, i), size);
+            length += size;
+        }
+    }
+    frame[0] = crc8(frame + 1, length - 1);
+    return length;
+}
+
+// Apply a frame from the other half to state. Returns false if the frame is corrupt, otherwise sets applied to the sections that were updated.
+static bool state_frame_decode(state_frame_link_t *link, const state_frame_layout_t *layout, const uint8_t *frame, uint8_t frame_size, uint8_t *state, uint32_t *applied) {
+    *applied = 0;
+
+    uint32_t sections = (uint32_t)frame[5] | ((uint32_t)frame[6] << 8) | ((uint32_t)frame[7] << 16) | ((uint32_t)frame[8] << 24);
+    if (sections & ~state_frame_all_sections(layout)) {
+        return false;
+    }
+    uint8_t length = SPLIT_STATE_FRAME_HEADER_SIZE;
+    for (uint8_t i = 0; i < layout->count; i++) {
+        if (sections & ((uint32_t)1 << i)) {
+            length += state_frame_section_size(layout, i);
+        }
+    }
+    if (length > frame_size || frame[0] != crc8(frame + 1, length - 1)) {
+        return false;
+    }
+
+    uint8_t seq   = frame[1];
+    uint8_t base  = frame[2];
+    uint8_t flags = frame[4];
+    state_frame_handle_ack(link, frame[3], flags);
+
+    if (link->rx_synced && seq == link->rx_seq) {
+        return true;  // nothing new
+    }
+
+    // A delta frame lists every section changed since base, so it applies on top of any frame from base to seq
+    if ((flags & STATE_FRAME_FLAG_FULL) || (link->rx_synced && (uint8_t)(link->rx_seq - base) <= (uint8_t)(seq - base))) {
+        const uint8_t *payload = frame + SPLIT_STATE_FRAME_HEADER_SIZE;
+        for (uint8_t i = 0; i < layout->count; i++) {
+            if (sections & ((uint32_t)1 << i)) {
+                uint8_t size = state_frame_section_size(layout, i);
+                memcpy(state + state_frame_section_offset(layout, i), payload, size);
+                payload += size;
+            }
+        }
+        if (flags & STATE_FRAME_FLAG_FULL) {
+            link->rx_synced = true;
+            link->rx_resync = false;
+        }
+        link->rx_seq = seq;
+        *applied     = sections;
+    } else {
+        link->rx_synced = false;
+    }
+    return true;
+}
+
+static void state_frame_gather(split_state_t *state) {
+    memset(state, 0, sizeof(split_state_t));
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    state->layer_state         = layer_state;
+    state->default_layer_state = default_layer_state;
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#    ifdef SPLIT_LED_STATE_ENABLE
+    state->led_state = host_keyboard_leds();
+#    endif  // SPLIT_LED_STATE_ENABLE
+#    ifdef SPLIT_MODS_ENABLE
+    state->mods.real_mods = get_mods();
+    state->mods.weak_mods = get_weak_mods();
+#        ifndef NO_ACTION_ONESHOT
+    state->mods.oneshot_mods = get_oneshot_mods();
+#        endif  // NO_ACTION_ONESHOT
+#    endif      // SPLIT_MODS_ENABLE
+#    ifdef BACKLIGHT_ENABLE
+    state->backlight_level = is_backlight_enabled() ? get_backlight_level() : 0;
+#    endif  // BACKLIGHT_ENABLE
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    rgblight_get_syncinfo(&state->rgblight_sync);
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    memcpy(&state->led_matrix_sync.led_matrix, &led_matrix_eeconfig, sizeof(led_eeconfig_t));
+    state->led_matrix_sync.led_suspend_state = led_matrix_get_suspend_state();
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    memcpy(&state->rgb_matrix_sync.rgb_matrix, &rgb_matrix_config, sizeof(rgb_config_t));
+    state->rgb_matrix_sync.rgb_suspend_state = rgb_matrix_get_suspend_state();
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    state->current_wpm = get_current_wpm();
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    state->current_oled_state = is_oled_on();
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    state->current_st7565_state = st7565_is_on();
+#    endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+}
+
+#    define state_frame_applied(section) (applied & ((uint32_t)1 << (section)))
+
+static void state_frame_apply(split_state_t *state, uint32_t applied) {
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    if (state_frame_applied(STATE_SECTION_LAYER_STATE)) {
+        layer_state = state->layer_state;
+    }
+    if (state_frame_applied(STATE_SECTION_DEFAULT_LAYER_STATE)) {
+        default_layer_state = state->default_layer_state;
+    }
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#    ifdef SPLIT_LED_STATE_ENABLE
+    if (state_frame_applied(STATE_SECTION_LED_STATE)) {
+        void set_split_host_keyboard_leds(uint8_t led_state);
+        set_split_host_keyboard_leds(state->led_state);
+    }
+#    endif  // SPLIT_LED_STATE_ENABLE
+#    ifdef SPLIT_MODS_ENABLE
+    if (state_frame_applied(STATE_SECTION_MODS)) {
+        set_mods(state->mods.real_mods);
+        set_weak_mods(state->mods.weak_mods);
+#        ifndef NO_ACTION_ONESHOT
+        set_oneshot_mods(state->mods.oneshot_mods);
+#        endif  // NO_ACTION_ONESHOT
+    }
+#    endif  // SPLIT_MODS_ENABLE
+#    ifdef BACKLIGHT_ENABLE
+    if (state_frame_applied(STATE_SECTION_BACKLIGHT)) {
+        backlight_set(state->backlight_level);
+    }
+#    endif  // BACKLIGHT_ENABLE
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    if (state_frame_applied(STATE_SECTION_RGBLIGHT) && state->rgblight_sync.status.change_flags != 0) {
+        rgblight_update_sync(&state->rgblight_sync, false);
+        state->rgblight_sync.status.change_flags = 0;
+    }
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    if (state_frame_applied(STATE_SECTION_LED_MATRIX)) {
+        memcpy(&led_matrix_eeconfig, &state->led_matrix_sync.led_matrix, sizeof(led_eeconfig_t));
+        led_matrix_set_suspend_state(state->led_matrix_sync.led_suspend_state);
+    }
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    if (state_frame_applied(STATE_SECTION_RGB_MATRIX)) {
+        memcpy(&rgb_matrix_config, &state->rgb_matrix_sync.rgb_matrix, sizeof(rgb_config_t));
+        rgb_matrix_set_suspend_state(state->rgb_matrix_sync.rgb_suspend_state);
+    }
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    if (state_frame_applied(STATE_SECTION_WPM)) {
+        set_current_wpm(state->current_wpm);
+    }
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    if (state_frame_applied(STATE_SECTION_OLED)) {
+        if (state->current_oled_state) {
+            oled_on();
+        } else {
+            oled_off();
+        }
+    }
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    if (state_frame_applied(STATE_SECTION_ST7565)) {
+        if (state->current_st7565_state) {
+            st7565_on();
+        } else {
+            st7565_off();
+        }
+    }
+#    endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+}
+
+// Both halves start out sending a full frame
+#    define STATE_FRAME_LINK_INIT \
+        { .tx_seq = 1, .tx_full = true, .tx_full_seq = 1 }
+
+static bool state_frame_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static state_frame_link_t link                           = STATE_FRAME_LINK_INIT;
+    static uint32_t           last_update                    = 0;
+    static split_state_t      published_state                = {0};
+    static matrix_row_t       last_matrix[(MATRIX_ROWS) / 2] = {0};  // last successfully-decoded slave matrix
+    static uint8_t            last_checksum                  = 0;    // checksum of the last slave frame decoded
+    uint8_t                   m2s[SPLIT_STATE_FRAME_M2S_SIZE];
+    uint8_t                   s2m[SPLIT_STATE_FRAME_S2M_SIZE];
+    split_state_t             state;
+
+    // Periodically resend everything in both directions, for safety
+    if (timer_elapsed32(last_update) >= FORCED_SYNC_THROTTLE_MS) {
+        state_frame_send_full(&link);
+        link.rx_resync = true;
+        last_update    = timer_read32();
+    }
+
+    state_frame_gather(&state);
+    uint8_t length = state_frame_encode(&link, &state_layout, (const uint8_t *)&state, (uint8_t *)&published_state, m2s);
+
+    // The checksum covers the sequence number and acknowledgement, so an unchanged checksum means an unchanged frame
+    uint32_t applied;
+    bool     okay = transport_execute_transaction_tracked(EXCHANGE_STATE_FRAME, m2s, length, s2m, sizeof(uint8_t));
+    if (okay && (!link.rx_synced || s2m[0] != last_checksum)) {
+        okay = transport_read(GET_STATE_FRAME_DATA, s2m, sizeof(s2m)) && state_frame_decode(&link, &matrix_layout, s2m, sizeof(s2m), (uint8_t *)last_matrix, &applied);
+        if (okay) {
+            last_checksum = s2m[0];
+        }
+    }
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    if (okay) {
+        rgblight_clear_change_flags();
+    }
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+
+    // Copy out the last-known-good matrix state to the slave matrix
+    memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+    return okay;
+}
+
+static void state_frame_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static state_frame_link_t link                                = STATE_FRAME_LINK_INIT;
+    static split_state_t      state                               = {0};  // last master state applied
+    static matrix_row_t       published_matrix[(MATRIX_ROWS) / 2] = {0};
+
+    uint32_t applied;
+    if (state_frame_decode(&link, &state_layout, split_shmem->state_frame_m2s, sizeof(split_shmem->state_frame_m2s), (uint8_t *)&state, &applied) && applied) {
+        state_frame_apply(&state, applied);
+    }
+
+    state_frame_encode(&link, &matrix_layout, (const uint8_t *)slave_matrix, (uint8_t *)published_matrix, split_shmem->state_frame_s2m);
+}
+
+// clang-format off
+#    define TRANSACTIONS_STATE_FRAME_MASTER() TRANSACTION_HANDLER_MASTER(state_frame)
+#    define TRANSACTIONS_STATE_FRAME_SLAVE() TRANSACTION_HANDLER_SLAVE(state_frame)
+#    define TRANSACTIONS_STATE_FRAME_REGISTRATIONS \
+    [EXCHANGE_STATE_FRAME] = {&dummy, sizeof_member(split_shared_memory_t, state_frame_m2s), offsetof(split_shared_memory_t, state_frame_m2s), sizeof(uint8_t), offsetof(split_shared_memory_t, state_frame_s2m), NULL}, \
+    [GET_STATE_FRAME_DATA] = trans_target2initiator_initializer(state_frame_s2m),
+// clang-format on
+
+#endif  // SPLIT_STATE_FRAME_ENABLE
+
 ////////////////////////////////////////////////////
 
 uint8_t                  dummy;
@@ -593,7 +1138,11 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
     TRANSACTIONS_MASTER_MATRIX_REGISTRATIONS
     TRANSACTIONS_ENCODERS_REGISTRATIONS
+    TRANSACTIONS_POINTING_REGISTRATIONS
     TRANSACTIONS_SYNC_TIMER_REGISTRATIONS
+#ifdef SPLIT_STATE_FRAME_ENABLE
+    TRANSACTIONS_STATE_FRAME_REGISTRATIONS
+#else   // SPLIT_STATE_FRAME_ENABLE
     TRANSACTIONS_LAYER_STATE_REGISTRATIONS
     TRANSACTIONS_LED_STATE_REGISTRATIONS
     TRANSACTIONS_MODS_REGISTRATIONS
@@ -604,6 +1153,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     TRANSACTIONS_WPM_REGISTRATIONS
     TRANSACTIONS_OLED_REGISTRATIONS
     TRANSACTIONS_ST7565_REGISTRATIONS
+#endif  // SPLIT_STATE_FRAME_ENABLE
 // clang-format on
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -618,7 +1168,11 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
+    TRANSACTIONS_POINTING_MASTER();
     TRANSACTIONS_SYNC_TIMER_MASTER();
+#ifdef SPLIT_STATE_FRAME_ENABLE
+    TRANSACTIONS_STATE_FRAME_MASTER();
+#else   // SPLIT_STATE_FRAME_ENABLE
     TRANSACTIONS_LAYER_STATE_MASTER();
     TRANSACTIONS_LED_STATE_MASTER();
     TRANSACTIONS_MODS_MASTER();
@@ -629,6 +1183,7 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
     TRANSACTIONS_WPM_MASTER();
     TRANSACTIONS_OLED_MASTER();
     TRANSACTIONS_ST7565_MASTER();
+#endif  // SPLIT_STATE_FRAME_ENABLE
     return true;
 }
 
@@ -636,7 +1191,11 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_SLAVE_MATRIX_SLAVE();
     TRANSACTIONS_MASTER_MATRIX_SLAVE();
     TRANSACTIONS_ENCODERS_SLAVE();
+    TRANSACTIONS_POINTING_SLAVE();
     TRANSACTIONS_SYNC_TIMER_SLAVE();
+#ifdef SPLIT_STATE_FRAME_ENABLE
+    TRANSACTIONS_STATE_FRAME_SLAVE();
+#else   // SPLIT_STATE_FRAME_ENABLE
     TRANSACTIONS_LAYER_STATE_SLAVE();
     TRANSACTIONS_LED_STATE_SLAVE();
     TRANSACTIONS_MODS_SLAVE();
@@ -647,6 +1206,7 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_WPM_SLAVE();
     TRANSACTIONS_OLED_SLAVE();
     TRANSACTIONS_ST7565_SLAVE();
+#endif  // SPLIT_STATE_FRAME_ENABLE
 }
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
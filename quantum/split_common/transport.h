@@ -45,6 +45,10 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
 #    define NUMBER_OF_ENCODERS (sizeof((pin_t[])ENCODERS_PAD_A) / sizeof(pin_t))
 #endif  // ENCODER_ENABLE
 
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+#    include "pointing_device.h"
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif  // BACKLIGHT_ENABLE
@@ -71,6 +75,14 @@ typedef struct _split_slave_encoder_sync_t {
 } split_slave_encoder_sync_t;
 #endif  // ENCODER_ENABLE
 
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+typedef struct _split_slave_pointing_sync_t {
+    uint8_t                  checksum;
+    bool                     synced;  // copy of pointing_synced, false until the master has seen the totals since the slave started
+    pointing_device_shared_t motion;
+} split_slave_pointing_sync_t;
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
 #if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
 typedef struct _split_layers_sync_t {
     layer_state_t layer_state;
@@ -106,6 +118,59 @@ typedef struct _split_mods_sync_t {
 } split_mods_sync_t;
 #endif  // SPLIT_MODS_ENABLE
 
+#ifdef SPLIT_STATE_FRAME_ENABLE
+// Master state carried by the state frame, one section per member
+typedef struct _split_state_t {
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    layer_state_t layer_state;
+    layer_state_t default_layer_state;
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+
+#    ifdef SPLIT_LED_STATE_ENABLE
+    uint8_t led_state;
+#    endif  // SPLIT_LED_STATE_ENABLE
+
+#    ifdef SPLIT_MODS_ENABLE
+    split_mods_sync_t mods;
+#    endif  // SPLIT_MODS_ENABLE
+
+#    ifdef BACKLIGHT_ENABLE
+    uint8_t backlight_level;
+#    endif  // BACKLIGHT_ENABLE
+
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    rgblight_syncinfo_t rgblight_sync;
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    led_matrix_sync_t led_matrix_sync;
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    rgb_matrix_sync_t rgb_matrix_sync;
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    uint8_t current_wpm;
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    uint8_t current_oled_state;
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    uint8_t current_st7565_state;
+#    endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+
+    uint8_t reserved;  // keeps the struct non-empty, never sent
+} split_state_t;
+
+// checksum, sequence, base sequence, acknowledged sequence, flags, 32-bit section bitmap
+#    define SPLIT_STATE_FRAME_HEADER_SIZE 9
+#    define SPLIT_STATE_FRAME_M2S_SIZE (SPLIT_STATE_FRAME_HEADER_SIZE + sizeof(split_state_t))
+#    define SPLIT_STATE_FRAME_S2M_SIZE (SPLIT_STATE_FRAME_HEADER_SIZE + sizeof(matrix_row_t) * ((MATRIX_ROWS) / 2))
+#endif  // SPLIT_STATE_FRAME_ENABLE
+
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 typedef struct _rpc_sync_info_t {
     int8_t  transaction_id;
@@ -119,7 +184,12 @@ typedef struct _split_shared_memory_t {
     int8_t transaction_id;
 #endif  // USE_I2C
 
+#ifdef SPLIT_STATE_FRAME_ENABLE
+    uint8_t state_frame_m2s[SPLIT_STATE_FRAME_M2S_SIZE];
+    uint8_t state_frame_s2m[SPLIT_STATE_FRAME_S2M_SIZE];
+#else   // SPLIT_STATE_FRAME_ENABLE
     split_slave_matrix_sync_t smatrix;
+#endif  // SPLIT_STATE_FRAME_ENABLE
 
 #ifdef SPLIT_TRANSPORT_MIRROR
     split_master_matrix_sync_t mmatrix;
@@ -129,49 +199,57 @@ typedef struct _split_shared_memory_t {
     split_slave_encoder_sync_t encoders;
 #endif  // ENCODER_ENABLE
 
+#if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+    split_slave_pointing_sync_t pointing;
+    uint16_t                    pointing_cpi;
+    bool                        pointing_synced;
+#endif  // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
+
 #ifndef DISABLE_SYNC_TIMER
     uint32_t sync_timer;
 #endif  // DISABLE_SYNC_TIMER
 
-#if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#ifndef SPLIT_STATE_FRAME_ENABLE
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
     split_layers_sync_t layers;
-#endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+#    endif  // !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
 
-#ifdef SPLIT_LED_STATE_ENABLE
+#    ifdef SPLIT_LED_STATE_ENABLE
     uint8_t led_state;
-#endif  // SPLIT_LED_STATE_ENABLE
+#    endif  // SPLIT_LED_STATE_ENABLE
 
-#ifdef SPLIT_MODS_ENABLE
+#    ifdef SPLIT_MODS_ENABLE
     split_mods_sync_t mods;
-#endif  // SPLIT_MODS_ENABLE
+#    endif  // SPLIT_MODS_ENABLE
 
-#ifdef BACKLIGHT_ENABLE
+#    ifdef BACKLIGHT_ENABLE
     uint8_t backlight_level;
-#endif  // BACKLIGHT_ENABLE
+#    endif  // BACKLIGHT_ENABLE
 
-#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     rgblight_syncinfo_t rgblight_sync;
-#endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
-#if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
     led_matrix_sync_t led_matrix_sync;
-#endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#    endif  // defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
 
-#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     rgb_matrix_sync_t rgb_matrix_sync;
-#endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    endif  // defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
 
-#if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
     uint8_t current_wpm;
-#endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+#    endif  // defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
 
-#if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
     uint8_t current_oled_state;
-#endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+#    endif  // defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
 
-#if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
     uint8_t current_st7565_state;
-#endif  // ST7565_ENABLE(OLED_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+#    endif  // ST7565_ENABLE(OLED_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+#endif  // SPLIT_STATE_FRAME_ENABLE
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
     rpc_sync_info_t rpc_info;
@@ -0,0 +1,117 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "transport_stats.h"
+#include "transaction_id_define.h"
+#include "bitwise.h"
+#include "timer.h"
+#include "debug.h"
+#include "print.h"
+
+#ifndef SPLIT_TRANSPORT_STATS_PRINT_INTERVAL
+#    define SPLIT_TRANSPORT_STATS_PRINT_INTERVAL 10000
+#endif
+
+static split_transport_stats_t stats[NUM_TOTAL_TRANSACTIONS];
+static uint32_t                link_history = 0;  // one bit per sync attempt, most recent in bit 0, set on success
+static uint8_t                 link_samples = 0;
+
+__attribute__((weak)) uint32_t split_transport_stats_timestamp(void) { return timer_read32() * 1000; }
+
+void split_transport_stats_record(int8_t id, bool okay, bool retry, uint16_t bytes, uint32_t round_trip_us) {
+    if (id < 0 || id >= NUM_TOTAL_TRANSACTIONS) {
+        return;
+    }
+
+    split_transport_stats_t *entry = &stats[id];
+    entry->attempts++;
+    if (!okay) {
+        entry->failures++;
+    }
+    if (retry) {
+        entry->retries++;
+    }
+    entry->bytes += bytes;
+    if (round_trip_us > entry->max_round_trip_us) {
+        entry->max_round_trip_us = round_trip_us;
+    }
+}
+
+void split_transport_stats_record_sync(bool okay) {
+    link_history = (link_history << 1) | (okay ? 1 : 0);
+    if (link_samples < 32) {
+        link_samples++;
+    }
+}
+
+bool split_transport_stats_get(int8_t id, split_transport_stats_t *out) {
+    if (id == SPLIT_TRANSPORT_STATS_TOTAL) {
+        memset(out, 0, sizeof(*out));
+        for (uint8_t i = 0; i < NUM_TOTAL_TRANSACTIONS; i++) {
+            out->attempts += stats[i].attempts;
+            out->failures += stats[i].failures;
+            out->retries += stats[i].retries;
+            out->bytes += stats[i].bytes;
+            if (stats[i].max_round_trip_us > out->max_round_trip_us) {
+                out->max_round_trip_us = stats[i].max_round_trip_us;
+            }
+        }
+        return true;
+    }
+
+    if (id < 0 || id >= NUM_TOTAL_TRANSACTIONS) {
+        memset(out, 0, sizeof(*out));
+        return false;
+    }
+
+    *out = stats[id];
+    return true;
+}
+
+uint8_t split_transport_link_quality(void) {
+    if (link_samples == 0) {
+        return 100;
+    }
+    uint32_t mask = link_samples < 32 ? (1UL << link_samples) - 1 : UINT32_MAX;
+    return bitpop32(link_history & mask) * 100 / link_samples;
+}
+
+void split_transport_stats_reset(void) {
+    memset(stats, 0, sizeof(stats));
+    link_history = 0;
+    link_samples = 0;
+}
+
+void split_transport_stats_get_raw(int8_t id, uint8_t *data) {
+    split_transport_stats_t entry;
+    split_transport_stats_get(id, &entry);
+    const uint32_t values[] = {entry.attempts, entry.failures, entry.retries, entry.bytes, entry.max_round_trip_us};
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        *data++ = (values[i] >> 24) & 0xFF;
+        *data++ = (values[i] >> 16) & 0xFF;
+        *data++ = (values[i] >> 8) & 0xFF;
+        *data++ = values[i] & 0xFF;
+    }
+    *data = split_transport_link_quality();
+}
+
+void split_transport_stats_print(void) {
+#if !defined(NO_DEBUG) && !defined(NO_PRINT)
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+        const split_transport_stats_t *entry = &stats[id];
+        if (entry->attempts) {
+            dprintf("split transaction %u: n=%lu fail=%lu retry=%lu bytes=%lu max=%luus\n", id, entry->attempts, entry->failures, entry->retries, entry->bytes, entry->max_round_trip_us);
+        }
+    }
+    dprintf("split link quality: %u%%\n", split_transport_link_quality());
+#endif
+}
+
+void split_transport_stats_task(void) {
+    static uint32_t last_print = 0;
+    if (debug_enable && timer_elapsed32(last_print) > SPLIT_TRANSPORT_STATS_PRINT_INTERVAL) {
+        last_print = timer_read32();
+        split_transport_stats_print();
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Counters for one split transaction ID, as seen by the master.
+typedef struct {
+    uint32_t attempts;           // transactions executed
+    uint32_t failures;           // transactions the transport reported as failed
+    uint32_t retries;            // transactions executed while retrying a failed handler
+    uint32_t bytes;              // payload bytes transferred in both directions
+    uint32_t max_round_trip_us;  // worst-case time spent in the transport
+} split_transport_stats_t;
+
+// Pseudo transaction ID selecting the totals over all transaction IDs.
+#define SPLIT_TRANSPORT_STATS_TOTAL -1
+
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+
+// Records the outcome of one transaction. Should not be invoked by keyboard/user code.
+void split_transport_stats_record(int8_t id, bool okay, bool retry, uint16_t bytes, uint32_t round_trip_us);
+
+// Records the outcome of one attempt to sync a feature, including the validation of the received data.
+// Should not be invoked by keyboard/user code.
+void split_transport_stats_record_sync(bool okay);
+
+// Fills in the counters of a transaction ID, or of SPLIT_TRANSPORT_STATS_TOTAL.
+//  -- Return value: false if the ID is invalid
+bool split_transport_stats_get(int8_t id, split_transport_stats_t *stats);
+
+// Percentage of the last 32 sync attempts that succeeded, 100 if there were none yet.
+// Unlike the failure counters, this includes data that arrived corrupted.
+uint8_t split_transport_link_quality(void);
+
+// Clears all counters and the link-quality history.
+void split_transport_stats_reset(void);
+
+// Serialises the counters of a transaction ID for raw HID, as five big endian 32-bit values:
+// attempts, failures, retries, bytes, max round trip. Followed by the link quality byte.
+void split_transport_stats_get_raw(int8_t id, uint8_t *data);
+
+// Prints the counters of every transaction ID that was used, and the link quality, to the console.
+void split_transport_stats_print(void);
+
+// Time source for round trips in microseconds, defaults to timer_read32() * 1000. Can be overridden for a finer resolution.
+uint32_t split_transport_stats_timestamp(void);
+
+// Prints the counters periodically when debugging is enabled. Should not be invoked by keyboard/user code.
+void split_transport_stats_task(void);
+
+#else
+
+#    define split_transport_stats_reset()
+#    define split_transport_stats_print()
+#    define split_transport_stats_task()
+
+#endif
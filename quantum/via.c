@@ -47,6 +47,13 @@
 #include "eeprom.h"
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
 #include "via_ensure_keycode.h"
+#include "latency_trace.h"
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+#    include "transport_stats.h"
+#endif
+#ifdef VIA_BULK_TRANSFER_ENABLE
+#    include "via_bulk.h"
+#endif
 
 // Forward declare some helpers.
 #if defined(VIA_QMK_BACKLIGHT_ENABLE)
@@ -102,6 +109,9 @@ void via_init(void) {
     if (!via_eeprom_is_valid()) {
         eeconfig_init_via();
     }
+
+    // Mirror the keymaps into RAM now, rather than on the first keypress.
+    dynamic_keymap_cache_load();
 }
 
 void eeconfig_init_via(void) {
@@ -241,6 +251,20 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
 #endif
                     break;
                 }
+#ifdef LATENCY_TRACE_ENABLE
+                case id_latency_trace_stats: {
+                    // command_data[1] selects the stage
+                    latency_trace_get_stats_raw(command_data[1], &command_data[2]);
+                    break;
+                }
+#endif
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+                case id_split_transport_stats: {
+                    // command_data[1] selects the transaction ID, 0xFF for the totals
+                    split_transport_stats_get_raw((int8_t)command_data[1], &command_data[2]);
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -255,6 +279,18 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
                     via_set_layout_options(value);
                     break;
                 }
+#ifdef LATENCY_TRACE_ENABLE
+                case id_latency_trace_stats: {
+                    latency_trace_reset();
+                    break;
+                }
+#endif
+#ifdef SPLIT_TRANSPORT_STATS_ENABLE
+                case id_split_transport_stats: {
+                    split_transport_stats_reset();
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -373,6 +409,20 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
             dynamic_keymap_set_buffer(offset, size, &command_data[3]);
             break;
         }
+#ifdef VIA_BULK_TRANSFER_ENABLE
+        case id_dynamic_keymap_bulk_begin: {
+            via_bulk_begin(command_data);
+            break;
+        }
+        case id_dynamic_keymap_bulk_data: {
+            via_bulk_data(command_data);
+            break;
+        }
+        case id_dynamic_keymap_bulk_commit: {
+            via_bulk_commit(command_data);
+            break;
+        }
+#endif
         default: {
             // The command ID is not known
             // Return the unhandled state
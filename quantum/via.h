@@ -78,13 +78,18 @@ enum via_command_id {
     id_dynamic_keymap_get_layer_count       = 0x11,
     id_dynamic_keymap_get_buffer            = 0x12,
     id_dynamic_keymap_set_buffer            = 0x13,
+    id_dynamic_keymap_bulk_begin            = 0x80,  // QMK extension, requires VIA_BULK_TRANSFER_ENABLE
+    id_dynamic_keymap_bulk_data             = 0x81,
+    id_dynamic_keymap_bulk_commit           = 0x82,
     id_unhandled                            = 0xFF,
 };
 
 enum via_keyboard_value_id {
-    id_uptime              = 0x01,  //
-    id_layout_options      = 0x02,
-    id_switch_matrix_state = 0x03
+    id_uptime                = 0x01,  //
+    id_layout_options        = 0x02,
+    id_switch_matrix_state   = 0x03,
+    id_latency_trace_stats   = 0x80,  // QMK extension, requires LATENCY_TRACE_ENABLE
+    id_split_transport_stats = 0x81,  // QMK extension, requires SPLIT_TRANSPORT_STATS_ENABLE
 };
 
 enum via_lighting_value {
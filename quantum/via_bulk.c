@@ -0,0 +1,101 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <stdbool.h>
+#include <string.h>
+#include "config.h"
+#include "crc.h"
+#include "dynamic_keymap.h"
+#include "via_bulk.h"
+
+#ifndef DYNAMIC_KEYMAP_LAYER_COUNT
+#    define DYNAMIC_KEYMAP_LAYER_COUNT 4
+#endif
+
+#define DYNAMIC_KEYMAP_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
+// Sequence numbers are 8 bit, old and new reports must stay distinguishable
+_Static_assert(VIA_BULK_WINDOW > 0 && VIA_BULK_WINDOW < 128, "VIA_BULK_WINDOW must be between 1 and 127");
+_Static_assert(VIA_BULK_BUFFER_SIZE <= DYNAMIC_KEYMAP_SIZE, "VIA_BULK_BUFFER_SIZE is larger than the dynamic keymap");
+_Static_assert(VIA_BULK_COMMIT_CHUNK_SIZE > 0, "VIA_BULK_COMMIT_CHUNK_SIZE must be at least 1");
+
+static uint8_t  buffer[VIA_BULK_BUFFER_SIZE];
+static uint16_t transfer_offset;
+static uint16_t transfer_size;
+static uint16_t received;
+static uint8_t  next_sequence;
+static bool     active = false;
+
+void via_bulk_begin(uint8_t *data) {
+    uint16_t offset = (data[0] << 8) | data[1];
+    uint16_t size   = (data[2] << 8) | data[3];
+
+    // A new begin always abandons the previous transfer
+    active = false;
+    if (size == 0 || size > VIA_BULK_BUFFER_SIZE || offset >= DYNAMIC_KEYMAP_SIZE || size > DYNAMIC_KEYMAP_SIZE - offset) {
+        data[0] = VIA_BULK_ERROR_RANGE;
+    } else {
+        transfer_offset = offset;
+        transfer_size   = size;
+        received        = 0;
+        next_sequence   = 0;
+        active          = true;
+        data[0]         = VIA_BULK_OK;
+    }
+    data[1] = VIA_BULK_WINDOW;
+    data[2] = VIA_BULK_PAYLOAD_SIZE;
+    data[3] = VIA_BULK_BUFFER_SIZE >> 8;
+    data[4] = VIA_BULK_BUFFER_SIZE & 0xFF;
+}
+
+void via_bulk_data(uint8_t *data) {
+    uint8_t sequence = data[0];
+    uint8_t status;
+
+    if (!active) {
+        status = VIA_BULK_ERROR_STATE;
+    } else if (sequence == next_sequence) {
+        if (received == transfer_size) {
+            status = VIA_BULK_ERROR_RANGE;
+        } else {
+            uint16_t length = transfer_size - received < VIA_BULK_PAYLOAD_SIZE ? transfer_size - received : VIA_BULK_PAYLOAD_SIZE;
+            memcpy(&buffer[received], &data[1], length);
+            received += length;
+            next_sequence++;
+            status = VIA_BULK_OK;
+        }
+    } else if ((uint8_t)(next_sequence - sequence) <= VIA_BULK_WINDOW) {
+        // Resent report that was already stored, the host rewound after a lost reply
+        status = VIA_BULK_OK;
+    } else {
+        // A report went missing, the host resends from next_sequence
+        status = VIA_BULK_ERROR_SEQUENCE;
+    }
+
+    data[0] = status;
+    data[1] = next_sequence;
+}
+
+void via_bulk_commit(uint8_t *data) {
+    if (!active) {
+        data[0] = VIA_BULK_ERROR_STATE;
+        return;
+    }
+    if (received != transfer_size) {
+        data[0] = VIA_BULK_ERROR_INCOMPLETE;
+        return;
+    }
+
+    uint8_t crc = crc8(buffer, transfer_size);
+    active      = false;
+    if (crc != data[0]) {
+        data[0] = VIA_BULK_ERROR_CRC;
+    } else {
+        for (uint16_t offset = 0; offset < transfer_size; offset += VIA_BULK_COMMIT_CHUNK_SIZE) {
+            uint16_t length = transfer_size - offset < VIA_BULK_COMMIT_CHUNK_SIZE ? transfer_size - offset : VIA_BULK_COMMIT_CHUNK_SIZE;
+            dynamic_keymap_set_buffer(transfer_offset + offset, length, &buffer[offset]);
+        }
+        data[0] = VIA_BULK_OK;
+    }
+    data[1] = crc;
+}
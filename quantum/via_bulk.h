@@ -0,0 +1,58 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+    Streaming upload of the dynamic keymap buffer over raw HID. The transfer
+    is staged in RAM and only written to EEPROM by the commit command, once
+    its CRC has been checked.
+
+    Largest transfer the keyboard accepts, 256 bytes or the whole keymap if
+    smaller by default. Hosts split larger keymaps into several transfers.
+    Keyboards with RAM to spare can raise it up to the keymap size.
+*/
+#ifndef VIA_BULK_BUFFER_SIZE
+#    define VIA_BULK_BUFFER_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2 < 256 ? DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2 : 256)
+#endif
+
+/*
+    Bytes written to EEPROM per dynamic_keymap_set_buffer() call on commit.
+    EEPROM drivers may need as much stack as they are given data at once,
+    and the commit runs within the raw HID handler.
+*/
+#ifndef VIA_BULK_COMMIT_CHUNK_SIZE
+#    define VIA_BULK_COMMIT_CHUNK_SIZE 64
+#endif
+
+/*
+    Number of data reports the host may send before waiting for a reply.
+*/
+#ifndef VIA_BULK_WINDOW
+#    define VIA_BULK_WINDOW 8
+#endif
+
+/* 32 byte report minus the command ID and the sequence number */
+#define VIA_BULK_PAYLOAD_SIZE 30
+
+enum via_bulk_status {
+    VIA_BULK_OK               = 0x00,
+    VIA_BULK_ERROR_RANGE      = 0x01,  // transfer does not fit the keymap or the staging buffer
+    VIA_BULK_ERROR_SEQUENCE   = 0x02,  // data report out of order, resend from the expected sequence number
+    VIA_BULK_ERROR_INCOMPLETE = 0x03,  // commit before all data was received
+    VIA_BULK_ERROR_CRC        = 0x04,  // CRC mismatch, the transfer was dropped
+    VIA_BULK_ERROR_STATE      = 0x05,  // no transfer in progress
+};
+
+/*
+    Each takes the command data of the report and overwrites it with the reply.
+
+    begin:  offset (2), size (2)   -> status, window, payload size, buffer size (2)
+    data:   sequence, payload (30) -> status, next expected sequence
+    commit: crc8 of the transfer   -> status, crc8 of the staged data
+*/
+void via_bulk_begin(uint8_t *data);
+void via_bulk_data(uint8_t *data);
+void via_bulk_commit(uint8_t *data);
@@ -1,8 +1,16 @@
 TEST_LIST = $(sort $(patsubst %/test.mk,%, $(shell find $(ROOT_DIR)tests -type f -name test.mk)))
 FULL_TESTS := $(notdir $(TEST_LIST))
 
+include $(DRIVER_PATH)/eeprom/tests/testlist.mk
+include $(DRIVER_PATH)/led/tests/testlist.mk
 include $(QUANTUM_PATH)/debounce/tests/testlist.mk
+include $(QUANTUM_PATH)/dynamic_keymap/tests/testlist.mk
+include $(QUANTUM_PATH)/latency_trace/tests/testlist.mk
+include $(QUANTUM_PATH)/matrix/tests/testlist.mk
+include $(QUANTUM_PATH)/rgb_matrix/tests/testlist.mk
 include $(QUANTUM_PATH)/sequencer/tests/testlist.mk
+include $(QUANTUM_PATH)/split_common/tests/testlist.mk
+include $(TMK_PATH)/protocol/tests/testlist.mk
 include $(PLATFORM_PATH)/test/testlist.mk
 
 define VALIDATE_TEST_LIST
@@ -15,6 +15,7 @@
  */
 
 #include "keycode.h"
+#include "keyboard_report_util.hpp"
 #include "test_common.hpp"
 
 using testing::_;
@@ -57,6 +58,7 @@ TEST_F(KeyPress, ANonMappedKeyDoesNothing) {
 
 TEST_F(KeyPress, CorrectKeysAreReportedWhenTwoKeysArePressed) {
     TestDriver driver;
+    InSequence s;
     auto       key_b = KeymapKey(0, 0, 0, KC_B);
     auto       key_c = KeymapKey(0, 1, 1, KC_C);
 
@@ -64,26 +66,21 @@ TEST_F(KeyPress, CorrectKeysAreReportedWhenTwoKeysArePressed) {
 
     key_b.press();
     key_c.press();
-    // Note that QMK only processes one key at a time
-    // See issue #1476 for more information
+    // All keys that changed in the same scan are processed in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_b.report_code)));
-    keyboard_task();
-
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_b.report_code, key_c.report_code)));
     keyboard_task();
 
     key_b.release();
     key_c.release();
-    // Note that the first key released is the first one in the matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_c.report_code)));
-    keyboard_task();
-
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
 }
 
 TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
     TestDriver driver;
+    InSequence s;
     auto       key_a    = KeymapKey(0, 0, 0, KC_A);
     auto       key_lsft = KeymapKey(0, 3, 0, KC_LSFT);
 
@@ -92,10 +89,8 @@ TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
     key_lsft.press();
     key_a.press();
 
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // All keys that changed in the same scan are processed in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_a.report_code)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_a.report_code, key_lsft.report_code)));
     keyboard_task();
 
@@ -110,6 +105,7 @@ TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
 
 TEST_F(KeyPress, PressLeftShiftAndControl) {
     TestDriver driver;
+    InSequence s;
     auto       key_lsft  = KeymapKey(0, 3, 0, KC_LSFT);
     auto       key_lctrl = KeymapKey(0, 5, 0, KC_LCTRL);
 
@@ -118,11 +114,8 @@ TEST_F(KeyPress, PressLeftShiftAndControl) {
     key_lsft.press();
     key_lctrl.press();
 
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // All keys that changed in the same scan are processed in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_lsft.report_code)));
-    keyboard_task();
-
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_lsft.report_code, key_lctrl.report_code)));
     keyboard_task();
 
@@ -130,14 +123,13 @@ TEST_F(KeyPress, PressLeftShiftAndControl) {
     key_lctrl.release();
 
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_lctrl.report_code)));
-    keyboard_task();
-
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
 }
 
 TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
     TestDriver driver;
+    InSequence s;
     auto       key_lsft = KeymapKey(0, 3, 0, KC_LSFT);
     auto       key_rsft = KeymapKey(0, 4, 0, KC_RSFT);
 
@@ -145,11 +137,8 @@ TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
 
     key_lsft.press();
     key_rsft.press();
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // All keys that changed in the same scan are processed in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_lsft.report_code)));
-    keyboard_task();
-
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_lsft.report_code, key_rsft.report_code)));
     keyboard_task();
 
@@ -157,10 +146,48 @@ TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
     key_rsft.release();
 
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key_rsft.report_code)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
+}
 
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+TEST_F(KeyPress, TenSimultaneousKeysAreReportedInOneScan) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a    = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b    = KeymapKey(0, 1, 0, KC_B);
+    auto       key_c    = KeymapKey(0, 2, 0, KC_C);
+    auto       key_d    = KeymapKey(0, 3, 0, KC_D);
+    auto       key_e    = KeymapKey(0, 4, 0, KC_E);
+    auto       key_f    = KeymapKey(0, 5, 0, KC_F);
+    auto       key_lctl = KeymapKey(0, 0, 1, KC_LCTL);
+    auto       key_lsft = KeymapKey(0, 1, 1, KC_LSFT);
+    auto       key_lalt = KeymapKey(0, 2, 1, KC_LALT);
+    auto       key_lgui = KeymapKey(0, 3, 1, KC_LGUI);
+    std::vector<KeymapKey> keys = {key_a, key_b, key_c, key_d, key_e, key_f, key_lctl, key_lsft, key_lalt, key_lgui};
+
+    set_keymap({key_a, key_b, key_c, key_d, key_e, key_f, key_lctl, key_lsft, key_lalt, key_lgui});
+
+    /* Every press is reported, in matrix order, during a single scan */
+    std::vector<uint8_t> report;
+    for (auto& key : keys) {
+        key.press();
+        report.push_back(key.report_code);
+        EXPECT_CALL(driver, send_keyboard_mock(testing::MakeMatcher(new KeyboardReportMatcher(report))));
+    }
+    keyevent_queue_clear_stats();
     keyboard_task();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(keyevent_queue_get_max_depth(), keys.size());
+    EXPECT_EQ(keyevent_queue_get_max_latency(), 0);
+
+    /* Same for the releases */
+    for (auto& key : keys) {
+        key.release();
+        report.erase(report.begin());
+        EXPECT_CALL(driver, send_keyboard_mock(testing::MakeMatcher(new KeyboardReportMatcher(report))));
+    }
+    keyboard_task();
+    testing::Mock::VerifyAndClearExpectations(&driver);
 }
 
 TEST_F(KeyPress, RightShiftLeftControlAndCharWithTheSameKey) {
@@ -0,0 +1,194 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+#define FILLER_COUNT (COMBO_COUNT - 3)
+
+/* Filler combos of two or three letters and digits, then a few combos on the F keys for the tests */
+static const uint16_t filler_pool[] = {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0};
+#define FILLER_POOL_SIZE (sizeof(filler_pool) / sizeof(filler_pool[0]))
+
+static uint16_t filler_keys[FILLER_COUNT][4];
+static const uint16_t PROGMEM f1_f2[]    = {KC_F1, KC_F2, COMBO_END};
+static const uint16_t PROGMEM f1_f2_f3[] = {KC_F1, KC_F2, KC_F3, COMBO_END};
+static const uint16_t PROGMEM f4_f4[]    = {KC_F4, KC_F6, KC_F4, COMBO_END};
+
+extern "C" {
+combo_t key_combos[COMBO_COUNT];
+}
+
+static struct ComboSetup {
+    ComboSetup() {
+        for (int i = 0; i < FILLER_COUNT; i++) {
+            int first         = i % FILLER_POOL_SIZE;
+            int round         = i / FILLER_POOL_SIZE;
+            filler_keys[i][0] = filler_pool[first];
+            filler_keys[i][1] = filler_pool[(first + round + 1) % FILLER_POOL_SIZE];
+            filler_keys[i][2] = (i % 2) ? filler_pool[(first + 2 * round + 13) % FILLER_POOL_SIZE] : COMBO_END;
+            filler_keys[i][3] = COMBO_END;
+            key_combos[i]     = COMBO(filler_keys[i], KC_ENT);
+        }
+        key_combos[FILLER_COUNT]     = COMBO(f1_f2, KC_ESC);
+        key_combos[FILLER_COUNT + 1] = COMBO(f1_f2_f3, KC_TAB);
+        key_combos[FILLER_COUNT + 2] = COMBO(f4_f4, KC_BSPC);
+    }
+} combo_setup;
+
+class ComboIndex : public TestFixture {};
+
+TEST_F(ComboIndex, ComboAfterHundredsOfOthersFires) {
+    TestDriver driver;
+    auto       key_f1 = KeymapKey(0, 0, 0, KC_F1);
+    auto       key_f2 = KeymapKey(0, 1, 0, KC_F2);
+
+    set_keymap({key_f1, key_f2});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    key_f1.press();
+    run_one_scan_loop();
+    key_f2.press();
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_f1.release();
+    key_f2.release();
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ComboIndex, LongerOverlappingComboWins) {
+    TestDriver driver;
+    auto       key_f1 = KeymapKey(0, 0, 0, KC_F1);
+    auto       key_f2 = KeymapKey(0, 1, 0, KC_F2);
+    auto       key_f3 = KeymapKey(0, 2, 0, KC_F3);
+
+    set_keymap({key_f1, key_f2, key_f3});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_TAB)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    key_f1.press();
+    run_one_scan_loop();
+    key_f2.press();
+    run_one_scan_loop();
+    key_f3.press();
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_f1.release();
+    key_f2.release();
+    key_f3.release();
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ComboIndex, RepeatedKeyInComboIsVisitedOnce) {
+    TestDriver driver;
+    auto       key_f4 = KeymapKey(0, 3, 0, KC_F4);
+    auto       key_f6 = KeymapKey(0, 4, 0, KC_F6);
+
+    set_keymap({key_f4, key_f6});
+
+    /* The combo can never complete, so both keys come through as themselves */
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F4)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F4, KC_F6)));
+    key_f4.press();
+    run_one_scan_loop();
+    key_f6.press();
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 1);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F6)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_f4.release();
+    run_one_scan_loop();
+    key_f6.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ComboIndex, NonComboKeyIsNotDelayed) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_f5 = KeymapKey(0, 5, 0, KC_F5);
+
+    set_keymap({key_f5});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F5)));
+    key_f5.press();
+    run_one_scan_loop();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_f5.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+/* Time of a tap of a key that is in no combo, against the key list walk every event used to make */
+TEST_F(ComboIndex, Benchmark) {
+    TestDriver driver;
+    auto       key_f5 = KeymapKey(0, 5, 0, KC_F5);
+
+    set_keymap({key_f5});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    const int   iterations = 20000;
+    keyrecord_t record     = {};
+    record.event.key       = key_f5.position;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        record.event.pressed = true;
+        record.event.time    = timer_read() | 1;
+        process_combo(KC_F5, &record);
+        record.event.pressed = false;
+        record.event.time    = timer_read() | 1;
+        process_combo(KC_F5, &record);
+    }
+    double indexed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    /* A tap is two events, each of which walked the key list of every combo */
+    volatile unsigned found = 0;
+    start                   = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations * 2; i++) {
+        for (int idx = 0; idx < COMBO_COUNT; idx++) {
+            for (const uint16_t* keys = key_combos[idx].keys; pgm_read_word(keys) != COMBO_END; keys++) {
+                found = found + (pgm_read_word(keys) == KC_F5);
+            }
+        }
+    }
+    double scan = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    /* Wall-clock times only inform, they vary too much between hosts to assert on */
+    test_logger.info() << COMBO_COUNT << " combos, ns per tap: indexed " << indexed << ", key list walk alone " << scan << std::endl;
+    RecordProperty("combo_index_ns_per_tap", (int)indexed);
+    RecordProperty("combo_key_list_walk_ns_per_tap", (int)scan);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
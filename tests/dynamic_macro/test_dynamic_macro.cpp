@@ -0,0 +1,355 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+using testing::InvokeWithoutArgs;
+
+#define AT_TIME(t) WillOnce(InvokeWithoutArgs([current_time]() { EXPECT_EQ(timer_elapsed32(current_time), t); }))
+
+/* The EEPROM region dynamic_keymap.c would provide */
+static uint8_t recorded_storage[DYNAMIC_MACRO_EEPROM_SIZE];
+static int     record_key_full_calls;
+static int     play_user_calls;
+
+extern "C" {
+void dynamic_keymap_recorded_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    for (uint16_t i = 0; i < size; i++) {
+        data[i] = offset + i < sizeof(recorded_storage) ? recorded_storage[offset + i] : 0;
+    }
+}
+
+void dynamic_keymap_recorded_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    for (uint16_t i = 0; i < size && offset + i < sizeof(recorded_storage); i++) {
+        recorded_storage[offset + i] = data[i];
+    }
+}
+
+void dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record) { record_key_full_calls++; }
+
+void dynamic_macro_play_user(int8_t direction) { play_user_calls++; }
+}
+
+class DynamicMacro : public TestFixture {
+   protected:
+    void SetUp() override {
+        dynamic_macro_clear();
+        record_key_full_calls = 0;
+        play_user_calls       = 0;
+    }
+
+    /* Key events are timestamped with a resolution of 2 ms */
+    void tap(KeymapKey &key) {
+        key.press();
+        idle_for(2);
+        key.release();
+        idle_for(2);
+    }
+
+    KeymapKey rec1  = KeymapKey(0, 0, 0, DM_REC1);
+    KeymapKey rec2  = KeymapKey(0, 1, 0, DM_REC2);
+    KeymapKey stop  = KeymapKey(0, 2, 0, DM_RSTP);
+    KeymapKey play1 = KeymapKey(0, 3, 0, DM_PLY1);
+    KeymapKey play2 = KeymapKey(0, 4, 0, DM_PLY2);
+    KeymapKey key_a = KeymapKey(0, 5, 0, KC_A);
+    KeymapKey key_b = KeymapKey(0, 6, 0, KC_B);
+};
+
+TEST_F(DynamicMacro, RecordsAndPlaysBackOneEventPerTick) {
+    TestDriver driver;
+
+    set_keymap({rec1, stop, play1, key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    EXPECT_TRUE(dynamic_macro_is_recording());
+    tap(key_a);
+    tap(key_b);
+    tap(stop);
+    EXPECT_FALSE(dynamic_macro_is_recording());
+    /* 3 bytes per event, and 1 for the delay of all but the first */
+    EXPECT_EQ(dynamic_macro_get_length(0), 3 + 3 * 4);
+    EXPECT_EQ(dynamic_macro_get_free(), DYNAMIC_MACRO_ARENA_SIZE - 2 * 3 - 15);
+    play1.press();
+    idle_for(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* Nothing is played back from within the key event */
+    uint32_t   current_time = timer_read32();
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).AT_TIME(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).AT_TIME(3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).AT_TIME(5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    play1.release();
+    run_one_scan_loop();
+    EXPECT_TRUE(dynamic_macro_is_playing());
+    idle_for(20);
+    EXPECT_FALSE(dynamic_macro_is_playing());
+    EXPECT_EQ(play_user_calls, 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, KeysWaitForPlaybackWithRecordedTiming) {
+    TestDriver driver;
+
+    set_keymap({rec1, stop, play1, key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    key_a.press();
+    idle_for(200);
+    key_a.release();
+    idle_for(2);
+    tap(stop);
+    /* 200 ms take two bytes */
+    EXPECT_EQ(dynamic_macro_get_length(0), 3 + 5);
+    play1.press();
+    idle_for(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    uint32_t   current_time = timer_read32();
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).AT_TIME(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).AT_TIME(201);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    /* The key typed meanwhile is processed, in one go, once the macro is done */
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).AT_TIME(202);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).AT_TIME(202);
+    play1.release();
+    idle_for(50);
+    key_b.press();
+    idle_for(50);
+    key_b.release();
+    idle_for(150);
+    EXPECT_FALSE(dynamic_macro_is_playing());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, LayerReleasedDuringPlaybackIsNotRestored) {
+    TestDriver driver;
+    auto       layer_key = KeymapKey(0, 7, 0, MO(1));
+    auto       play1_l1  = KeymapKey(1, 3, 0, DM_PLY1);
+
+    set_keymap({rec1, stop, key_a, layer_key, play1_l1});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    tap(key_a);
+    tap(stop);
+
+    layer_key.press();
+    idle_for(2);
+    tap(play1_l1);
+    EXPECT_TRUE(dynamic_macro_is_playing());
+    layer_key.release();
+    idle_for(20);
+    EXPECT_FALSE(dynamic_macro_is_playing());
+    expect_layer_state(0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, PlaysNestedMacros) {
+    TestDriver driver;
+
+    set_keymap({rec1, rec2, stop, play1, play2, key_a});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    tap(key_a);
+    tap(stop);
+    /* The play key is recorded rather than played back */
+    tap(rec2);
+    tap(play1);
+    tap(stop);
+    tap(play2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    idle_for(20);
+    EXPECT_FALSE(dynamic_macro_is_playing());
+    EXPECT_EQ(play_user_calls, 2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, MacrosShareTheArena) {
+    TestDriver driver;
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    /* Only the first two slots have keycodes */
+    dynamic_macro_record_start(2);
+    tap(key_a);
+    dynamic_macro_record_end();
+    dynamic_macro_record_start(0);
+    tap(key_b);
+    tap(key_b);
+    dynamic_macro_record_end();
+    EXPECT_EQ(dynamic_macro_get_length(2), 7);
+    EXPECT_EQ(dynamic_macro_get_length(0), 15);
+    EXPECT_EQ(dynamic_macro_get_length(1), 0);
+
+    /* Recording a slot again replaces its macro */
+    dynamic_macro_record_start(2);
+    tap(key_a);
+    tap(key_a);
+    dynamic_macro_record_end();
+    EXPECT_EQ(dynamic_macro_get_length(2), 15);
+    EXPECT_EQ(dynamic_macro_get_length(0), 15);
+    EXPECT_EQ(dynamic_macro_get_free(), DYNAMIC_MACRO_ARENA_SIZE - 3 * 3 - 30);
+
+    /* An empty recording frees its slot */
+    dynamic_macro_record_start(2);
+    dynamic_macro_record_end();
+    EXPECT_EQ(dynamic_macro_get_length(2), 0);
+    EXPECT_EQ(dynamic_macro_get_free(), DYNAMIC_MACRO_ARENA_SIZE - 2 * 3 - 15);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, FullArenaStopsRecording) {
+    TestDriver driver;
+
+    set_keymap({rec1, stop, play1, key_a});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    for (int i = 0; i < 10; i++) {
+        tap(key_a);
+    }
+    /* Trailing key-down events are not kept */
+    key_a.press();
+    idle_for(2);
+    tap(stop);
+    key_a.release();
+    idle_for(2);
+    EXPECT_GT(record_key_full_calls, 0);
+    EXPECT_EQ(dynamic_macro_get_length(0), 3 + 13 * 4);
+    EXPECT_EQ(dynamic_macro_get_free(), DYNAMIC_MACRO_ARENA_SIZE - 2 * 3 - 55);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* The macro only ends on a key-up event */
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    for (int i = 0; i < 7; i++) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap(play1);
+    idle_for(30);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, MacrosAreSavedAndLoaded) {
+    TestDriver driver;
+
+    set_keymap({rec1, stop, play1, key_a});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(rec1);
+    tap(key_a);
+    tap(stop);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* As after a power cycle */
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 7);
+
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap(play1);
+    idle_for(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, InvalidSavedMacrosAreDropped) {
+    TestDriver driver;
+
+    set_keymap({key_a});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    dynamic_macro_record_start(0);
+    tap(key_a);
+    dynamic_macro_record_end();
+    dynamic_macro_record_start(1);
+    tap(key_a);
+    dynamic_macro_record_end();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* A save that was interrupted */
+    uint8_t magic       = recorded_storage[0];
+    recorded_storage[0] = 0;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 0);
+    EXPECT_EQ(dynamic_macro_get_free(), DYNAMIC_MACRO_ARENA_SIZE - 3);
+
+    /* The saved macros are kept up to the first one that does not make sense */
+    recorded_storage[0] = magic;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 7);
+    EXPECT_EQ(dynamic_macro_get_length(1), 7);
+    recorded_storage[3 + 3 + 7 + 1] += 1;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 7);
+    EXPECT_EQ(dynamic_macro_get_length(1), 0);
+
+    /* A length that does not end on an event boundary */
+    recorded_storage[3 + 3 + 7 + 1] -= 1;
+    recorded_storage[3 + 1] += 1;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 0);
+    EXPECT_EQ(dynamic_macro_get_length(1), 0);
+    recorded_storage[3 + 1] = DYNAMIC_MACRO_ARENA_SIZE;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 0);
+}
+
+TEST_F(DynamicMacro, TruncatedSavedMacroIsNotPlayed) {
+    TestDriver driver;
+
+    set_keymap({play1, key_a});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    dynamic_macro_record_start(0);
+    tap(key_a);
+    dynamic_macro_record_end();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* Cut off within the release of A */
+    recorded_storage[3 + 1] = 5;
+    dynamic_macro_init();
+    EXPECT_EQ(dynamic_macro_get_length(0), 0);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap(play1);
+    idle_for(10);
+    EXPECT_FALSE(dynamic_macro_is_playing());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
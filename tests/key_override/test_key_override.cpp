@@ -0,0 +1,202 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <deque>
+#include <vector>
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+
+/* The ko_make_* initializers are not valid C++, their designators are out of order */
+static key_override_t make_override(uint8_t trigger_mods, uint16_t trigger, uint16_t replacement, layer_state_t layers = ~0, uint8_t negative_mods = 0) {
+    key_override_t override    = {};
+    override.trigger           = trigger;
+    override.trigger_mods      = trigger_mods;
+    override.layers            = layers;
+    override.negative_mod_mask = negative_mods;
+    override.suppressed_mods   = trigger_mods;
+    override.replacement       = replacement;
+    override.options           = ko_options_default;
+    return override;
+}
+
+static const key_override_t shift_a_to_b         = make_override(MOD_MASK_SHIFT, KC_A, KC_B);
+static const key_override_t shift_a_to_c         = make_override(MOD_MASK_SHIFT, KC_A, KC_C);
+static const key_override_t shift_a_to_b_no_ctrl = make_override(MOD_MASK_SHIFT, KC_A, KC_B, ~0, MOD_MASK_CTRL);
+static const key_override_t shift_a_to_b_layer_1 = make_override(MOD_MASK_SHIFT, KC_A, KC_B, 1 << 1);
+static const key_override_t shift_to_x           = make_override(MOD_MASK_SHIFT, KC_NO, KC_X);
+static const key_override_t ctrl_to_esc          = make_override(MOD_MASK_CTRL, KC_NO, KC_ESC);
+static const key_override_t ctrl_z_to_y          = make_override(MOD_MASK_CTRL, KC_Z, KC_Y);
+
+class KeyOverride : public TestFixture {
+   public:
+    ~KeyOverride() { key_overrides = NULL; }
+
+    /* Keeps every list alive for the duration of the test, so that each one has its own address */
+    void use_overrides(std::initializer_list<const key_override_t*> overrides) {
+        lists_.emplace_back(overrides);
+        lists_.back().push_back(NULL);
+        key_overrides = lists_.back().data();
+    }
+
+    std::deque<std::vector<const key_override_t*>> lists_;
+};
+
+TEST_F(KeyOverride, FirstMatchingOverrideInListWins) {
+    TestDriver driver;
+    auto       key_lsft = KeymapKey(0, 0, 0, KC_LSFT);
+    auto       key_a    = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({key_lsft, key_a});
+    use_overrides({&shift_a_to_b, &shift_a_to_c});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C))).Times(0);
+    key_lsft.press();
+    run_one_scan_loop();
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    key_lsft.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* A new list takes effect immediately */
+    use_overrides({&shift_a_to_c, &shift_a_to_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(0);
+    key_lsft.press();
+    run_one_scan_loop();
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    key_lsft.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(KeyOverride, RejectedOverridesFallThroughToLaterOnes) {
+    TestDriver driver;
+    auto       key_lctl = KeymapKey(0, 0, 0, KC_LCTL);
+    auto       key_lsft = KeymapKey(0, 1, 0, KC_LSFT);
+    auto       key_a    = KeymapKey(0, 2, 0, KC_A);
+
+    set_keymap({key_lctl, key_lsft, key_a});
+    use_overrides({&shift_a_to_b_no_ctrl, &shift_a_to_b_layer_1, &shift_a_to_c});
+
+    /* The first is blocked by its negative mods, the second by its layers */
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_C))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_B))).Times(0);
+    key_lctl.press();
+    run_one_scan_loop();
+    key_lsft.press();
+    run_one_scan_loop();
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    key_lsft.release();
+    key_lctl.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(KeyOverride, ModifierOnlyOverrideActivatesOnModifier) {
+    TestDriver driver;
+    auto       key_lctl = KeymapKey(0, 0, 0, KC_LCTL);
+    auto       key_a    = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({key_lctl, key_a});
+    use_overrides({&ctrl_z_to_y, &ctrl_to_esc});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC))).Times(AtLeast(1));
+    key_lctl.press();
+    run_one_scan_loop();
+    idle_for(KEY_OVERRIDE_REPEAT_DELAY + 10);
+    key_lctl.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(KeyOverride, ModifierActivatesOverrideOfHeldTrigger) {
+    TestDriver driver;
+    auto       key_lsft = KeymapKey(0, 0, 0, KC_LSFT);
+    auto       key_a    = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({key_lsft, key_a});
+    use_overrides({&ctrl_z_to_y, &shift_a_to_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(AtLeast(1));
+    key_a.press();
+    run_one_scan_loop();
+    key_lsft.press();
+    run_one_scan_loop();
+    idle_for(KEY_OVERRIDE_REPEAT_DELAY + 10);
+    key_lsft.release();
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(KeyOverride, HeldTriggerAndModifierOnlyOverridesKeepListOrder) {
+    TestDriver driver;
+    auto       key_lsft = KeymapKey(0, 0, 0, KC_LSFT);
+    auto       key_a    = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({key_lsft, key_a});
+
+    /* Shift pressed while A is held: both overrides can activate, the earlier one does */
+    use_overrides({&shift_a_to_b, &shift_to_x});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X))).Times(0);
+    key_a.press();
+    run_one_scan_loop();
+    key_lsft.press();
+    run_one_scan_loop();
+    idle_for(KEY_OVERRIDE_REPEAT_DELAY + 10);
+    key_lsft.release();
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* A modifier-only override leaves the held key registered */
+    use_overrides({&shift_to_x, &shift_a_to_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_X))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(0);
+    key_a.press();
+    run_one_scan_loop();
+    key_lsft.press();
+    run_one_scan_loop();
+    idle_for(KEY_OVERRIDE_REPEAT_DELAY + 10);
+    key_lsft.release();
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,124 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class LayerResolveCache : public TestFixture {
+   public:
+    LayerResolveCache() { layer_resolve_cache_clear(); }
+
+    /* Keymap lookups spent on a single tap of the given key */
+    unsigned tap_lookups(KeymapKey& key) {
+        unsigned before = keymap_lookups;
+        key.press();
+        run_one_scan_loop();
+        key.release();
+        run_one_scan_loop();
+        return keymap_lookups - before;
+    }
+};
+
+TEST_F(LayerResolveCache, TransparentStackIsWalkedOncePerLayerChange) {
+    TestDriver driver;
+    auto       key_a   = KeymapKey(0, 0, 0, KC_A);
+    auto       trns_l1 = KeymapKey(1, 0, 0, KC_TRNS);
+    auto       trns_l2 = KeymapKey(2, 0, 0, KC_TRNS);
+    auto       trns_l3 = KeymapKey(3, 0, 0, KC_TRNS);
+
+    set_keymap({key_a, trns_l1, trns_l2, trns_l3});
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(2);
+    layer_state_set(0b1110);
+
+    /* Cold table: the walk visits the three active layers before falling back to layer 0, exactly like the uncached path */
+    unsigned before = keymap_lookups;
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    unsigned cold = keymap_lookups - before;
+
+    /* Warm table: every further resolution is a single table read */
+    before = keymap_lookups;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    }
+    unsigned warm = keymap_lookups - before;
+
+    test_logger.info() << "keymap lookups per resolution: uncached " << cold << ", cached " << warm / 100.0 << std::endl;
+    EXPECT_EQ(cold, 3);
+    EXPECT_EQ(warm, 0);
+
+    /* Changing the layer state rebuilds the entry on its next lookup */
+    layer_state_set(0b0110);
+    before = keymap_lookups;
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    EXPECT_EQ(keymap_lookups - before, 2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(LayerResolveCache, LayerChangeInvalidatesTable) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b = KeymapKey(1, 0, 0, KC_B);
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    layer_on(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    layer_off(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(LayerResolveCache, DefaultLayerChangeInvalidatesTable) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b = KeymapKey(1, 0, 0, KC_B);
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    default_layer_set(0b10);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    default_layer_set(0b01);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_lookups(key_a);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,26 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "test_common.h"
+
+#define MOUSE_EXTENDED_REPORT
+/* one report per scan */
+#define USB_POLLING_INTERVAL_MS 1
+/* 1000 CPI worth of counts from a 1500 CPI sensor */
+#define POINTING_DEVICE_SCALE_NUMERATOR 2
+#define POINTING_DEVICE_SCALE_DENOMINATOR 3
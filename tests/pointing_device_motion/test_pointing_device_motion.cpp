@@ -0,0 +1,137 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::Invoke;
+
+/* Counts the sensor collected since the custom driver last read it */
+static int16_t sensor_x, sensor_y;
+
+extern "C" report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
+    mouse_report.x = sensor_x;
+    mouse_report.y = sensor_y;
+    sensor_x = sensor_y = 0;
+    return mouse_report;
+}
+
+class PointingDeviceMotion : public TestFixture {
+   public:
+    PointingDeviceMotion() { mouse_protocol = 1; }
+    ~PointingDeviceMotion() { mouse_protocol = 1; }
+
+    /* Moves the sensor and runs one scan */
+    void scan(int16_t x, int16_t y) {
+        sensor_x += x;
+        sensor_y += y;
+        run_one_scan_loop();
+    }
+
+    /* Scans until the motion carried over to later reports has been sent */
+    void drain() {
+        for (int i = 0; i < 1000 && reports_since_drain != 0; i++) {
+            reports_since_drain = 0;
+            scan(0, 0);
+        }
+    }
+
+    void expect_reports(TestDriver& driver) {
+        EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke([this](report_mouse_t& report) {
+            sent_x += report.x;
+            sent_y += report.y;
+            max_step = std::max(max_step, std::max(std::abs(report.x), std::abs(report.y)));
+            reports++;
+            reports_since_drain++;
+        }));
+    }
+
+    int32_t sent_x = 0, sent_y = 0;
+    int     max_step            = 0;
+    int     reports             = 0;
+    int     reports_since_drain = 1;
+};
+
+TEST_F(PointingDeviceMotion, LargeDeltasFitOneExtendedReport) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    scan(3000, -1500);
+    drain();
+    EXPECT_EQ(reports, 1);
+    EXPECT_EQ(sent_x, 2000);
+    EXPECT_EQ(sent_y, -1000);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceMotion, FractionalCountsAreKept) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    /* a third of the scaled counts would be dropped by truncating each report */
+    for (int i = 0; i < 30; i++) {
+        scan(1, -1);
+    }
+    drain();
+    EXPECT_EQ(sent_x, 20);
+    EXPECT_EQ(sent_y, -20);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceMotion, BootProtocolSplitsOverflowAcrossReports) {
+    TestDriver driver;
+    expect_reports(driver);
+    mouse_protocol = 0;
+
+    scan(3000, -1500);
+    drain();
+    EXPECT_EQ(sent_x, 2000);
+    EXPECT_EQ(sent_y, -1000);
+    EXPECT_LE(max_step, 127);
+    EXPECT_EQ(reports, (2000 + 126) / 127);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceMotion, NoMotionIsLost) {
+    for (uint8_t protocol = 0; protocol <= 1; protocol++) {
+        TestDriver driver;
+        expect_reports(driver);
+        mouse_protocol = protocol;
+        sent_x = sent_y = max_step = reports = 0;
+        reports_since_drain                   = 1;
+
+        /* fast flicks of a high CPI sensor, in both directions */
+        int64_t input_x = 0, input_y = 0;
+        srand(22);
+        for (int i = 0; i < 200; i++) {
+            int16_t x = rand() % 60001 - 30000;
+            int16_t y = rand() % 601 - 300;
+            input_x += x;
+            input_y += y;
+            scan(x, y);
+        }
+        drain();
+
+        test_logger.info() << "protocol " << (int)protocol << ": " << reports << " reports, largest step " << max_step << std::endl;
+        /* at most the fraction of a count below the scale's resolution is still held back */
+        EXPECT_LT(std::abs(input_x * 2 - sent_x * 3), 3);
+        EXPECT_LT(std::abs(input_y * 2 - sent_y * 3), 3);
+        EXPECT_LE(max_step, protocol ? MOUSE_REPORT_XY_MAX : 127);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+}
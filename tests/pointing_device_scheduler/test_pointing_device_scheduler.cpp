@@ -0,0 +1,128 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::Invoke;
+
+/* Counts the sensor collected since the custom driver last read it */
+static int16_t sensor_x;
+static uint8_t sensor_buttons;
+
+extern "C" report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
+    mouse_report.x       = sensor_x;
+    mouse_report.buttons = sensor_buttons;
+    sensor_x             = 0;
+    return mouse_report;
+}
+
+class PointingDeviceScheduler : public TestFixture {
+   public:
+    /* Moves the sensor by one count per millisecond for the given time, scanning once per millisecond */
+    void move_for(unsigned ms) {
+        for (unsigned i = 0; i < ms; i++) {
+            sensor_x++;
+            moved++;
+            run_one_scan_loop();
+        }
+    }
+
+    void expect_reports(TestDriver& driver) {
+        EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke([this](report_mouse_t& report) {
+            sent_x += report.x;
+            buttons = report.buttons;
+            reports++;
+        }));
+    }
+
+    pointing_device_stats_t measure(unsigned ms, bool moving) {
+        pointing_device_stats_t stats;
+        pointing_device_stats_reset();
+        if (moving) {
+            move_for(ms);
+        } else {
+            idle_for(ms);
+        }
+        pointing_device_get_stats(&stats);
+        test_logger.info() << "scan rate 1000 Hz, sample rate " << stats.sample_rate << " Hz, report rate " << stats.report_rate << " Hz" << std::endl;
+        return stats;
+    }
+
+    int32_t sent_x  = 0;
+    int     moved   = 0;
+    int     reports = 0;
+    uint8_t buttons = 0;
+};
+
+TEST_F(PointingDeviceScheduler, RatesFollowIntervalsNotScanRate) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    /* wake the sensor up first */
+    move_for(POINTING_DEVICE_IDLE_POLL_INTERVAL);
+    pointing_device_stats_t stats = measure(800, true);
+    EXPECT_EQ(stats.elapsed, 800);
+    EXPECT_EQ(stats.sample_rate, 1000 / POINTING_DEVICE_POLL_INTERVAL);
+    EXPECT_EQ(stats.report_rate, 1000 / USB_POLLING_INTERVAL_MS);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceScheduler, BatchedMotionIsNotLost) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    move_for(100);
+    idle_for(2 * USB_POLLING_INTERVAL_MS);
+    EXPECT_EQ(sent_x, moved);
+    EXPECT_LE(reports, 100 / USB_POLLING_INTERVAL_MS + 2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceScheduler, IdleSensorIsReadLessOften) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    move_for(10);
+    idle_for(POINTING_DEVICE_IDLE_TIMEOUT);
+    pointing_device_stats_t stats = measure(500, false);
+    EXPECT_EQ(stats.sample_rate, 1000 / POINTING_DEVICE_IDLE_POLL_INTERVAL);
+    EXPECT_EQ(stats.reports, 0);
+
+    /* the first motion brings the sensor back to its full rate */
+    stats = measure(200, true);
+    EXPECT_GE(stats.sample_rate, 1000 / POINTING_DEVICE_POLL_INTERVAL - 1000 / POINTING_DEVICE_IDLE_POLL_INTERVAL / 4);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceScheduler, ButtonChangesAreNotHeldBack) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    /* right after a motion report */
+    move_for(USB_POLLING_INTERVAL_MS);
+    int reports_before = reports;
+    sensor_buttons     = MOUSE_BTN1;
+    idle_for(POINTING_DEVICE_POLL_INTERVAL);
+    EXPECT_EQ(buttons, MOUSE_BTN1);
+    EXPECT_EQ(reports, reports_before + 1);
+
+    sensor_buttons = 0;
+    idle_for(POINTING_DEVICE_POLL_INTERVAL);
+    EXPECT_EQ(buttons, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
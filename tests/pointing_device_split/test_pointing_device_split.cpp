@@ -0,0 +1,100 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::Invoke;
+
+/* Counts the sensor collected since the custom driver last read it */
+static int16_t sensor_x, sensor_y;
+/* Which half the test plays */
+static bool master = true, left = true;
+
+extern "C" {
+report_mouse_t pointing_device_driver_get_report(report_mouse_t mouse_report) {
+    mouse_report.x = sensor_x;
+    mouse_report.y = sensor_y;
+    sensor_x = sensor_y = 0;
+    return mouse_report;
+}
+
+bool is_keyboard_master(void) { return master; }
+bool is_keyboard_left(void) { return left; }
+}
+
+class PointingDeviceSplit : public TestFixture {
+   public:
+    PointingDeviceSplit() {
+        master = true;
+        left   = true;
+    }
+
+    void expect_reports(TestDriver& driver) {
+        EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke([this](report_mouse_t& report) {
+            sent_x += report.x;
+            sent_y += report.y;
+            max_step = std::max(max_step, std::max(std::abs(report.x), std::abs(report.y)));
+            if (report.x || report.y) {
+                reports++;
+            }
+        }));
+    }
+
+    int32_t sent_x = 0, sent_y = 0;
+    int     max_step = 0;
+    int     reports  = 0;
+};
+
+TEST_F(PointingDeviceSplit, LargeSlaveMotionIsSpreadOverClampedReports) {
+    TestDriver driver;
+    expect_reports(driver);
+
+    /* What the master transaction hands over from one read of the slave */
+    pointing_device_add_shared_motion(1000, -600, 0, 0, 0);
+    idle_for(20);
+    EXPECT_EQ(sent_x, 1000);
+    EXPECT_EQ(sent_y, -600);
+    EXPECT_EQ(max_step, MOUSE_REPORT_XY_MAX);
+    EXPECT_EQ(reports, (1000 + MOUSE_REPORT_XY_MAX - 1) / MOUSE_REPORT_XY_MAX);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(PointingDeviceSplit, RightSensorIsRotatedBeforeSharing) {
+    master = false;
+    left   = false;
+
+    pointing_device_shared_t before, after;
+    pointing_device_get_shared_motion(&before);
+    sensor_x = 10;
+    sensor_y = 3;
+    idle_for(2);
+    pointing_device_get_shared_motion(&after);
+
+    /* POINTING_DEVICE_ROTATION_90_RIGHT */
+    EXPECT_EQ((int32_t)(after.x - before.x), 3);
+    EXPECT_EQ((int32_t)(after.y - before.y), -10);
+}
+
+TEST_F(PointingDeviceSplit, CpiOfTheOtherHalfIsShared) {
+    pointing_device_set_cpi_on_side(false, 800);
+    EXPECT_EQ(pointing_device_get_shared_cpi(), 800);
+
+    pointing_device_set_cpi(1200);
+    EXPECT_EQ(pointing_device_get_shared_cpi(), 1200);
+}
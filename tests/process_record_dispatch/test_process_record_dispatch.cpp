@@ -0,0 +1,87 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+/* process_record_kb, key override, dynamic tapping term, space cadet, magic and grave escape */
+#define CHAIN_LENGTH 6
+/* process_record_kb, key override and space cadet see every event */
+#define OBSERVERS 3
+
+class ProcessRecordDispatch : public TestFixture {
+   public:
+    ProcessRecordDispatch() { process_record_stats_reset(); }
+
+    /* Handler calls per event spent on a single tap of the given key */
+    double tap_calls(KeymapKey& key) {
+        process_record_stats_t stats;
+        process_record_stats_reset();
+        key.press();
+        run_one_scan_loop();
+        key.release();
+        run_one_scan_loop();
+        process_record_get_stats(&stats);
+        EXPECT_EQ(stats.events, 2);
+        return (double)stats.handler_calls / stats.events;
+    }
+};
+
+TEST_F(ProcessRecordDispatch, BasicKeycodesOnlyReachObservers) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    double calls = tap_calls(key_a);
+
+    test_logger.info() << "handler calls per event: chain " << CHAIN_LENGTH << ", table " << calls << std::endl;
+    EXPECT_EQ(calls, OBSERVERS);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ProcessRecordDispatch, FeatureKeycodeReachesItsHandler) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_grave_esc = KeymapKey(0, 0, 0, GRAVE_ESC);
+
+    set_keymap({key_grave_esc});
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_EQ(tap_calls(key_grave_esc), OBSERVERS + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ProcessRecordDispatch, HandlerReturningFalseEndsTheChain) {
+    TestDriver driver;
+    auto       key_dt_up    = KeymapKey(0, 0, 0, DT_UP);
+    uint16_t   tapping_term = g_tapping_term;
+
+    set_keymap({key_dt_up});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    /* The press is consumed by the dynamic tapping term handler, before space cadet;
+     * the release is ignored by it and carries on to the end of the chain */
+    EXPECT_EQ(tap_calls(key_dt_up), (OBSERVERS + OBSERVERS + 1) / 2.0);
+    EXPECT_EQ(g_tapping_term, tapping_term + DYNAMIC_TAPPING_TERM_INCREMENT);
+    g_tapping_term = tapping_term;
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,117 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+/* A render clock in microseconds that only moves when LEDs are set, by the cost of the current effect */
+static uint32_t fake_us;
+static uint32_t us_per_led;
+
+static void fake_init(void) {}
+static void fake_set_color(int index, uint8_t r, uint8_t g, uint8_t b) { fake_us += us_per_led; }
+static void fake_set_color_all(uint8_t r, uint8_t g, uint8_t b) { fake_us += us_per_led * DRIVER_LED_TOTAL; }
+static void fake_flush(void) {}
+
+extern "C" {
+extern const rgb_matrix_driver_t rgb_matrix_driver = {fake_init, fake_set_color, fake_set_color_all, fake_flush};
+
+led_config_t g_led_config;
+
+uint32_t rgb_matrix_render_timestamp(void) { return fake_us; }
+}
+
+/* One LED per key */
+static struct LedConfigSetup {
+    LedConfigSetup() {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint8_t i                         = row * MATRIX_COLS + col;
+                g_led_config.matrix_co[row][col] = i;
+                g_led_config.point[i]            = {(uint8_t)(col * 224 / (MATRIX_COLS - 1)), (uint8_t)(row * 64 / (MATRIX_ROWS - 1))};
+                g_led_config.flags[i]            = LED_FLAG_KEYLIGHT;
+            }
+        }
+    }
+} led_config_setup;
+
+class RgbMatrixRenderBudget : public TestFixture {
+   public:
+    /* Lets the renderer settle on the current cost, then measures a second of frames */
+    rgb_matrix_render_stats_t settle_and_measure() {
+        idle_for(1000);
+        rgb_matrix_reset_render_stats();
+        idle_for(2000);
+        rgb_matrix_render_stats_t stats;
+        rgb_matrix_get_render_stats(&stats);
+        return stats;
+    }
+};
+
+TEST_F(RgbMatrixRenderBudget, ExpensiveEffectIsSlicedToBudget) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    us_per_led = 25;
+    auto stats = settle_and_measure();
+
+    EXPECT_LE(stats.max_slice_us, RGB_MATRIX_RENDER_BUDGET_US);
+    EXPECT_GE(stats.led_process_limit, RGB_MATRIX_RENDER_BUDGET_US / us_per_led * 3 / 4);
+    EXPECT_LT(stats.led_process_limit, DRIVER_LED_TOTAL);
+    EXPECT_GT(stats.frames_per_second, 0);
+}
+
+TEST_F(RgbMatrixRenderBudget, CheapEffectRendersInOneSlice) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    us_per_led = 1;
+    auto stats = settle_and_measure();
+
+    EXPECT_EQ(stats.led_process_limit, DRIVER_LED_TOTAL);
+    EXPECT_LE(stats.max_slice_us, DRIVER_LED_TOTAL * us_per_led);
+}
+
+TEST_F(RgbMatrixRenderBudget, SlicesFollowChangingCost) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    us_per_led = 1;
+    settle_and_measure();
+
+    us_per_led = 50;
+    auto stats = settle_and_measure();
+    EXPECT_LE(stats.max_slice_us, RGB_MATRIX_RENDER_BUDGET_US);
+
+    us_per_led = 2;
+    stats      = settle_and_measure();
+    EXPECT_EQ(stats.led_process_limit, DRIVER_LED_TOTAL);
+}
+
+TEST_F(RgbMatrixRenderBudget, FramesPerSecondIsReported) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    /* Four slices per frame, each scan takes a millisecond, frames start every RGB_MATRIX_LED_FLUSH_LIMIT ms at best */
+    us_per_led = 25;
+    auto stats = settle_and_measure();
+
+    EXPECT_LE(stats.frames_per_second, 1000 / RGB_MATRIX_LED_FLUSH_LIMIT);
+    EXPECT_GE(stats.frames_per_second, 1000 / (RGB_MATRIX_LED_FLUSH_LIMIT + 8));
+}
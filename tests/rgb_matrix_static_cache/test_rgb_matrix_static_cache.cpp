@@ -0,0 +1,141 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+/* A driver that keeps the colours it was given and counts what the renderer does */
+static RGB      leds[DRIVER_LED_TOTAL];
+static unsigned set_color_calls;
+static unsigned flushes;
+static bool     caps_indicator;
+
+static void fake_init(void) {}
+static void fake_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    leds[index] = {r, g, b};
+    set_color_calls++;
+}
+static void fake_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) fake_set_color(i, r, g, b);
+}
+static void fake_flush(void) { flushes++; }
+
+extern "C" {
+extern const rgb_matrix_driver_t rgb_matrix_driver = {fake_init, fake_set_color, fake_set_color_all, fake_flush};
+
+led_config_t g_led_config;
+
+void rgb_matrix_indicators_user(void) {
+    if (caps_indicator) {
+        rgb_matrix_set_color(5, 255, 0, 0);
+    }
+}
+}
+
+/* One LED per key */
+static struct LedConfigSetup {
+    LedConfigSetup() {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint8_t i                         = row * MATRIX_COLS + col;
+                g_led_config.matrix_co[row][col] = i;
+                g_led_config.point[i]            = {(uint8_t)(col * 224 / (MATRIX_COLS - 1)), (uint8_t)(row * 64 / (MATRIX_ROWS - 1))};
+                g_led_config.flags[i]            = LED_FLAG_KEYLIGHT;
+            }
+        }
+    }
+} led_config_setup;
+
+static bool same_color(RGB a, RGB b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+class RgbMatrixStaticCache : public TestFixture {
+   public:
+    RgbMatrixStaticCache() {
+        caps_indicator = false;
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+        rgb_matrix_sethsv_noeeprom(HSV_BLUE);
+    }
+
+    /* Runs the matrix for a while, counting from zero */
+    void run_for(uint32_t ms) {
+        set_color_calls = 0;
+        flushes         = 0;
+        idle_for(ms);
+    }
+};
+
+TEST_F(RgbMatrixStaticCache, StaticEffectIsRenderedOnce) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    run_for(100);
+    EXPECT_GT(flushes, 0);
+
+    run_for(1000);
+    EXPECT_EQ(flushes, 0);
+    EXPECT_EQ(set_color_calls, 0);
+}
+
+TEST_F(RgbMatrixStaticCache, ConfigChangeRendersAgain) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    run_for(100);
+    RGB blue = leds[0];
+
+    rgb_matrix_sethsv_noeeprom(HSV_GREEN);
+    run_for(100);
+    EXPECT_GT(flushes, 0);
+    EXPECT_FALSE(same_color(leds[0], blue));
+
+    run_for(1000);
+    EXPECT_EQ(flushes, 0);
+}
+
+TEST_F(RgbMatrixStaticCache, IndicatorIsAppliedOnTopOfCachedFrame) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    run_for(100);
+    RGB effect_color = leds[5];
+
+    caps_indicator = true;
+    run_for(100);
+    EXPECT_EQ(flushes, 1);
+    EXPECT_TRUE(same_color(leds[5], {255, 0, 0}));
+    EXPECT_TRUE(same_color(leds[6], effect_color));
+
+    /* The indicator is rewritten every frame, but as long as it does not change nothing is flushed */
+    run_for(1000);
+    EXPECT_EQ(flushes, 0);
+
+    caps_indicator = false;
+    run_for(100);
+    EXPECT_EQ(flushes, 1);
+    EXPECT_TRUE(same_color(leds[5], effect_color));
+}
+
+TEST_F(RgbMatrixStaticCache, AnimatedEffectKeepsRendering) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_CYCLE_ALL);
+    run_for(1000);
+    EXPECT_GT(flushes, 1000 / (RGB_MATRIX_LED_FLUSH_LIMIT + 8));
+}
@@ -0,0 +1,135 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+using testing::InvokeWithoutArgs;
+
+#define AT_TIME(t) WillOnce(InvokeWithoutArgs([current_time]() { EXPECT_EQ(timer_elapsed32(current_time), t); }))
+
+class SendStringAsync : public TestFixture {};
+
+TEST_F(SendStringAsync, PlaysOneTransitionPerTick) {
+    TestDriver driver;
+    InSequence s;
+
+    /* Nothing is sent from within the call */
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    EXPECT_TRUE(send_string_async("aB"));
+    EXPECT_TRUE(send_string_async_active());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    uint32_t current_time = timer_read32();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).AT_TIME(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).AT_TIME(2);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).AT_TIME(3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_B))).AT_TIME(4);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).AT_TIME(5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).AT_TIME(6);
+    idle_for(20);
+    EXPECT_FALSE(send_string_async_active());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(SendStringAsync, ScanningContinuesDuringPlayback) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_lsft = KeymapKey(0, 0, 0, KC_LSFT);
+
+    set_keymap({key_lsft});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    key_lsft.press();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* The release of shift is seen between the two taps */
+    EXPECT_TRUE(send_string_async(SS_TAP(X_1) SS_DELAY(10) SS_TAP(X_2)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_1)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_2)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(5);
+    key_lsft.release();
+    idle_for(20);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(SendStringAsync, FullBufferRejectsString) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_TRUE(send_string_async("0123456789"));
+    EXPECT_EQ(send_string_async_free(), 6);
+    EXPECT_FALSE(send_string_async("0123456789"));
+    EXPECT_EQ(send_string_async_free(), 6);
+    EXPECT_TRUE(send_string_async_P(PSTR("abcdef")));
+    EXPECT_EQ(send_string_async_free(), 0);
+
+    /* Space frees up as the playback goes */
+    idle_for(5);
+    EXPECT_GT(send_string_async_free(), 0);
+    idle_for(100);
+    EXPECT_FALSE(send_string_async_active());
+    EXPECT_EQ(send_string_async_free(), 16);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(SendStringAsync, KeypressCancelsPlayback) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_f5 = KeymapKey(0, 0, 0, KC_F5);
+
+    set_keymap({key_f5});
+
+    EXPECT_TRUE(send_string_async(SS_DOWN(X_LCTL) SS_DELAY(100) "a" SS_UP(X_LCTL)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL)));
+    idle_for(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    /* The held modifier is released before the key that cancelled is pressed */
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F5)));
+    key_f5.press();
+    run_one_scan_loop();
+    EXPECT_FALSE(send_string_async_active());
+    idle_for(200);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_f5.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(SendStringAsync, TruncatedCodeIsDropped) {
+    TestDriver driver;
+
+    /* A tap code cut off before its keycode sends nothing and leaves the buffer empty */
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    const char truncated[] = {SS_QMK_PREFIX, SS_TAP_CODE, 0};
+    EXPECT_TRUE(send_string_async(truncated));
+    idle_for(10);
+    EXPECT_FALSE(send_string_async_active());
+    EXPECT_EQ(send_string_async_free(), 16);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
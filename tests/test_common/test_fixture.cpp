@@ -22,6 +22,9 @@ extern "C" {
 #include "eeconfig.h"
 #include "keyboard.h"
 #include "keymap.h"
+#ifdef DEFERRED_EXEC_ENABLE
+#    include "deferred_exec.h"
+#endif
 
 void set_time(uint32_t t);
 void advance_time(uint32_t ms);
@@ -36,6 +39,7 @@ TestFixture* TestFixture::m_this = nullptr;
  * The actual call is dynamicaly dispatched to the current active test fixture, which in turn has it's own keymap. */
 extern "C" uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t position) {
     uint16_t keycode;
+    TestFixture::m_this->keymap_lookups++;
     TestFixture::m_this->get_keycode(layer, position, &keycode);
     return keycode;
 }
@@ -147,6 +151,9 @@ void TestFixture::get_keycode(const layer_t layer, const keypos_t position, uint
 
 void TestFixture::run_one_scan_loop() {
     keyboard_task();
+#ifdef DEFERRED_EXEC_ENABLE
+    deferred_exec_task();
+#endif
     advance_time(1);
 }
 
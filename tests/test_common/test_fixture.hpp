@@ -43,6 +43,9 @@ class TestFixture : public testing::Test {
 
     void expect_layer_state(layer_t layer) const;
 
+    /* Number of keymap_key_to_keycode() calls made since this fixture was created. */
+    unsigned keymap_lookups = 0;
+
    protected:
     void                   print_test_log() const;
     std::vector<KeymapKey> keymap;
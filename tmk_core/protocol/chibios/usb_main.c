@@ -42,6 +42,8 @@
 #include "usb_device_state.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "report_queue.h"
+#include "latency_trace.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -86,6 +88,24 @@ report_mouse_t mouse_report_blank = {0};
 uint8_t extra_report_blank[3] = {0};
 #endif /* EXTRAKEY_ENABLE */
 
+/* Reports waiting for their IN endpoint, refilled from the IN callbacks */
+#ifdef SHARED_EP_ENABLE
+static report_queue_t shared_queue;
+#endif
+#ifndef KEYBOARD_SHARED_EP
+static report_queue_t keyboard_queue;
+#else
+#    define keyboard_queue shared_queue
+#endif
+#ifdef MOUSE_ENABLE
+#    ifndef MOUSE_SHARED_EP
+static report_queue_t mouse_queue;
+#    else
+#        define mouse_queue shared_queue
+#    endif
+#endif
+static uint32_t usb_report_stalls = 0;
+
 /* ---------------------------------------------------------
  *            Descriptors and USB driver objects
  * ---------------------------------------------------------
@@ -475,12 +495,15 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
             osalSysLockFromISR();
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
+            report_queue_clear(&keyboard_queue);
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
 #endif
 #if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+            report_queue_clear(&mouse_queue);
             usbInitEndpointI(usbp, MOUSE_IN_EPNUM, &mouse_ep_config);
 #endif
 #ifdef SHARED_EP_ENABLE
+            report_queue_clear(&shared_queue);
             usbInitEndpointI(usbp, SHARED_IN_EPNUM, &shared_ep_config);
 #endif
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
@@ -608,6 +631,12 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
                             usbSetupTransfer(usbp, &keyboard_protocol, 1, NULL);
                             return TRUE;
                         }
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+                        if ((usbp->setup[4] == MOUSE_INTERFACE) && (usbp->setup[5] == 0)) { /* wIndex */
+                            usbSetupTransfer(usbp, &mouse_protocol, 1, NULL);
+                            return TRUE;
+                        }
+#endif
                         break;
 
                     case HID_GET_IDLE:
@@ -646,6 +675,11 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
                                 osalSysUnlockFromISR();
                             }
                         }
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+                        if ((usbp->setup[4] == MOUSE_INTERFACE) && (usbp->setup[5] == 0)) { /* wIndex */
+                            mouse_protocol = ((usbp->setup[2]) != 0x00);                    /* LSB(wValue) */
+                        }
+#endif
                         usbSetupTransfer(usbp, NULL, 0, NULL);
                         return TRUE;
                         break;
@@ -759,6 +793,52 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
     usbConnectBus(usbp);
 }
 
+/* ---------------------------------------------------------
+ *                  Report queue functions
+ * ---------------------------------------------------------
+ */
+
+/* start transmitting the oldest queued report if the endpoint is idle
+ * called from ISR or locked state */
+static void usb_report_queue_kick_i(USBDriver *usbp, usbep_t ep, report_queue_t *queue) {
+    if (usbGetDriverStateI(usbp) != USB_ACTIVE || usbGetTransmitStatusI(usbp, ep)) {
+        return;
+    }
+    const queued_report_t *report = report_queue_pop(queue);
+    if (report == NULL) {
+        return;
+    }
+    if (report->kind == REPORT_KIND_KEYBOARD || report->kind == REPORT_KIND_NKRO) {
+        keyboard_report_sent = report->report.keyboard;
+    }
+    usbStartTransmitI(usbp, ep, (uint8_t *)queued_report_data(report), report->size);
+}
+
+/* queue a report and return without waiting for the host, unless the queue is full
+ * in that case wait for the endpoint to free a slot, at most `timeout`, or drop the report
+ * called from locked state */
+static void usb_report_submit_s(usbep_t ep, report_queue_t *queue, const queued_report_t *report, sysinterval_t timeout) {
+    /* reports left over from a suspend have nothing to restart them */
+    usb_report_queue_kick_i(&USB_DRIVER, ep, queue);
+    if (!report_queue_push(queue, report)) {
+        usb_report_stalls++;
+        do {
+            /* the IN callback starts the next report, then wakes us up.
+             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
+            if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[ep]->in_state->thread, timeout) == MSG_TIMEOUT) {
+                return;
+            }
+            /* after osalThreadSuspendTimeoutS returns USB status might have changed */
+            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+                return;
+            }
+        } while (!report_queue_push(queue, report));
+    }
+    usb_report_queue_kick_i(&USB_DRIVER, ep, queue);
+}
+
+uint32_t usb_report_stall_count(void) { return usb_report_stalls; }
+
 /* ---------------------------------------------------------
  *                  Keyboard functions
  * ---------------------------------------------------------
@@ -766,9 +846,9 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
+    osalSysLockFromISR();
+    usb_report_queue_kick_i(usbp, ep, &keyboard_queue);
+    osalSysUnlockFromISR();
 }
 #endif
 
@@ -817,7 +897,7 @@ static void keyboard_idle_timer_cb(void *arg) {
 /* LED status */
 uint8_t keyboard_leds(void) { return keyboard_led_state; }
 
-/* prepare and start sending a report IN
+/* queue a report IN, returns without waiting for the endpoint unless its queue is full
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
     osalSysLock();
@@ -825,54 +905,28 @@ void send_keyboard(report_keyboard_t *report) {
         goto unlock;
     }
 
+    queued_report_t queued = {.report.keyboard = *report};
 #ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
-        /* need to wait until the previous packet has made it through */
-        /* can rewrite this using the synchronous API, then would wait
-         * until *after* the packet has been transmitted. I think
-         * this is more efficient */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        queued.kind = REPORT_KIND_NKRO;
+        queued.size = sizeof(struct nkro_report);
+        usb_report_submit_s(SHARED_IN_EPNUM, &shared_queue, &queued, TIME_INFINITE);
     } else
 #endif /* NKRO_ENABLE */
     {  /* regular protocol */
-        /* need to wait until the previous packet has made it through */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, KEYBOARD_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        uint8_t *data, size;
+        queued.kind = REPORT_KIND_KEYBOARD;
         if (keyboard_protocol) {
-            data = (uint8_t *)report;
-            size = KEYBOARD_REPORT_SIZE;
+            queued.size = KEYBOARD_REPORT_SIZE;
         } else { /* boot protocol */
-            data = &report->mods;
-            size = 8;
+            queued.offset = &report->mods - (uint8_t *)report;
+            queued.size   = 8;
         }
-        usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
+        usb_report_submit_s(KEYBOARD_IN_EPNUM, &keyboard_queue, &queued, TIME_INFINITE);
     }
-    keyboard_report_sent = *report;
+    osalSysUnlock();
+    /* the timer is not callable from the locked state */
+    latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
+    return;
 
 unlock:
     osalSysUnlock();
@@ -888,8 +942,9 @@ unlock:
 #    ifndef MOUSE_SHARED_EP
 /* mouse IN callback hander (a mouse report has made it IN) */
 void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
+    osalSysLockFromISR();
+    usb_report_queue_kick_i(usbp, ep, &mouse_queue);
+    osalSysUnlockFromISR();
 }
 #    endif
 
@@ -900,17 +955,15 @@ void send_mouse(report_mouse_t *report) {
         return;
     }
 
-    if (usbGetTransmitStatusI(&USB_DRIVER, MOUSE_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[MOUSE_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
+    /* consecutive motion with the same buttons is merged while the endpoint is busy */
+    queued_report_t queued = {.report.mouse = *report, .kind = REPORT_KIND_MOUSE, .size = sizeof(report_mouse_t)};
+#    if defined(MOUSE_EXTENDED_REPORT) && !defined(MOUSE_SHARED_EP)
+    if (!mouse_protocol) {
+        /* boot protocol hosts ignore the report descriptor, the pointing device keeps X/Y within 8 bits for them */
+        queued = (queued_report_t){.report.mouse_boot = {.buttons = report->buttons, .x = report->x, .y = report->y}, .kind = REPORT_KIND_MOUSE_BOOT, .size = sizeof(report_mouse_boot_t)};
     }
-    usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
+#    endif
+    usb_report_submit_s(MOUSE_IN_EPNUM, &mouse_queue, &queued, TIME_MS2I(10));
     osalSysUnlock();
 }
 
@@ -925,9 +978,9 @@ void send_mouse(report_mouse_t *report) { (void)report; }
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
 void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
+    osalSysLockFromISR();
+    usb_report_queue_kick_i(usbp, ep, &shared_queue);
+    osalSysUnlockFromISR();
 }
 #endif
 
@@ -944,21 +997,8 @@ static void send_extra(uint8_t report_id, uint16_t data) {
         return;
     }
 
-    if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-
-    static report_extra_t report;
-    report = (report_extra_t){.report_id = report_id, .usage = data};
-
-    usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
+    queued_report_t queued = {.report.extra = {.report_id = report_id, .usage = data}, .kind = REPORT_KIND_EXTRA, .size = sizeof(report_extra_t)};
+    usb_report_submit_s(SHARED_IN_EPNUM, &shared_queue, &queued, TIME_MS2I(10));
     osalSysUnlock();
 }
 #endif
@@ -48,6 +48,14 @@ void usb_event_queue_init(void);
 /* Task to dequeue and execute any handlers for the USB events on the main thread */
 void usb_event_queue_task(void);
 
+/* ----------------
+ * HID report queue
+ * ----------------
+ */
+
+/* Number of reports that found their endpoint queue full and had to wait for the host */
+uint32_t usb_report_stall_count(void);
+
 /* ---------------
  * Keyboard header
  * ---------------
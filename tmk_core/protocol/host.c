@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "debug.h"
 #include "digitizer.h"
+#include "latency_trace.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -34,6 +35,8 @@ static uint16_t       last_system_report              = 0;
 static uint16_t       last_consumer_report            = 0;
 static uint32_t       last_programmable_button_report = 0;
 
+uint8_t mouse_protocol = 1;
+
 void host_set_driver(host_driver_t *d) { driver = d; }
 
 host_driver_t *host_get_driver(void) { return driver; }
@@ -70,6 +73,7 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+    latency_trace_mark(LATENCY_STAGE_HOST_SEND);
     (*driver->send_keyboard)(report);
 
     if (debug_keyboard) {
@@ -53,6 +53,7 @@
 #include "lufa.h"
 #include "quantum.h"
 #include "usb_device_state.h"
+#include "latency_trace.h"
 #include <util/atomic.h>
 
 #ifdef NKRO_ENABLE
@@ -625,6 +626,16 @@ void EVENT_USB_Device_ControlRequest(void) {
                     Endpoint_ClearIN();
                     Endpoint_ClearStatusStage();
                 }
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+                if (USB_ControlRequest.wIndex == MOUSE_INTERFACE) {
+                    Endpoint_ClearSETUP();
+                    while (!(Endpoint_IsINReady()))
+                        ;
+                    Endpoint_Write_8(mouse_protocol);
+                    Endpoint_ClearIN();
+                    Endpoint_ClearStatusStage();
+                }
+#endif
             }
 
             break;
@@ -637,6 +648,14 @@ void EVENT_USB_Device_ControlRequest(void) {
                     keyboard_protocol = (USB_ControlRequest.wValue & 0xFF);
                     clear_keyboard();
                 }
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+                if (USB_ControlRequest.wIndex == MOUSE_INTERFACE) {
+                    Endpoint_ClearSETUP();
+                    Endpoint_ClearStatusStage();
+
+                    mouse_protocol = (USB_ControlRequest.wValue & 0xFF);
+                }
+#endif
             }
 
             break;
@@ -726,6 +745,7 @@ static void send_keyboard(report_keyboard_t *report) {
     Endpoint_ClearIN();
 
     keyboard_report_sent = *report;
+    latency_trace_mark(LATENCY_STAGE_USB_SUBMIT);
 }
 
 /** \brief Send Mouse
@@ -764,7 +784,14 @@ static void send_mouse(report_mouse_t *report) {
     if (!Endpoint_IsReadWriteAllowed()) return;
 
     /* Write Mouse Report Data */
-    Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
+#    if defined(MOUSE_EXTENDED_REPORT) && !defined(MOUSE_SHARED_EP)
+    if (!mouse_protocol) {
+        /* boot protocol hosts ignore the report descriptor, the pointing device keeps X/Y within 8 bits for them */
+        report_mouse_boot_t boot_report = {.buttons = report->buttons, .x = report->x, .y = report->y};
+        Endpoint_Write_Stream_LE(&boot_report, sizeof(report_mouse_boot_t), NULL);
+    } else
+#    endif
+        Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
@@ -201,16 +201,37 @@ typedef struct {
     uint32_t usage;
 } __attribute__((packed)) report_programmable_button_t;
 
+/*
+ * MOUSE_EXTENDED_REPORT widens X/Y to 16 bits, so that high resolution sensors
+ * are not clipped at 127 counts per report.
+ */
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int16_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MIN -32767
+#    define MOUSE_REPORT_XY_MAX 32767
+#else
+typedef int8_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MIN -127
+#    define MOUSE_REPORT_XY_MAX 127
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    int8_t            v;
+    int8_t            h;
+} __attribute__((packed)) report_mouse_t;
+
+/* What a host in boot protocol reads from the mouse interface */
+typedef struct {
     uint8_t buttons;
     int8_t  x;
     int8_t  y;
-    int8_t  v;
-    int8_t  h;
-} __attribute__((packed)) report_mouse_t;
+} __attribute__((packed)) report_mouse_boot_t;
 
 typedef struct {
 #ifdef DIGITIZER_SHARED_EP
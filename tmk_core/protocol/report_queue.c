@@ -0,0 +1,137 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "report_queue.h"
+
+/* Every bit that changed from `before` to `queued` keeps its new value in `next` */
+static inline bool bits_preserved(uint8_t before, uint8_t queued, uint8_t next) { return ((before ^ queued) & (queued ^ next)) == 0; }
+
+static bool keyboard_has_key(const report_keyboard_t *report, uint8_t key) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Whether the host can skip `queued` and go straight from `before` to `next` without missing a press or release */
+static bool keyboard_can_skip(const report_keyboard_t *before, const report_keyboard_t *queued, const report_keyboard_t *next) {
+    if (!bits_preserved(before->mods, queued->mods, next->mods)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t key = queued->keys[i];
+        /* pressed in queued, released again in next */
+        if (key != KC_NO && !keyboard_has_key(before, key) && !keyboard_has_key(next, key)) {
+            return false;
+        }
+        key = before->keys[i];
+        /* released in queued, pressed again in next */
+        if (key != KC_NO && !keyboard_has_key(queued, key) && keyboard_has_key(next, key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef NKRO_ENABLE
+static bool nkro_can_skip(const struct nkro_report *before, const struct nkro_report *queued, const struct nkro_report *next) {
+    if (!bits_preserved(before->mods, queued->mods, next->mods)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+        if (!bits_preserved(before->bits[i], queued->bits[i], next->bits[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+static bool add_delta(int8_t *queued, int8_t next) {
+    int16_t sum = *queued + next;
+    if (sum < -127 || sum > 127) {
+        return false;
+    }
+    *queued = sum;
+    return true;
+}
+
+static bool add_xy_delta(mouse_xy_report_t *queued, mouse_xy_report_t next) {
+    int32_t sum = (int32_t)*queued + next;
+    if (sum < MOUSE_REPORT_XY_MIN || sum > MOUSE_REPORT_XY_MAX) {
+        return false;
+    }
+    *queued = sum;
+    return true;
+}
+
+/* Folds `next` into `queued`, the last waiting report, which follows `before` */
+static bool merge_report(const queued_report_t *before, queued_report_t *queued, const queued_report_t *next) {
+    if (queued->kind != next->kind || queued->offset != next->offset || queued->size != next->size) {
+        return false;
+    }
+
+    switch (next->kind) {
+        case REPORT_KIND_KEYBOARD:
+            if (before->kind != REPORT_KIND_KEYBOARD || !keyboard_can_skip(&before->report.keyboard, &queued->report.keyboard, &next->report.keyboard)) {
+                return false;
+            }
+            *queued = *next;
+            return true;
+#ifdef NKRO_ENABLE
+        case REPORT_KIND_NKRO:
+            if (before->kind != REPORT_KIND_NKRO || !nkro_can_skip(&before->report.keyboard.nkro, &queued->report.keyboard.nkro, &next->report.keyboard.nkro)) {
+                return false;
+            }
+            *queued = *next;
+            return true;
+#endif
+        case REPORT_KIND_MOUSE: {
+            /* motion may only be moved across reports with the same buttons */
+            if (queued->report.mouse.buttons != next->report.mouse.buttons) {
+                return false;
+            }
+            report_mouse_t merged = queued->report.mouse;
+            if (!add_xy_delta(&merged.x, next->report.mouse.x) || !add_xy_delta(&merged.y, next->report.mouse.y) || !add_delta(&merged.v, next->report.mouse.v) || !add_delta(&merged.h, next->report.mouse.h)) {
+                return false;
+            }
+            queued->report.mouse = merged;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void report_queue_clear(report_queue_t *queue) { memset(queue, 0, sizeof(report_queue_t)); }
+
+bool report_queue_push(report_queue_t *queue, const queued_report_t *report) {
+    if (queue->count > 0) {
+        queued_report_t *      last   = &queue->reports[(queue->head + queue->count - 1) % USB_REPORT_QUEUE_SIZE];
+        const queued_report_t *before = queue->count > 1 ? &queue->reports[(queue->head + queue->count - 2) % USB_REPORT_QUEUE_SIZE] : &queue->in_flight;
+        if (merge_report(before, last, report)) {
+            queue->merged++;
+            return true;
+        }
+    }
+
+    if (queue->count == USB_REPORT_QUEUE_SIZE) {
+        return false;
+    }
+    queue->reports[(queue->head + queue->count) % USB_REPORT_QUEUE_SIZE] = *report;
+    queue->count++;
+    return true;
+}
+
+const queued_report_t *report_queue_pop(report_queue_t *queue) {
+    if (queue->count == 0) {
+        return NULL;
+    }
+    queue->in_flight = queue->reports[queue->head];
+    queue->head      = (queue->head + 1) % USB_REPORT_QUEUE_SIZE;
+    queue->count--;
+    return &queue->in_flight;
+}
@@ -0,0 +1,64 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "report.h"
+
+/* Number of reports that can wait for each IN endpoint */
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 4
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    REPORT_KIND_NONE,
+    REPORT_KIND_KEYBOARD, /* 6KRO or boot protocol keyboard report */
+    REPORT_KIND_NKRO,
+    REPORT_KIND_MOUSE,
+    REPORT_KIND_MOUSE_BOOT, /* never merged, the pointing device already splits motion for it */
+    REPORT_KIND_EXTRA,
+} report_kind_t;
+
+typedef struct {
+    union {
+        report_keyboard_t   keyboard;
+        report_mouse_t      mouse;
+        report_mouse_boot_t mouse_boot;
+        report_extra_t      extra;
+    } report;
+    uint8_t kind;
+    uint8_t offset; /* first byte of the report to transmit */
+    uint8_t size;   /* number of bytes to transmit */
+} queued_report_t;
+
+typedef struct {
+    queued_report_t reports[USB_REPORT_QUEUE_SIZE];
+    queued_report_t in_flight; /* last report handed to the endpoint, valid until the next pop */
+    uint8_t         head;
+    uint8_t         count;
+    uint32_t        merged; /* reports that were superseded before the host saw them */
+} report_queue_t;
+
+/* Forgets all waiting reports */
+void report_queue_clear(report_queue_t *queue);
+
+/* Adds a report, merging it into the last waiting one when no press or release would be lost
+ *  -- Return value: false if the queue is full and the report was not added */
+bool report_queue_push(report_queue_t *queue, const queued_report_t *report);
+
+/* Takes the oldest waiting report, which stays valid until the next pop or clear
+ *  -- Return value: NULL if no report is waiting */
+const queued_report_t *report_queue_pop(report_queue_t *queue);
+
+/* Bytes of a report to hand to the endpoint */
+static inline const uint8_t *queued_report_data(const queued_report_t *report) { return (const uint8_t *)&report->report + report->offset; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+// Copyright 2022 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <initializer_list>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "report_queue.h"
+}
+
+static queued_report_t keyboard(uint8_t mods, std::initializer_list<uint8_t> keys) {
+    queued_report_t queued      = {};
+    queued.kind                 = REPORT_KIND_KEYBOARD;
+    queued.size                 = sizeof(report_keyboard_t);
+    queued.report.keyboard.mods = mods;
+    uint8_t i                   = 0;
+    for (uint8_t key : keys) {
+        queued.report.keyboard.keys[i++] = key;
+    }
+    return queued;
+}
+
+static queued_report_t mouse(uint8_t buttons, int8_t x, int8_t y) {
+    queued_report_t queued      = {};
+    queued.kind                 = REPORT_KIND_MOUSE;
+    queued.size                 = sizeof(report_mouse_t);
+    queued.report.mouse.buttons = buttons;
+    queued.report.mouse.x       = x;
+    queued.report.mouse.y       = y;
+    return queued;
+}
+
+class ReportQueueTest : public ::testing::Test {
+   protected:
+    void SetUp() override { report_queue_clear(&queue); }
+
+    /* Hands a report to the endpoint, as if it was idle */
+    void transmit(const queued_report_t &report) {
+        ASSERT_TRUE(report_queue_push(&queue, &report));
+        ASSERT_NE(report_queue_pop(&queue), nullptr);
+    }
+
+    report_queue_t queue;
+};
+
+TEST_F(ReportQueueTest, PopsInOrder) {
+    queued_report_t a = keyboard(0, {KC_A});
+    queued_report_t b = keyboard(0, {});
+    EXPECT_EQ(report_queue_pop(&queue), nullptr);
+    EXPECT_TRUE(report_queue_push(&queue, &a));
+    EXPECT_TRUE(report_queue_push(&queue, &b));
+
+    const queued_report_t *report = report_queue_pop(&queue);
+    ASSERT_NE(report, nullptr);
+    EXPECT_EQ(report->report.keyboard.keys[0], KC_A);
+    report = report_queue_pop(&queue);
+    ASSERT_NE(report, nullptr);
+    EXPECT_EQ(report->report.keyboard.keys[0], KC_NO);
+    EXPECT_EQ(report_queue_pop(&queue), nullptr);
+}
+
+TEST_F(ReportQueueTest, RejectsWhenFull) {
+    transmit(keyboard(0, {}));
+    /* alternating press and release of the same key can never be merged */
+    for (int i = 0; i < USB_REPORT_QUEUE_SIZE; i++) {
+        queued_report_t report = keyboard(0, {(uint8_t)(i % 2 ? KC_NO : KC_A)});
+        EXPECT_TRUE(report_queue_push(&queue, &report));
+    }
+    queued_report_t report = keyboard(0, {(uint8_t)(USB_REPORT_QUEUE_SIZE % 2 ? KC_NO : KC_A)});
+    EXPECT_FALSE(report_queue_push(&queue, &report));
+    EXPECT_EQ(queue.merged, 0);
+
+    EXPECT_NE(report_queue_pop(&queue), nullptr);
+    EXPECT_TRUE(report_queue_push(&queue, &report));
+}
+
+TEST_F(ReportQueueTest, SupersededPressIsDropped) {
+    transmit(keyboard(0, {}));
+    queued_report_t a  = keyboard(0, {KC_A});
+    queued_report_t ab = keyboard(0, {KC_A, KC_B});
+    EXPECT_TRUE(report_queue_push(&queue, &a));
+    EXPECT_TRUE(report_queue_push(&queue, &ab));
+    EXPECT_EQ(queue.count, 1);
+    EXPECT_EQ(queue.merged, 1);
+    EXPECT_EQ(report_queue_pop(&queue)->report.keyboard.keys[1], KC_B);
+}
+
+TEST_F(ReportQueueTest, TapIsNotDropped) {
+    transmit(keyboard(0, {}));
+    queued_report_t a    = keyboard(0, {KC_A});
+    queued_report_t none = keyboard(0, {});
+    EXPECT_TRUE(report_queue_push(&queue, &a));
+    EXPECT_TRUE(report_queue_push(&queue, &none));
+    EXPECT_EQ(queue.count, 2);
+}
+
+TEST_F(ReportQueueTest, ReleaseThenPressIsNotDropped) {
+    transmit(keyboard(MOD_BIT(KC_LSFT), {KC_A}));
+    queued_report_t released = keyboard(0, {});
+    queued_report_t again    = keyboard(0, {KC_A});
+    EXPECT_TRUE(report_queue_push(&queue, &released));
+    EXPECT_TRUE(report_queue_push(&queue, &again));
+    EXPECT_EQ(queue.count, 2);
+
+    /* a modifier tap is kept too */
+    report_queue_clear(&queue);
+    transmit(keyboard(0, {}));
+    queued_report_t shift = keyboard(MOD_BIT(KC_LSFT), {});
+    released              = keyboard(0, {});
+    EXPECT_TRUE(report_queue_push(&queue, &shift));
+    EXPECT_TRUE(report_queue_push(&queue, &released));
+    EXPECT_EQ(queue.count, 2);
+}
+
+TEST_F(ReportQueueTest, NothingIsMergedIntoTheReportInFlight) {
+    queued_report_t a  = keyboard(0, {KC_A});
+    queued_report_t ab = keyboard(0, {KC_A, KC_B});
+    transmit(a);
+    EXPECT_TRUE(report_queue_push(&queue, &ab));
+    EXPECT_EQ(queue.count, 1);
+    EXPECT_EQ(queue.merged, 0);
+}
+
+TEST_F(ReportQueueTest, ProtocolChangeIsNotMerged) {
+    transmit(keyboard(0, {}));
+    queued_report_t a    = keyboard(0, {KC_A});
+    queued_report_t boot = keyboard(0, {KC_A, KC_B});
+    /* as on a shared endpoint, where boot protocol skips the report ID */
+    boot.offset = 1;
+    EXPECT_TRUE(report_queue_push(&queue, &a));
+    EXPECT_TRUE(report_queue_push(&queue, &boot));
+    EXPECT_EQ(queue.count, 2);
+}
+
+TEST_F(ReportQueueTest, MouseDeltasAreAdded) {
+    queued_report_t first  = mouse(0, 10, -5);
+    queued_report_t second = mouse(0, 20, -7);
+    EXPECT_TRUE(report_queue_push(&queue, &first));
+    EXPECT_TRUE(report_queue_push(&queue, &second));
+    EXPECT_EQ(queue.count, 1);
+    const queued_report_t *report = report_queue_pop(&queue);
+    EXPECT_EQ(report->report.mouse.x, 30);
+    EXPECT_EQ(report->report.mouse.y, -12);
+}
+
+TEST_F(ReportQueueTest, MouseDeltasAreNotMergedAcrossButtonsOrOverflow) {
+    queued_report_t move   = mouse(0, 10, 0);
+    queued_report_t click  = mouse(1, 10, 0);
+    queued_report_t far    = mouse(1, 100, 0);
+    queued_report_t beyond = mouse(1, 100, 0);
+    EXPECT_TRUE(report_queue_push(&queue, &move));
+    EXPECT_TRUE(report_queue_push(&queue, &click));
+    EXPECT_EQ(queue.count, 2);
+    EXPECT_TRUE(report_queue_push(&queue, &far));
+    EXPECT_EQ(queue.count, 2);
+    EXPECT_TRUE(report_queue_push(&queue, &beyond));
+    EXPECT_EQ(queue.count, 3);
+}
@@ -0,0 +1,5 @@
+report_queue_DEFS := -DUSB_REPORT_QUEUE_SIZE=3
+
+report_queue_SRC := \
+	$(TMK_PATH)/protocol/tests/report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/report_queue.c